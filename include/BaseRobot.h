@@ -5,9 +5,15 @@
 #include "IMotorController.h"
 #include "WiFiSettings.h"
 #include "FirmwareUpdate.h"
+#include "CameraProfile.h"
+#include "CommandMailbox.h"
+#include "ComponentScheduler.h"
 #include <ESPAsyncWebServer.h>
 #include <WiFi.h>
 
+class BlackBoxRecorder; // Forward declaration
+class UdpControlServer;
+
 // ═══════════════════════════════════════════════════════════════
 // БАЗОВЫЙ КЛАСС ДЛЯ ВСЕХ ТИПОВ РОБОТОВ
 // ═══════════════════════════════════════════════════════════════
@@ -31,7 +37,8 @@ public:
 protected:
     // Методы для наследников
     virtual bool initSpecificComponents() = 0;
-    virtual void updateSpecificComponents() = 0;
+    // Задачи наследника в расписании цикла (вызывается после initSpecificComponents)
+    virtual void scheduleSpecificComponents(ComponentScheduler& scheduler) = 0;
     virtual void shutdownSpecificComponents() = 0;
     virtual void setupWebHandlers(AsyncWebServer* server) = 0;
     
@@ -44,6 +51,10 @@ protected:
     bool initMDNS();
     bool initCamera();
     
+    // Применить профиль сенсора: пишутся только отличающиеся регистры
+    // (зеркало/переворот берутся из настроек). Возвращает число записей или -1
+    int applyCameraProfile(const CameraProfile& profile);
+    
     void startWiFiAP();
     bool connectToSavedWiFi();
     bool connectWiFiDHCP(const char* ssid, const char* password);
@@ -51,6 +62,18 @@ protected:
     // Общий обработчик главной страницы
     void handleRoot(AsyncWebServerRequest* request);
     
+    // Команда движения из любого канала (/move, /ws/control, UDP): самописец + наследник.
+    // arrivalUs - время прихода (CommandTrace::now()) для трассировки задержек
+    void applyControlCommand(int throttlePWM, int steeringPWM, uint32_t arrivalUs);
+    
+    // Команда в почтовый ящик и запуск задачи команд (commandTaskId_).
+    // Вызывается из сетевых задач, без блокировки
+    void postMotorCommand(int throttlePWM, int steeringPWM);
+    
+    // Бинарный канал управления: пакет ControlPacket -> команда + подтверждение
+    void handleControlSocketEvent(AsyncWebSocket* socket, AsyncWebSocketClient* client,
+                                  AwsEventType type, void* arg, uint8_t* data, size_t len);
+    
     // Общие поля
     bool initialized_;
     bool cameraInitialized_;
@@ -60,9 +83,24 @@ protected:
     
     // Объекты
     AsyncWebServer* server_;
+    AsyncWebSocket* controlSocket_;     // /ws/control
+    int controlClients_;                // Подключенные пульты (события async_tcp)
     WiFiSettings* wifiSettings_;
     FirmwareUpdate* firmwareUpdate_;
     IMotorController* motorController_;
+    BlackBoxRecorder* blackBox_;    // Самописец (nullptr, если не включен в сборку)
+    UdpControlServer* udpControl_;  // UDP канал управления (nullptr, если не включен)
+    
+    // Последняя команда движения: пишут сетевые задачи, читает цикл управления
+    CommandMailbox commandMailbox_;
+    
+    // Расписание задач цикла (loopTask)
+    ComponentScheduler scheduler_;
+    int commandTaskId_;                 // Задача команд (период 0, запускается postMotorCommand)
+    
+    // Профиль камеры (меняется только из initCamera и обработчиков веб-сервера)
+    const CameraProfile* cameraProfile_;
+    CameraProfileState cameraState_;
 };
 
 #endif // BASE_ROBOT_H
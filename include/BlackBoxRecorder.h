@@ -0,0 +1,90 @@
+#ifndef BLACK_BOX_RECORDER_H
+#define BLACK_BOX_RECORDER_H
+
+#include <Arduino.h>
+#include "hardware_config.h"
+
+#ifdef FEATURE_BLACKBOX
+
+// ═══════════════════════════════════════════════════════════════
+// БОРТОВОЙ САМОПИСЕЦ ("ЧЕРНЫЙ ЯЩИК")
+// ═══════════════════════════════════════════════════════════════
+// Кольцо в PSRAM с последними BLACKBOX_WINDOW_MS записей: редкие кадры
+// камеры вперемешку с командами /move и выходами моторов, все с метками
+// esp_timer. Буфер выделяется один раз в init(), запись в него - только
+// memcpy под мьютексом, старые записи вытесняются новыми.
+// Выгрузка "замораживает" кольцо: пока файл читается, новые записи
+// отбрасываются (и считаются), стрим и управление при этом работают.
+//
+// Формат файла (little-endian):
+//   Заголовок файла (32 байта): "MBBX", версия u16, размер заголовка u16,
+//     число записей u32, резерв u32, первая метка i64, последняя метка i64
+//   Записи подряд от старой к новой, каждая с заголовком (16 байт):
+//     тип u8, резерв u8, резерв u16, длина данных u32, метка мкс i64,
+//     затем данные, дополненные нулями до кратности 4
+//   Данные: FRAME - ширина u16, высота u16, JPEG;
+//           COMMAND - throttle i16, steering i16 (PWM 1000-2000);
+//           MOTOR - left i16, right i16 (скорость -100..100)
+
+class BlackBoxRecorder {
+public:
+    enum RecordType : uint8_t {
+        RECORD_FRAME = 1,
+        RECORD_COMMAND = 2,
+        RECORD_MOTOR = 3
+    };
+
+    BlackBoxRecorder();
+    ~BlackBoxRecorder();
+
+    // Выделение кольца в PSRAM (без PSRAM самописец выключен)
+    bool init();
+    bool isRecording() const { return buffer_ != nullptr && !frozen_; }
+
+    void recordFrame(const uint8_t* jpeg, size_t len, uint16_t width, uint16_t height,
+                     int64_t timestampUs);
+    void recordCommand(int throttlePWM, int steeringPWM);
+    void recordMotor(int leftSpeed, int rightSpeed);
+
+    // Выгрузка одним файлом: begin замораживает кольцо (false - уже идет выгрузка)
+    bool beginDownload();
+    size_t getDownloadSize() const;
+    // Часть файла начиная с index (для chunked ответа AsyncWebServer)
+    size_t readDownload(uint8_t* out, size_t maxLen, size_t index) const;
+    void endDownload();
+
+    String getStatusJson() const;
+
+private:
+    static const size_t kFileHeaderSize = 32;
+    static const size_t kRecordHeaderSize = 16;
+
+    void append(RecordType type, int64_t timestampUs,
+                const void* prefix, size_t prefixLen, const void* data, size_t dataLen);
+    bool makeRoom(size_t stride);
+    void evictOldest();
+    int64_t recordTimestamp(size_t offset) const;
+    size_t recordStride(size_t offset) const;
+    void buildFileHeader(uint8_t* header) const;
+
+    uint8_t* buffer_;
+    size_t capacity_;
+    SemaphoreHandle_t lock_;
+
+    // Данные кольца: [head_, tail_) или [head_, wrapEnd_) + [0, tail_) при wrapped_
+    size_t head_;
+    size_t tail_;
+    size_t wrapEnd_;
+    bool wrapped_;
+    uint32_t count_;
+    int64_t newestUs_;
+
+    volatile bool frozen_;
+    uint32_t framesRecorded_;
+    uint32_t eventsRecorded_;
+    uint32_t droppedRecords_;       // Отброшены во время выгрузки или слишком велики
+};
+
+#endif // FEATURE_BLACKBOX
+
+#endif // BLACK_BOX_RECORDER_H
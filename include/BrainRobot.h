@@ -24,7 +24,7 @@ public:
     
 protected:
     bool initSpecificComponents() override;
-    void updateSpecificComponents() override;
+    void scheduleSpecificComponents(ComponentScheduler& scheduler) override;
     void shutdownSpecificComponents() override;
     void setupWebHandlers(AsyncWebServer* server) override;
     
@@ -0,0 +1,83 @@
+#ifndef CAMERA_PROFILE_H
+#define CAMERA_PROFILE_H
+
+#include <stdint.h>
+
+// ═══════════════════════════════════════════════════════════════
+// ПРОФИЛИ НАСТРОЕК СЕНСОРА КАМЕРЫ
+// ═══════════════════════════════════════════════════════════════
+// Профиль - компактный набор значений регистров сенсора (яркость,
+// экспозиция, баланс белого...). CameraProfileState помнит, что уже
+// записано в сенсор, и при смене профиля отдает маску только отличающихся
+// параметров: переключение на ходу - несколько SCCB записей вместо ~22.
+// Не зависит от Arduino/ESP-IDF: запись в сенсор делает BaseRobot.
+
+enum CameraParam : uint8_t {
+    CAM_BRIGHTNESS = 0,     // -2..2
+    CAM_CONTRAST,           // -2..2
+    CAM_SATURATION,         // -2..2
+    CAM_SPECIAL_EFFECT,     // 0..6 (0 - без эффекта)
+    CAM_WHITEBAL,           // 0/1
+    CAM_AWB_GAIN,           // 0/1
+    CAM_WB_MODE,            // 0..4
+    CAM_EXPOSURE_CTRL,      // 0/1 (автоэкспозиция)
+    CAM_AEC2,               // 0/1 (ночной режим DSP)
+    CAM_AE_LEVEL,           // -2..2
+    CAM_AEC_VALUE,          // 0..1200 (ручная экспозиция)
+    CAM_GAIN_CTRL,          // 0/1 (автоусиление)
+    CAM_AGC_GAIN,           // 0..30
+    CAM_GAINCEILING,        // 0..6 (2x..128x)
+    CAM_BPC,                // 0/1
+    CAM_WPC,                // 0/1
+    CAM_RAW_GMA,            // 0/1
+    CAM_LENC,               // 0/1
+    CAM_HMIRROR,            // 0/1 (берется из настроек, не из профиля)
+    CAM_VFLIP,              // 0/1 (берется из настроек, не из профиля)
+    CAM_DCW,                // 0/1
+    CAM_COLORBAR,           // 0/1
+    CAM_PARAM_COUNT
+};
+
+struct CameraProfile {
+    const char* name;
+    int16_t values[CAM_PARAM_COUNT];
+};
+
+// Встроенные профили
+int getCameraProfileCount();
+const CameraProfile& getCameraProfile(int index);
+const CameraProfile* findCameraProfile(const char* name);   // nullptr если нет такого
+
+// Целевые значения сенсора: профиль + зеркало/переворот из настроек
+void resolveCameraProfile(const CameraProfile& profile, bool hmirror, bool vflip,
+                          int16_t target[CAM_PARAM_COUNT]);
+
+// Имя параметра для отладки и JSON
+const char* getCameraParamName(CameraParam param);
+
+// Состояние сенсора, известное прошивке
+class CameraProfileState {
+public:
+    CameraProfileState();
+
+    // Состояние неизвестно: следующее применение запишет все параметры
+    void reset();
+
+    // Известное состояние (например, прочитанное из драйвера после инициализации)
+    void seed(const int16_t values[CAM_PARAM_COUNT]);
+
+    // Маска параметров (бит = CameraParam), которые нужно записать для target
+    uint32_t diff(const int16_t target[CAM_PARAM_COUNT]) const;
+
+    // Отметить успешную запись параметра в сенсор
+    void markApplied(CameraParam param, int16_t value);
+
+    bool isKnown(CameraParam param) const { return (knownMask_ >> param) & 1; }
+    int16_t get(CameraParam param) const { return applied_[param]; }
+
+private:
+    int16_t applied_[CAM_PARAM_COUNT];
+    uint32_t knownMask_;
+};
+
+#endif // CAMERA_PROFILE_H
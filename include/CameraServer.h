@@ -2,10 +2,15 @@
 #ifndef CAMERA_SERVER_H
 #define CAMERA_SERVER_H
 
+#include <Arduino.h>
+
 // Запустить камера-сервер на порту 81
 void startCameraStreamServer();
 
 // Остановить камера-сервер
 void stopCameraStreamServer();
 
+// Статистика зрителей стрима в JSON (доставлено/пропущено кадров по каждому)
+String getCameraStreamStatsJson();
+
 #endif // CAMERA_SERVER_H
@@ -27,7 +27,7 @@ public:
     
 protected:
     bool initSpecificComponents() override;
-    void updateSpecificComponents() override;
+    void scheduleSpecificComponents(ComponentScheduler& scheduler) override;
     void shutdownSpecificComponents() override;
     void setupWebHandlers(AsyncWebServer* server) override;
     
@@ -72,15 +72,11 @@ private:
     
 #if defined(FEATURE_NEOPIXEL) || defined(FEATURE_BUZZER)
     EffectMode currentEffectMode_;
-    unsigned long lastEffectUpdate_;
+    uint32_t effectTicks_;          // Вызовы updateEffects (шаг мигающих эффектов)
     bool effectState_;
 #endif
     
     ControlMode currentControlMode_;
-    
-    // Целевые значения PWM (из веб-команд)
-    volatile int targetThrottlePWM_;
-    volatile int targetSteeringPWM_;
 };
 
 #endif // TARGET_CLASSIC
@@ -0,0 +1,89 @@
+#ifndef COMMAND_MAILBOX_H
+#define COMMAND_MAILBOX_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "CommandTrace.h"
+
+// ═══════════════════════════════════════════════════════════════
+// ПОЧТОВЫЙ ЯЩИК КОМАНДЫ ДВИЖЕНИЯ
+// ═══════════════════════════════════════════════════════════════
+// Последняя команда (газ + руль) между сетевыми задачами (async_tcp,
+// async_udp) и циклом управления. Побеждает последняя запись.
+//
+// Вся команда - одно 32-битное слово, поэтому читатель не может увидеть
+// газ от одной команды, а руль от другой:
+//   [31..20] seq      - номер записи (12 бит, по кругу)
+//   [19..10] газ      - PWM - 1000 (0..1000)
+//   [9..0]   руль     - PWM - 1000 (0..1000)
+// Писателей может быть несколько (CAS), читатель - один: цикл управления.
+// По seq читатель отличает новую команду от старой, даже если значения
+// совпали. Задача-читатель получает уведомление при каждой записи.
+// Запись и выборка отмечаются в CommandTrace (этап mailbox).
+
+class CommandMailbox {
+public:
+    CommandMailbox() : word_(pack(0, 1500, 1500)), lastSeq_(0), waiter_(nullptr) {}
+
+    // Задача, которую будить при новой команде (вызывается из нее самой)
+    void attachWaiter(TaskHandle_t task) { waiter_ = task; }
+
+    // Записать команду (любая задача). Значения ограничиваются 1000..2000
+    void post(int throttlePWM, int steeringPWM) {
+        uint32_t current = word_.load(std::memory_order_relaxed);
+        uint32_t next;
+        do {
+            next = pack((current >> kSeqShift) + 1, throttlePWM, steeringPWM);
+        } while (!word_.compare_exchange_weak(current, next, std::memory_order_release,
+                                              std::memory_order_relaxed));
+        CommandTrace::posted(next >> kSeqShift);
+
+        TaskHandle_t waiter = waiter_;
+        if (waiter) {
+            xTaskNotifyGive(waiter);
+        }
+    }
+
+    // Забрать команду, если она новее прочитанной ранее (только читатель)
+    bool take(int& throttlePWM, int& steeringPWM) {
+        uint32_t word = word_.load(std::memory_order_acquire);
+        uint16_t seq = word >> kSeqShift;
+        if (seq == lastSeq_) {
+            return false;
+        }
+        lastSeq_ = seq;
+        CommandTrace::taken(seq);
+        throttlePWM = 1000 + ((word >> kThrottleShift) & kValueMask);
+        steeringPWM = 1000 + (word & kValueMask);
+        return true;
+    }
+
+    // Ждать новую команду не дольше timeout (только задача-читатель)
+    bool wait(TickType_t timeout) {
+        return ulTaskNotifyTake(pdTRUE, timeout) > 0;
+    }
+
+    // Последняя записанная команда, без отметки о прочтении (для статуса)
+    void peek(int& throttlePWM, int& steeringPWM) const {
+        uint32_t word = word_.load(std::memory_order_acquire);
+        throttlePWM = 1000 + ((word >> kThrottleShift) & kValueMask);
+        steeringPWM = 1000 + (word & kValueMask);
+    }
+
+private:
+    static const int kSeqShift = 20;
+    static const int kThrottleShift = 10;
+    static const uint32_t kValueMask = 0x3FF;
+
+    static uint32_t pack(uint32_t seq, int throttlePWM, int steeringPWM) {
+        uint32_t throttle = constrain(throttlePWM, 1000, 2000) - 1000;
+        uint32_t steering = constrain(steeringPWM, 1000, 2000) - 1000;
+        return ((seq & 0xFFF) << kSeqShift) | (throttle << kThrottleShift) | steering;
+    }
+
+    std::atomic<uint32_t> word_;
+    uint16_t lastSeq_;                  // Только читатель
+    TaskHandle_t volatile waiter_;
+};
+
+#endif // COMMAND_MAILBOX_H
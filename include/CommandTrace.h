@@ -0,0 +1,70 @@
+#ifndef COMMAND_TRACE_H
+#define COMMAND_TRACE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
+#include "LatencyHistogram.h"
+
+// ═══════════════════════════════════════════════════════════════
+// ТРАССИРОВКА КОМАНД ДВИЖЕНИЯ
+// ═══════════════════════════════════════════════════════════════
+// Путь команды от прихода запроса до записи в LEDC делится на этапы:
+//   handle  - приход (/move, /ws/control, UDP) -> handleMotorCommand
+//             (разбор, самописец; задача сетевого канала)
+//   mailbox - запись в CommandMailbox -> выборка циклом в updateMotors
+//             (ожидание цикла управления)
+//   apply   - выборка -> последняя ledcWrite в applyMotorSpeed
+//   total   - от записи в ящик до ledcWrite
+// Время в сети до прихода запроса здесь не видно: это RTT клиента
+// (infrastructure/loadtest/loadtest.py) минус handle и ответ сервера.
+//
+// Метка - одно чтение esp_timer и запись в гистограмму. Команды этапов
+// mailbox/apply сопоставляются по seq почтового ящика; команды, которые цикл
+// не успел забрать до следующей (перезаписаны), считаются отдельно.
+
+class CommandTrace {
+public:
+    static uint32_t now() { return (uint32_t)esp_timer_get_time(); }
+
+    // Команда дошла до handleMotorCommand (задача сетевого канала)
+    static void handled(uint32_t arrivalUs);
+
+    // Запись в почтовый ящик (любая задача) и выборка (только цикл управления)
+    static void posted(uint16_t seq);
+    static void taken(uint16_t seq);
+
+    // Выходы моторов записаны (цикл управления). Без выборки перед этим
+    // (PID Лайнера, остановка) ничего не отмечает
+    static void applied();
+
+    static String getStatsJson();
+    static void reset();
+
+private:
+    static const int kPostedSlots = 4;      // Степень двойки
+    static const uint16_t kNoSeq = 0xFFFF;  // seq в ящике 12-битный
+
+    // Время записи по seq: слот помечается недействительным на время записи
+    struct PostedSlot {
+        std::atomic<uint16_t> seq;
+        uint32_t postedUs;
+    };
+
+    static PostedSlot posted_[kPostedSlots];
+
+    // Только цикл управления
+    static bool active_;
+    static uint32_t activePostedUs_;
+    static uint32_t activeTakenUs_;
+    static uint16_t lastTakenSeq_;
+
+    static portMUX_TYPE mux_;
+    static LatencyHistogram handle_;
+    static LatencyHistogram mailbox_;
+    static LatencyHistogram apply_;
+    static LatencyHistogram total_;
+    static uint32_t superseded_;
+};
+
+#endif // COMMAND_TRACE_H
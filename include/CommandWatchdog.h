@@ -0,0 +1,63 @@
+#ifndef COMMAND_WATCHDOG_H
+#define COMMAND_WATCHDOG_H
+
+#include <stdint.h>
+#include <atomic>
+#include "LatencyHistogram.h"
+
+// ═══════════════════════════════════════════════════════════════
+// СРОК WATCHDOG КОМАНД ДВИЖЕНИЯ
+// ═══════════════════════════════════════════════════════════════
+// Решение watchdog без самого таймера: каждая команда переносит срок
+// остановки (rearm), одноразовый таймер при срабатывании сверяет время со
+// сроком (checkExpired). Команда, пришедшая одновременно со срабатыванием
+// (таймер уже сработал, но обработчик еще не выполнился), переносит срок,
+// и обработчик моторы не останавливает - их остановит следующий запуск таймера.
+//
+// Время - младшие 32 бита мкс (esp_timer), переход через 0 учитывается.
+// Срок атомарный (пишет задача команды, читает задача таймера); счетчики
+// срабатываний синхронизирует владелец. Не зависит от Arduino/ESP-IDF,
+// проверяется на ПК (test/test_command_watchdog).
+
+class CommandWatchdog {
+public:
+    explicit CommandWatchdog(uint32_t timeoutUs) :
+        timeoutUs_(timeoutUs), deadlineUs_(0), tripCount_(0), lastTripLatencyUs_(0) {}
+
+    // Новая команда в момент nowUs. Возвращает задержку запуска таймера, мкс
+    uint32_t rearm(uint32_t nowUs) {
+        deadlineUs_.store(nowUs + timeoutUs_, std::memory_order_release);
+        return timeoutUs_;
+    }
+
+    // Срабатывание таймера: true - срок наступил, моторы останавливаем.
+    // deadlineUs - срок, с которым сверялись (для задержки остановки)
+    bool checkExpired(uint32_t nowUs, uint32_t& deadlineUs) const {
+        deadlineUs = deadlineUs_.load(std::memory_order_acquire);
+        return (int32_t)(nowUs - deadlineUs) >= 0;
+    }
+
+    // Моторы остановлены в stopUs. Возвращает задержку от срока
+    uint32_t recordTrip(uint32_t deadlineUs, uint32_t stopUs) {
+        const uint32_t latencyUs = stopUs - deadlineUs;
+        tripLatency_.record(latencyUs);
+        tripCount_++;
+        lastTripLatencyUs_ = latencyUs;
+        return latencyUs;
+    }
+
+    uint32_t getTimeoutUs() const { return timeoutUs_; }
+    uint32_t getDeadlineUs() const { return deadlineUs_.load(std::memory_order_acquire); }
+    uint32_t getTripCount() const { return tripCount_; }
+    uint32_t getLastTripLatencyUs() const { return lastTripLatencyUs_; }
+    const LatencyHistogram& getTripLatency() const { return tripLatency_; }
+
+private:
+    const uint32_t timeoutUs_;
+    std::atomic<uint32_t> deadlineUs_;
+    LatencyHistogram tripLatency_;
+    uint32_t tripCount_;
+    uint32_t lastTripLatencyUs_;
+};
+
+#endif // COMMAND_WATCHDOG_H
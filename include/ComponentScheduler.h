@@ -0,0 +1,92 @@
+#ifndef COMPONENT_SCHEDULER_H
+#define COMPONENT_SCHEDULER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include "IComponent.h"
+#include "LatencyHistogram.h"
+
+// ═══════════════════════════════════════════════════════════════
+// ПЛАНИРОВЩИК КОМПОНЕНТОВ
+// ═══════════════════════════════════════════════════════════════
+// Кооперативное расписание для цикла робота: у каждой задачи свой период
+// и допустимое время выполнения (deadline). runDue() запускает задачи, чей
+// срок наступил, и возвращает время до ближайшего следующего срока - цикл
+// спит ровно столько (или пока его не разбудят).
+//
+// Задачи с периодом 0 запускаются только по trigger() (например, на каждый
+// кадр камеры). trigger() можно вызывать из любой задачи.
+//
+// Для каждой задачи считаются опоздание старта (джиттер, гистограмма),
+// время выполнения, превышения deadline и пропущенные периоды.
+// Время берется из переданных часов (мкс), а пробуждение цикла делает
+// переданная функция, поэтому планировщик не зависит от Arduino/FreeRTOS
+// и проверяется на ПК с виртуальными часами (test/test_component_scheduler).
+// Задачи выполняются только в потоке runDue().
+
+class ComponentScheduler {
+public:
+    typedef uint32_t (*Clock)();
+    typedef void (*Waker)(void* context);
+    typedef std::function<void()> Callback;
+
+    static const int kMaxTasks = 12;
+
+    struct TaskStats {
+        const char* name;
+        uint32_t periodUs;          // 0 - по trigger()
+        uint32_t deadlineUs;
+        uint32_t runs;
+        uint32_t overruns;          // Выполнение дольше deadline
+        uint32_t skipped;           // Пропущенные периоды (опоздание больше периода)
+        uint32_t maxRunUs;
+        uint64_t totalRunUs;
+        LatencyHistogram lateness;  // Старт относительно срока (или trigger())
+    };
+
+    explicit ComponentScheduler(Clock clock);
+
+    // Как разбудить поток, выполняющий runDue (trigger() вызывает waker(context)).
+    // Задается до первого trigger()
+    void attachWaker(Waker waker, void* context);
+
+    // Добавить задачу (до первого runDue). Возвращает id или -1
+    int add(const char* name, uint32_t periodUs, uint32_t deadlineUs, Callback callback);
+
+    // Компонент с объявленным периодом (IComponent::getUpdatePeriodUs)
+    int add(const char* name, IComponent* component);
+
+    // Запустить задачу при ближайшем runDue (любая задача, будит цикл)
+    void trigger(int id);
+
+    // Выполнить готовые задачи. Возвращает мкс до следующего срока
+    // (не больше maxSleepUs; 0 - есть еще готовые задачи)
+    uint32_t runDue(uint32_t maxSleepUs);
+
+    int getTaskCount() const { return taskCount_; }
+
+    // Копия счетчиков (читается из веб-сервера, пишется циклом)
+    bool getStats(int id, TaskStats& stats) const;
+    void resetStats();
+
+private:
+    struct Task {
+        Callback callback;
+        uint32_t nextDueUs;
+        // Время первого trigger() до запуска, 0 - нет запроса.
+        // Флаг и время в одном слове: trigger() и runDue() не теряют запуск
+        std::atomic<uint32_t> triggeredUs;
+        TaskStats stats;
+    };
+
+    Clock clock_;
+    Task tasks_[kMaxTasks];
+    int taskCount_;
+    Waker waker_;
+    void* wakerContext_;
+    mutable std::mutex statsLock_;      // TaskStats: пишет runDue, читает веб-сервер
+};
+
+#endif // COMPONENT_SCHEDULER_H
@@ -0,0 +1,95 @@
+#ifndef CONTROL_PACKET_H
+#define CONTROL_PACKET_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ═══════════════════════════════════════════════════════════════
+// БИНАРНЫЙ ПАКЕТ УПРАВЛЕНИЯ
+// ═══════════════════════════════════════════════════════════════
+// Фиксированный пакет команды движения вместо /move?t=..&s=..: без разбора
+// строки запроса и String::toInt. Один формат для /ws/control и UDP.
+// Робот отвечает подтверждением (ACK) с тем же seq и временем клиента -
+// клиент считает RTT по своим часам. По WebSocket ACK отправляется всегда,
+// по UDP - только на пакеты с флагом CONTROL_FLAG_ACK.
+//
+// Формат (little-endian, CONTROL_PACKET_SIZE байт):
+//   [0]      версия (1)
+//   [1]      тип: 1 - команда, 2 - подтверждение
+//   [2]      флаги CONTROL_FLAG_*
+//   [3]      резерв (0)
+//   [4..7]   порядковый номер, растет с каждой командой
+//   [8..9]   газ, PWM 1000..2000 (в ACK - значение из команды)
+//   [10..11] руль, PWM 1000..2000 (в ACK - значение из команды)
+//   [12..15] время клиента, мс (возвращается в ACK без изменений)
+// Не зависит от Arduino/ESP-IDF.
+
+#define CONTROL_PACKET_VERSION 1
+#define CONTROL_PACKET_SIZE 16
+
+enum ControlPacketType : uint8_t {
+    CONTROL_PACKET_COMMAND = 1,
+    CONTROL_PACKET_ACK = 2
+};
+
+enum ControlPacketFlags : uint8_t {
+    CONTROL_FLAG_STOP = 0x01,   // Немедленная остановка (принимается даже устаревшей)
+    CONTROL_FLAG_ACK = 0x02     // Запрос подтверждения (UDP)
+};
+
+struct ControlPacket {
+    uint8_t type;
+    uint8_t flags;
+    uint32_t seq;
+    uint16_t throttle;
+    uint16_t steering;
+    uint32_t clientTimeMs;
+};
+
+static inline uint32_t controlGetLe32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void controlPutLe32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (v >> (8 * i)) & 0xFF;
+    }
+}
+
+// Разбор пакета: false, если размер, версия или тип не те
+inline bool decodeControlPacket(const uint8_t* data, size_t len, ControlPacket& packet) {
+    if (data == nullptr || len != CONTROL_PACKET_SIZE || data[0] != CONTROL_PACKET_VERSION) {
+        return false;
+    }
+    if (data[1] != CONTROL_PACKET_COMMAND && data[1] != CONTROL_PACKET_ACK) {
+        return false;
+    }
+    packet.type = data[1];
+    packet.flags = data[2];
+    packet.seq = controlGetLe32(data + 4);
+    packet.throttle = data[8] | (data[9] << 8);
+    packet.steering = data[10] | (data[11] << 8);
+    packet.clientTimeMs = controlGetLe32(data + 12);
+    return true;
+}
+
+inline size_t encodeControlPacket(const ControlPacket& packet, uint8_t* buf) {
+    buf[0] = CONTROL_PACKET_VERSION;
+    buf[1] = packet.type;
+    buf[2] = packet.flags;
+    buf[3] = 0;
+    controlPutLe32(buf + 4, packet.seq);
+    buf[8] = packet.throttle & 0xFF;
+    buf[9] = packet.throttle >> 8;
+    buf[10] = packet.steering & 0xFF;
+    buf[11] = packet.steering >> 8;
+    controlPutLe32(buf + 12, packet.clientTimeMs);
+    return CONTROL_PACKET_SIZE;
+}
+
+// seq новее last с учетом перехода через 0xFFFFFFFF
+inline bool controlSeqIsNewer(uint32_t seq, uint32_t last) {
+    return (int32_t)(seq - last) > 0;
+}
+
+#endif // CONTROL_PACKET_H
@@ -0,0 +1,65 @@
+#ifndef CONTROL_SEQUENCER_H
+#define CONTROL_SEQUENCER_H
+
+#include <stdint.h>
+
+// ═══════════════════════════════════════════════════════════════
+// ФИЛЬТР ПОРЯДКА И СВЕЖЕСТИ КОМАНД
+// ═══════════════════════════════════════════════════════════════
+// Состояние одного источника команд без гарантии доставки (UDP):
+// - пакет со старым или повторным seq отбрасывается, побеждает новейший;
+// - устаревший пакет (застрял в очереди WiFi) отбрасывается по возрасту.
+// Возраст считается без синхронизации часов: разница "прием - время
+// клиента" минус ее минимум за последние окна (минимум = задержка сети
+// без очередей). Окна скользят, поэтому уход часов клиента не копится.
+// Не зависит от Arduino/ESP-IDF. Синхронизацию обеспечивает владелец.
+
+class ControlSequencer {
+public:
+    enum Verdict : uint8_t {
+        ACCEPTED = 0,
+        DUPLICATE,      // Тот же seq еще раз
+        REORDERED,      // seq старше уже принятого
+        STALE           // Новый seq, но пакет слишком долго шел
+    };
+
+    struct Stats {
+        uint32_t received;
+        uint32_t accepted;
+        uint32_t lost;          // Пропуски seq (за вычетом пришедших позже)
+        uint32_t reordered;
+        uint32_t duplicates;
+        uint32_t stale;
+        uint32_t resets;        // Новые сессии после паузы (перезапуск клиента)
+    };
+
+    ControlSequencer(uint32_t maxAgeMs, uint32_t sessionTimeoutMs, uint32_t baselineWindowMs);
+
+    // Забыть источник (новый клиент)
+    void reset();
+
+    Verdict accept(uint32_t seq, uint32_t clientTimeMs, uint32_t nowMs);
+
+    const Stats& getStats() const { return stats_; }
+    uint32_t getLastSeq() const { return lastSeq_; }
+    uint32_t getLastAgeMs() const { return lastAgeMs_; }
+
+private:
+    uint32_t maxAgeMs_;
+    uint32_t sessionTimeoutMs_;
+    uint32_t baselineWindowMs_;
+
+    bool active_;
+    uint32_t lastSeq_;
+    uint32_t lastPacketMs_;
+    uint32_t lastAgeMs_;
+
+    // Минимум (прием - время клиента) в текущем и предыдущем окне
+    int32_t windowMinMs_;
+    int32_t prevWindowMinMs_;
+    uint32_t windowStartMs_;
+
+    Stats stats_;
+};
+
+#endif // CONTROL_SEQUENCER_H
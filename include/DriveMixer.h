@@ -0,0 +1,181 @@
+#ifndef DRIVE_MIXER_H
+#define DRIVE_MIXER_H
+
+#include <stdint.h>
+#include "hardware_config.h"
+
+// ═══════════════════════════════════════════════════════════════
+// МИКШЕР ДИФФЕРЕНЦИАЛЬНОГО ПРИВОДА
+// ═══════════════════════════════════════════════════════════════
+// Газ/руль (PWM 1000-2000) -> скорости моторов (-100..100) -> скважность LEDC.
+// Кривые считаются при компиляции (constexpr таблицы во flash), в работе -
+// только выборка из таблицы и целочисленное сложение:
+//   - ось: PWM -> -100..100 с мертвой зоной и экспонентой
+//     (MOTOR_DEADBAND_PERCENT, MOTOR_EXPO_PERCENT)
+//   - скважность: |скорость| -> duty с учетом MOTOR_MAX_POWER_PERCENT
+// Без мертвой зоны и экспоненты результат совпадает с прежними map().
+//
+// Инверсия и swap моторов из настроек сворачиваются в один байт конфигурации
+// (makeConfig) при изменении настроек, а не проверяются на каждой команде.
+// Там же решение о тормозе MX1508 по выходу и цели ограничителя (brakeDuty).
+// Не зависит от Arduino/ESP-IDF.
+
+#ifndef MOTOR_DEADBAND_PERCENT
+  #define MOTOR_DEADBAND_PERCENT 0
+#endif
+#ifndef MOTOR_EXPO_PERCENT
+  #define MOTOR_EXPO_PERCENT 0
+#endif
+#ifndef MOTOR_MAX_POWER_PERCENT
+  #define MOTOR_MAX_POWER_PERCENT 100
+#endif
+#ifndef MOTOR_PWM_RESOLUTION
+  #define MOTOR_PWM_RESOLUTION 13
+#endif
+
+static_assert(MOTOR_DEADBAND_PERCENT >= 0 && MOTOR_DEADBAND_PERCENT < 100,
+              "MOTOR_DEADBAND_PERCENT: 0..99");
+static_assert(MOTOR_EXPO_PERCENT >= 0 && MOTOR_EXPO_PERCENT <= 100,
+              "MOTOR_EXPO_PERCENT: 0..100");
+
+// Таблицы строятся компилятором (constexpr) и лежат во flash
+struct DriveAxisTable {
+    int8_t value[1001];         // PWM - 1000 -> -100..100
+};
+
+struct DriveDutyTable {
+    uint16_t value[101];        // |скорость| -> duty
+};
+
+constexpr int kDriveMaxDuty = (((1 << MOTOR_PWM_RESOLUTION) - 1) * MOTOR_MAX_POWER_PERCENT) / 100;
+
+// Мертвая зона (остаток растягивается обратно на 0..100), затем экспонента
+// out = in * (1 - e) + in^3 * e в долях хода
+constexpr int shapeDriveAxis(int value) {
+    int magnitude = value < 0 ? -value : value;
+    if (magnitude <= MOTOR_DEADBAND_PERCENT) {
+        return 0;
+    }
+    magnitude = (magnitude - MOTOR_DEADBAND_PERCENT) * 100 / (100 - MOTOR_DEADBAND_PERCENT);
+    const int64_t shaped = (int64_t)magnitude * (100 - MOTOR_EXPO_PERCENT) * 10000 +
+                           (int64_t)magnitude * magnitude * magnitude * MOTOR_EXPO_PERCENT;
+    magnitude = (int)(shaped / 1000000);
+    return value < 0 ? -magnitude : magnitude;
+}
+
+constexpr DriveAxisTable makeDriveAxisTable() {
+    DriveAxisTable table = {};
+    for (int i = 0; i <= 1000; i++) {
+        // map(pwm, 1000, 2000, -100, 100)
+        table.value[i] = (int8_t)shapeDriveAxis(i * 200 / 1000 - 100);
+    }
+    return table;
+}
+
+constexpr DriveDutyTable makeDriveDutyTable() {
+    DriveDutyTable table = {};
+    for (int speed = 0; speed <= 100; speed++) {
+        // map(speed, 0, 100, 0, kDriveMaxDuty)
+        table.value[speed] = (uint16_t)(speed * kDriveMaxDuty / 100);
+    }
+    return table;
+}
+
+inline constexpr DriveAxisTable kDriveAxisTable = makeDriveAxisTable();
+inline constexpr DriveDutyTable kDriveDutyTable = makeDriveDutyTable();
+
+static_assert(kDriveAxisTable.value[0] == -100 && kDriveAxisTable.value[500] == 0 &&
+              kDriveAxisTable.value[1000] == 100,
+              "Кривая оси должна проходить через -100, 0, 100");
+static_assert(kDriveDutyTable.value[0] == 0 && kDriveDutyTable.value[100] == kDriveMaxDuty,
+              "Таблица скважности должна заканчиваться на kDriveMaxDuty");
+
+class DriveMixer {
+public:
+    // Конфигурация выходов: знак каждого выхода и откуда он берется
+    static const uint8_t kSwap = 0x01;          // Левый выход - правая сторона микса
+    static const uint8_t kNegateLeft = 0x02;    // Инверсия левого выхода
+    static const uint8_t kNegateRight = 0x04;   // Инверсия правого выхода
+
+    static const int kPwmMin = 1000;
+    static const int kPwmMax = 2000;
+
+    // Инверсия применяется к логическим моторам ДО swap (как в настройках):
+    // после swap левый выход - инвертированный (или нет) правый мотор
+    static constexpr uint8_t makeConfig(bool swap, bool invertLeft, bool invertRight) {
+        return (swap ? kSwap : 0) |
+               ((swap ? invertRight : invertLeft) ? kNegateLeft : 0) |
+               ((swap ? invertLeft : invertRight) ? kNegateRight : 0);
+    }
+
+    // PWM оси -> -100..100. Вне 1000..2000 (PID Лайнера) продолжается
+    // линейно, как map()
+    static int axis(int pwm) {
+        if (pwm < kPwmMin) {
+            return kDriveAxisTable.value[0] + (pwm - kPwmMin) / 5;
+        }
+        if (pwm > kPwmMax) {
+            return kDriveAxisTable.value[kPwmMax - kPwmMin] + (pwm - kPwmMax) / 5;
+        }
+        return kDriveAxisTable.value[pwm - kPwmMin];
+    }
+
+    // Газ/руль -> скорости моторов -100..100 с учетом конфигурации
+    static void mix(int throttlePWM, int steeringPWM, uint8_t config, int& leftSpeed, int& rightSpeed) {
+        const int throttle = axis(throttlePWM);
+        const int steering = axis(steeringPWM);
+        int left = throttle + steering;
+        int right = throttle - steering;
+        if (config & kSwap) {
+            const int temp = left;
+            left = right;
+            right = temp;
+        }
+        if (config & kNegateLeft) {
+            left = -left;
+        }
+        if (config & kNegateRight) {
+            right = -right;
+        }
+        leftSpeed = clampSpeed(left);
+        rightSpeed = clampSpeed(right);
+    }
+
+    // |скорость| 0..100 -> скважность LEDC
+    static uint16_t duty(int speed) {
+        return kDriveDutyTable.value[speed < 0 ? -speed : speed];
+    }
+
+    // Режим тормоза - значения MotorBrakeMode (WiFiSettings.h)
+    static const uint8_t kBrakeCoast = 0;
+    static const uint8_t kBrakeFull = 1;
+    static const uint8_t kBrakeProportional = 2;
+
+    // Скважность на оба входа драйвера: 0 - выбег, больше 0 - тормоз,
+    // -1 - ход (тормоз не нужен). speed - выход ограничителя, target - его цель.
+    // Тормоз только на остановке (цель 0) и на участке реверса: при разгоне
+    // с места выход первые тики еще округляется до 0, но это уже ход
+    static int brakeDuty(int speed, int target, uint8_t mode, int strength) {
+        const bool reversing = (speed > 0 && target < 0) || (speed < 0 && target > 0);
+        if (!reversing && (speed != 0 || target != 0)) {
+            return -1;
+        }
+        switch (mode) {
+            case kBrakeFull:
+                return duty(100);
+            case kBrakeProportional:
+                // На остановке - сила из настроек, при реверсе - по величине новой команды
+                return duty(reversing ? target : strength);
+            default:
+                // Выбег: реверс идет по ограничителю, как без тормоза
+                return reversing ? -1 : 0;
+        }
+    }
+
+private:
+    static int clampSpeed(int speed) {
+        return speed < -100 ? -100 : (speed > 100 ? 100 : speed);
+    }
+};
+
+#endif // DRIVE_MIXER_H
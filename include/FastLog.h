@@ -0,0 +1,86 @@
+#ifndef FAST_LOG_H
+#define FAST_LOG_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+#include <type_traits>
+#include "target_config.h"
+#include "hardware_config.h"
+
+// ═══════════════════════════════════════════════════════════════
+// БЫСТРЫЙ ЖУРНАЛ (ТОКЕНЫ ВМЕСТО ТЕКСТА)
+// ═══════════════════════════════════════════════════════════════
+// Горячий путь не форматирует и не ждет UART: FAST_LOG кладет в кольцо
+// запись фиксированного размера - указатель на строку формата (она лежит во
+// flash и живет вечно), время и до FAST_LOG_MAX_ARGS аргументов по 32 бита.
+// Текст собирает задача выгрузки с низким приоритетом.
+//
+// Кольцо - ограниченная MPSC очередь без блокировок (номер в каждом слоте):
+// писать можно из любой задачи, при переполнении запись теряется и
+// учитывается в счетчике, писатель никогда не ждет.
+//
+// Аргументы: целые, float/double (хранятся как float), строки %s - только
+// литералы или другие строки с вечным временем жизни (хранится указатель).
+//
+// С FAST_LOG_BINARY_OUTPUT в UART уходят сами записи, а текст восстанавливает
+// scripts/fastlog_decode.py по firmware.elf - UART занят еще меньше.
+
+#define FAST_LOG_MAX_ARGS 6
+
+struct FastLogRecord {
+    const char* format;
+    uint32_t timestampUs;
+    uint32_t argCount;
+    uint32_t args[FAST_LOG_MAX_ARGS];
+};
+
+class FastLog {
+public:
+    // Запуск задачи выгрузки (записи до вызова копятся в кольце)
+    static bool begin();
+
+    template<typename... Args>
+    static void write(const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= FAST_LOG_MAX_ARGS, "FAST_LOG: слишком много аргументов");
+        const uint32_t words[sizeof...(Args) + 1] = { toWord(args)..., 0 };
+        push(format, words, sizeof...(Args));
+    }
+
+    static uint32_t getWritten() { return written_.load(std::memory_order_relaxed); }
+    static uint32_t getDropped() { return dropped_.load(std::memory_order_relaxed); }
+
+    // Текст записи (задача выгрузки; в тестах на ПК - напрямую)
+    static size_t format(const FastLogRecord& record, char* out, size_t outSize);
+
+private:
+    static void push(const char* format, const uint32_t* args, uint32_t argCount);
+    static bool pop(FastLogRecord& record);
+    static void drainTask(void* param);
+    static void output(const FastLogRecord& record);
+
+    template<typename T>
+    static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, uint32_t>::type
+    toWord(T value) { return (uint32_t)value; }
+
+    static uint32_t toWord(double value) {
+        float f = (float)value;
+        uint32_t word;
+        memcpy(&word, &f, sizeof(word));
+        return word;
+    }
+
+    static uint32_t toWord(const char* text) { return (uint32_t)(uintptr_t)text; }
+
+    static std::atomic<uint32_t> written_;
+    static std::atomic<uint32_t> dropped_;
+};
+
+// Формат должен быть строковым литералом: его адрес и есть идентификатор
+#ifdef DEBUG
+  #define FAST_LOG(fmt, ...) FastLog::write("" fmt "", ##__VA_ARGS__)
+#else
+  #define FAST_LOG(fmt, ...)
+#endif
+
+#endif // FAST_LOG_H
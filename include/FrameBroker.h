@@ -0,0 +1,142 @@
+#ifndef FRAME_BROKER_H
+#define FRAME_BROKER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "esp_camera.h"
+#include "hardware_config.h"
+#include "FrameRing.h"
+#include "StreamQualityController.h"
+#include "LatencyHistogram.h"
+#include "GrayJpegEncoder.h"
+
+class BlackBoxRecorder;
+
+#ifdef FEATURE_CAMERA
+
+// ═══════════════════════════════════════════════════════════════
+// БРОКЕР КАДРОВ КАМЕРЫ
+// ═══════════════════════════════════════════════════════════════
+// Отдельная задача захватывает кадр и кодирует его в JPEG один раз,
+// после чего кадр доступен любому числу подписчиков (/stream и т.д.).
+// Кадры копируются в кольцо предвыделенных слотов со счетчиком ссылок
+// (FrameRing.h), буфер драйвера камеры возвращается сразу после копирования.
+
+// Окно сенсора (ROI) в координатах режима SVGA OV2640
+// (CAMERA_ROI_SENSOR_WIDTH x CAMERA_ROI_SENSOR_HEIGHT, весь угол обзора)
+struct FrameRoi {
+    bool active;
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint16_t outWidth;      // Размер кадра на выходе DSP (без масштаба, пока окно влезает)
+    uint16_t outHeight;
+};
+
+class FrameBroker {
+public:
+    static FrameBroker& instance();
+
+    // Запуск/остановка задачи захвата
+    bool start();
+    void stop();
+    bool isRunning() const { return captureTask_ != nullptr; }
+
+    // Подписка задачи на уведомления о новых кадрах
+    // Возвращает идентификатор подписчика или -1 если мест нет
+    int subscribe(TaskHandle_t task);
+    void unsubscribe(int id);
+    int getSubscriberCount() const;
+
+    // Получить последний кадр, если он новее lastSeq (иначе nullptr)
+    // Полученный слот обязательно вернуть через release()
+    FrameSlot* acquireLatest(uint32_t lastSeq) { return ring_.acquireLatest(lastSeq); }
+    void release(FrameSlot* slot) { ring_.release(slot); }
+
+    // Адаптивное качество: отчет задачи отправки о доставленном кадре
+    void reportFrameSent(uint32_t sendUs, uint32_t jpegBytes);
+    // Выключение возвращает сенсор к ступени 0 на следующем кадре (updateQuality).
+    // Возвращает false, если включение не поддерживается (сенсор не JPEG)
+    bool setAdaptiveQuality(bool enabled);
+    void setTargetLatencyMs(uint32_t targetMs);
+    StreamQualityController getQualitySnapshot() const;
+
+    // Окно сенсора: захват только выбранного прямоугольника (только JPEG сенсор).
+    // Окно выравнивается и ограничивается, применяется задачей захвата между кадрами.
+    // Возвращает false, если сенсор не поддерживает окно
+    bool setRoi(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+    void clearRoi();
+    FrameRoi getRoi() const;
+
+    // Запись регистров сенсора: задача захвата (качество, окно) и веб-сервер
+    // (профиль BaseRobot) пишут по одной шине SCCB - записи не должны перемежаться
+    void lockSensor() { xSemaphoreTake(sensorLock_, portMAX_DELAY); }
+    void unlockSensor() { xSemaphoreGive(sensorLock_); }
+
+    // Самописец: редкие кадры пишутся и без зрителей стрима (может быть nullptr)
+    void setBlackBox(BlackBoxRecorder* blackBox) { blackBox_ = blackBox; }
+
+    // Статистика
+    uint32_t getLatestSeq() const { return ring_.getLatestSeq(); }
+    float getSensorFps() const { return sensorFps_; }   // Кадры от драйвера камеры, независимо от зрителей
+    uint32_t getCaptureFailures() const { return captureFailures_; }
+    uint32_t getDroppedFrames() const { return droppedFrames_; }
+
+    // Задержки конвейера: сенсор -> выдача драйвером, кодирование/копирование в слот
+    void getPipelineLatency(LatencyHistogram& dequeue, LatencyHistogram& encode) const;
+
+private:
+    FrameBroker();
+    FrameBroker(const FrameBroker&) = delete;
+    FrameBroker& operator=(const FrameBroker&) = delete;
+
+    static void captureTaskEntry(void* arg);
+    void captureLoop();
+
+    bool allocateRing();
+    void publish(FrameSlot* slot, bool sceneChanged);
+    bool detectSceneChange(pixformat_t format, const uint8_t* pixels,
+                           uint16_t width, uint16_t height, size_t jpgLen);
+    void notifySubscribers();
+    void updateQuality();
+    bool applyRoi();
+    uint32_t idleWaitMs() const;
+
+    FrameRing ring_;
+    TaskHandle_t subscribers_[STREAM_MAX_CLIENTS];
+    SemaphoreHandle_t subscribersLock_;  // Мьютекс: под ним можно будить задачи
+    TaskHandle_t captureTask_;
+    SemaphoreHandle_t sensorLock_;       // Мьютекс записи регистров сенсора
+    mutable portMUX_TYPE mux_;           // Контроллер качества и гистограммы (не кадры)
+    StreamQualityController quality_;
+    LatencyHistogram dequeueLatency_;    // fb->timestamp -> esp_camera_fb_get (защищено mux_)
+    LatencyHistogram encodeLatency_;     // frame2jpg/memcpy до публикации (защищено mux_)
+    GrayJpegEncoder grayEncoder_;        // Только для задачи захвата
+
+    // Окно сенсора: запрошенное (под mux_) и примененное (только задача захвата)
+    FrameRoi roiRequested_;
+    bool roiPending_;
+    FrameRoi roiApplied_;
+    framesize_t frameSize_;              // Размер кадра без окна (меняет регулятор качества)
+    int roiSettleFrames_;                // Кадры, снятые до смены окна, пропускаются
+
+    // Сигнатура опорного кадра сцены (только для задачи захвата)
+    static const int kSignatureCols = 16;
+    static const int kSignatureRows = 12;
+    uint8_t sceneGrid_[kSignatureCols * kSignatureRows];
+    size_t sceneJpgLen_;
+    uint32_t sceneSeq_;
+
+    volatile bool running_;
+    uint32_t captureFailures_;
+    uint32_t droppedFrames_;        // Кадры без свободного слота или не влезшие в слот
+    volatile float sensorFps_;
+
+    BlackBoxRecorder* blackBox_;
+    uint32_t lastBlackBoxFrameMs_;  // Только для задачи захвата
+};
+
+#endif // FEATURE_CAMERA
+
+#endif // FRAME_BROKER_H
@@ -0,0 +1,77 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "hardware_config.h"
+
+#ifdef FEATURE_CAMERA
+
+// ═══════════════════════════════════════════════════════════════
+// КОЛЬЦО КАДРОВ СО СЧЕТЧИКОМ ССЫЛОК
+// ═══════════════════════════════════════════════════════════════
+// Один писатель (задача захвата) и любое число читателей (задачи отправки)
+// без блокировок: только атомарные операции над refs и latest_.
+//   - писатель занимает слот с refs == 0, отличный от последнего кадра,
+//     заполняет его и публикует (reserve -> publish или discard)
+//   - читатель берет ссылку на последний кадр (acquireLatest) и держит
+//     слот, сколько нужно; медленный читатель не блокирует писателя,
+//     пока в кольце есть свободные слоты
+// Буферы слотов выделяет владелец (FrameBroker). Не зависит от Arduino/ESP-IDF,
+// проверяется на ПК (test/test_frame_ring).
+
+// Слот кольца кадров
+struct FrameSlot {
+    uint8_t* buf;           // JPEG данные
+    size_t len;             // Размер JPEG
+    size_t capacity;        // Размер выделенного буфера
+    uint32_t seq;           // Порядковый номер кадра (с 1)
+    uint32_t sceneSeq;      // Номер последнего кадра с заметным изменением сцены
+    int64_t timestampUs;    // Время захвата сенсором (esp_timer, мкс)
+    uint16_t width;
+    uint16_t height;
+    uint16_t roiX;          // Окно сенсора (FrameRoi), roiWidth = 0 - полный кадр
+    uint16_t roiY;
+    uint16_t roiWidth;
+    uint16_t roiHeight;
+    std::atomic<int> refs;  // Читатели + FrameRing::kWriterBias, пока слот заполняет писатель
+};
+
+class FrameRing {
+public:
+    static const int kSize = FRAME_RING_SIZE;
+
+    // Смещение счетчика ссылок, пока слот заполняет писатель.
+    // Читатель, увидевший его после своего инкремента, отступает
+    static const int kWriterBias = 1 << 16;
+
+    FrameRing();
+
+    // Буфер слота (владелец, до первого reserve)
+    void attachBuffer(int index, uint8_t* buf, size_t capacity);
+    FrameSlot& slotAt(int index) { return slots_[index]; }
+
+    // Писатель: свободный слот (nullptr - все заняты читателями)
+    FrameSlot* reserve();
+    void discard(FrameSlot* slot);
+
+    // Писатель: данные и seq слота заполнены - кадр становится последним
+    void publish(FrameSlot* slot);
+
+    // Читатель: последний кадр, если он новее lastSeq (иначе nullptr).
+    // Полученный слот обязательно вернуть через release()
+    FrameSlot* acquireLatest(uint32_t lastSeq);
+    void release(FrameSlot* slot);
+
+    uint32_t getLatestSeq() const { return latestSeq_.load(); }
+
+private:
+    FrameSlot slots_[kSize];
+    std::atomic<FrameSlot*> latest_;     // Меняет только писатель
+    std::atomic<uint32_t> latestSeq_;
+};
+
+#endif // FEATURE_CAMERA
+
+#endif // FRAME_RING_H
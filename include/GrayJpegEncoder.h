@@ -0,0 +1,64 @@
+#ifndef GRAY_JPEG_ENCODER_H
+#define GRAY_JPEG_ENCODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ═══════════════════════════════════════════════════════════════
+// КОДЕР ЧБ JPEG
+// ═══════════════════════════════════════════════════════════════
+// Упрощенный baseline JPEG только для яркости (PIXFORMAT_GRAYSCALE у Liner).
+// Таблицы квантования и Хаффмана (стандартные из Annex K) и заголовок
+// файла готовятся один раз при смене качества. Целочисленное DCT (LL&M),
+// запись прямо в буфер вызывающего - на кадр память не выделяется.
+// Не зависит от Arduino/ESP-IDF.
+
+class GrayJpegEncoder {
+public:
+    explicit GrayJpegEncoder(uint8_t quality = 80);
+
+    // Качество 1-100 как у frame2jpg (пересчитывает таблицу квантования)
+    void setQuality(uint8_t quality);
+    uint8_t getQuality() const { return quality_; }
+
+    // Кодирует кадр 8 бит/пиксель в out
+    // Возвращает размер JPEG или 0, если результат не поместился в capacity
+    size_t encode(const uint8_t* gray, uint16_t width, uint16_t height,
+                  uint8_t* out, size_t capacity);
+
+private:
+    static const size_t kHeaderSize = 324;
+    static const int kReciprocalShift = 28;
+
+    // Состояние записи энтропийно-кодированных данных
+    struct BitWriter {
+        uint8_t* out;
+        size_t pos;
+        size_t capacity;
+        uint32_t buffer;
+        int bits;
+        bool overflow;
+    };
+
+    void buildHeader();
+    void encodeBlock(int32_t* block, int& lastDc, BitWriter& writer) const;
+
+    static void fdct(int32_t* block);
+    static void putBits(BitWriter& writer, uint32_t code, int size);
+    static void flushBits(BitWriter& writer);
+
+    uint8_t quality_;
+    uint8_t quant_[64];          // Таблица квантования в порядке зигзага (для DQT)
+    uint32_t divisors_[64];      // Делители в порядке зигзага с учетом масштаба DCT (x8)
+    uint32_t reciprocals_[64];   // ceil(2^28 / делитель) для квантования умножением
+
+    // Коды Хаффмана по символу
+    uint16_t dcCode_[12];
+    uint8_t dcSize_[12];
+    uint16_t acCode_[256];
+    uint8_t acSize_[256];
+
+    uint8_t header_[kHeaderSize];  // SOI..SOS, размеры кадра дописываются при кодировании
+};
+
+#endif // GRAY_JPEG_ENCODER_H
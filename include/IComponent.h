@@ -1,6 +1,8 @@
 #ifndef ICOMPONENT_H
 #define ICOMPONENT_H
 
+#include <stdint.h>
+
 // ═══════════════════════════════════════════════════════════════
 // БАЗОВЫЙ ИНТЕРФЕЙС ДЛЯ ВСЕХ КОМПОНЕНТОВ РОБОТА
 // ═══════════════════════════════════════════════════════════════
@@ -14,9 +16,14 @@ public:
     // Инициализация компонента
     virtual bool init() = 0;
     
-    // Обновление состояния (вызывается в loop)
+    // Обновление состояния (вызывается планировщиком цикла)
     virtual void update() = 0;
     
+    // Желаемый период update() и допустимое время выполнения, мкс
+    // (ComponentScheduler). Период 0 - только по событию
+    virtual uint32_t getUpdatePeriodUs() const { return 0; }
+    virtual uint32_t getUpdateDeadlineUs() const { return 0; }
+    
     // Завершение работы компонента
     virtual void shutdown() = 0;
     
@@ -1,6 +1,7 @@
 #ifndef IMOTOR_CONTROLLER_H
 #define IMOTOR_CONTROLLER_H
 
+#include <Arduino.h>
 #include "IComponent.h"
 
 // ═══════════════════════════════════════════════════════════════
@@ -20,6 +21,12 @@ public:
     // Установка скорости в формате PWM (1000-2000 мкс, центр 1500)
     virtual void setMotorPWM(int throttlePWM, int steeringPWM) = 0;
     
+    // То же для автономного регулятора (PID Лайнера): выход сразу, без
+    // ограничителя плавности - он добавил бы запаздывание в контур
+    virtual void setMotorPWMImmediate(int throttlePWM, int steeringPWM) {
+        setMotorPWM(throttlePWM, steeringPWM);
+    }
+    
     // Остановка моторов
     virtual void stop() = 0;
     
@@ -32,6 +39,12 @@ public:
     // Обновление времени последней команды (для watchdog)
     // Вызывается при получении команды, даже если она не изменилась
     virtual void updateCommandTime() = 0;
+    
+    // Настройки моторов (swap/invert) изменены - пересчитать конфигурацию микшера
+    virtual void onSettingsChanged() {}
+    
+    // Срабатывания watchdog и задержка остановки после таймаута (JSON)
+    virtual String getFailsafeStatsJson() const = 0;
 };
 
 #endif // IMOTOR_CONTROLLER_H
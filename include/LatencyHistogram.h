@@ -0,0 +1,56 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#ifdef ARDUINO
+#include <WString.h>
+#endif
+
+// ═══════════════════════════════════════════════════════════════
+// ГИСТОГРАММА ЗАДЕРЖЕК
+// ═══════════════════════════════════════════════════════════════
+// Фиксированные корзины в микросекундах: запись - один поиск корзины и
+// инкремент, без выделения памяти. Перцентили считаются только при чтении
+// и возвращают верхнюю границу корзины (для последней - максимум).
+// Не зависит от Arduino/ESP-IDF (кроме appendJson для веб-сервера).
+// Синхронизацию обеспечивает владелец.
+
+class LatencyHistogram {
+public:
+    static const int kBucketCount = 16;
+
+    LatencyHistogram();
+
+    void record(uint32_t valueUs);
+    void reset();
+
+    uint32_t getCount() const { return count_; }
+    uint32_t getMaxUs() const { return maxUs_; }
+    uint32_t getAvgUs() const { return count_ ? (uint32_t)(sumUs_ / count_) : 0; }
+
+    // Перцентиль (0-100), оценка сверху по границе корзины
+    uint32_t percentileUs(uint8_t percentile) const;
+
+    // "name":{"count":N,"avg":..,"p50":..,"p95":..,"p99":..,"max":..} в
+    // миллисекундах с одним знаком - общий формат эндпоинтов статистики.
+    // Возвращает длину строки (как snprintf); kJsonSize хватает всегда
+    static const size_t kJsonSize = 160;
+    int formatJsonMs(char* out, size_t size, const char* name) const;
+
+#ifdef ARDUINO
+    void appendJson(String& json, const char* name) const {
+        char buf[kJsonSize];
+        formatJsonMs(buf, sizeof(buf), name);
+        json += buf;
+    }
+#endif
+
+private:
+    uint32_t buckets_[kBucketCount];
+    uint32_t count_;
+    uint64_t sumUs_;
+    uint32_t maxUs_;
+};
+
+#endif // LATENCY_HISTOGRAM_H
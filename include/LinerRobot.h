@@ -7,6 +7,9 @@
 
 #ifdef TARGET_LINER
 
+#include <atomic>
+#include <esp_camera.h>
+
 #ifdef FEATURE_NEOPIXEL
 #include <Adafruit_NeoPixel.h>
 #endif
@@ -27,7 +30,7 @@ public:
     
 protected:
     bool initSpecificComponents() override;
-    void updateSpecificComponents() override;
+    void scheduleSpecificComponents(ComponentScheduler& scheduler) override;
     void shutdownSpecificComponents() override;
     void setupWebHandlers(AsyncWebServer* server) override;
     
@@ -45,9 +48,15 @@ private:
     
     // Алгоритм следования по линии
     void updateLineFollowing();
-    float detectLinePosition(); // Возвращает позицию линии от -1.0 (слева) до 1.0 (справа)
+    float detectLinePosition(camera_fb_t* fb); // Возвращает позицию линии от -1.0 (слева) до 1.0 (справа)
     void applyPIDControl(float linePosition);
     
+    // Задача ожидания кадров для линии: цикл не блокируется в esp_camera_fb_get
+    bool startLineCapture();
+    void stopLineCapture();
+    static void lineCaptureTaskEntry(void* arg);
+    void lineCaptureLoop();
+    
     // Обработка кнопки
     void updateButton();
     void onButtonPressed();
@@ -83,14 +92,16 @@ private:
     int lineNotDetectedCount_;       // Счетчик кадров без линии
     bool lineEndAnimationPlayed_;    // Проиграна ли анимация конца линии
     
+    // Кадр для линии: задача захвата кладет, задача "line" цикла забирает
+    std::atomic<camera_fb_t*> lineFrame_;
+    TaskHandle_t volatile lineCaptureTask_;
+    volatile bool lineCaptureRunning_;
+    int lineTaskId_;                 // Задача планировщика, запускаемая на кадр
+    
     // PID контроллер
     float pidError_;
     float pidLastError_;
     float pidIntegral_;
-    
-    // Управление
-    volatile int targetThrottlePWM_;
-    volatile int targetSteeringPWM_;
 };
 
 #endif // TARGET_LINER
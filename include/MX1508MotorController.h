@@ -2,14 +2,37 @@
 #define MX1508_MOTOR_CONTROLLER_H
 
 #include "IMotorController.h"
+#include "CommandWatchdog.h"
+#include "SlewLimiter.h"
 #include "hardware_config.h"
+#include <esp_timer.h>
+#include <atomic>
 
 class WiFiSettings; // Forward declaration
+class BlackBoxRecorder;
+enum class MotorBrakeMode : uint8_t;  // WiFiSettings.h
 
 // ═══════════════════════════════════════════════════════════════
 // КОНТРОЛЛЕР МОТОРОВ MX1508
 // ═══════════════════════════════════════════════════════════════
 // Реализация управления моторами через драйвер MX1508
+//
+// Watchdog команд - одноразовый esp_timer, перезапускаемый в updateCommandTime().
+// Срок и решение об остановке - в CommandWatchdog (переносимый, проверяется на ПК).
+// Остановку выполняет сам таймер (задача esp_timer, приоритет выше всех
+// задач приложения), поэтому она не ждет цикл робота: блокирующая анимация или
+// переподключение WiFi не задерживают ее. Запись в каналы LEDC из цикла и из
+// таймера разделена мьютексом, чтобы остановка не перемежалась с новой скоростью.
+//
+// setSpeed() задает цель; выход идет к ней через SlewLimiter: первый шаг сразу,
+// дальше - периодический таймер (MOTOR_SLEW_TICK_US). Скорости разгона,
+// сброса и реверса берутся из настроек. Остановка (stop, watchdog) и команды
+// автономного регулятора (setMotorPWMImmediate) - мгновенные.
+//
+// Торможение (режим из настроек): при нулевом выходе и на участке реверса
+// (выход еще в старом направлении, цель - в новом) оба входа драйвера получают
+// одинаковую скважность: 0 - выбег, полная - тормоз, промежуточная - частичный
+// тормоз. Длительность торможения перед реверсом задает скорость реверса.
 
 class MX1508MotorController : public IMotorController {
 public:
@@ -21,28 +44,63 @@ public:
     void update() override;
     void shutdown() override;
     bool isInitialized() const override { return initialized_; }
+    uint32_t getUpdatePeriodUs() const override { return MOTOR_FAILSAFE_REPORT_PERIOD_US; }
     
     // IMotorController interface
     void setSpeed(int leftSpeed, int rightSpeed) override;
     void setMotorPWM(int throttlePWM, int steeringPWM) override;
+    void setMotorPWMImmediate(int throttlePWM, int steeringPWM) override;
     void stop() override;
     void getCurrentSpeed(int& leftSpeed, int& rightSpeed) const override;
     bool wasWatchdogTriggered() const override;
     void updateCommandTime() override;
+    String getFailsafeStatsJson() const override;
+    void onSettingsChanged() override;
     
     // Установка WiFi настроек для применения инвертирования моторов
-    void setWiFiSettings(WiFiSettings* settings) { wifiSettings_ = settings; }
+    void setWiFiSettings(WiFiSettings* settings);
+
+    // Самописец для записи выходов моторов (может быть nullptr)
+    void setBlackBox(BlackBoxRecorder* blackBox) { blackBox_ = blackBox; }
 
 private:
     bool initialized_;
     int currentLeftSpeed_;
     int currentRightSpeed_;
-    unsigned long lastCommandTime_;
-    bool watchdogTriggered_;  // Флаг для отслеживания срабатывания watchdog
+    volatile bool watchdogTriggered_;  // Флаг для отслеживания срабатывания watchdog
     WiFiSettings* wifiSettings_;  // Указатель на настройки для инвертирования моторов
+    BlackBoxRecorder* blackBox_;
+    std::atomic<uint8_t> mixerConfig_;  // swap/invert из настроек (DriveMixer::makeConfig)
+    
+    // Плавность: цель и выход по моторам (защищено outputLock_)
+    SlewLimiter leftSlew_;
+    SlewLimiter rightSlew_;
+    esp_timer_handle_t slewTimer_;
+    volatile bool slewActive_;                // Выход еще не дошел до цели
+    
+    // Торможение (защищено outputLock_)
+    MotorBrakeMode brakeMode_;
+    int brakeStrength_;                       // Тормоз на остановке в PROPORTIONAL, %
+    
+    // Watchdog команд
+    esp_timer_handle_t failsafeTimer_;
+    SemaphoreHandle_t outputLock_;            // Каналы LEDC, ограничители и текущая скорость
+    CommandWatchdog watchdog_;                // Срок остановки; счетчики защищены statsMux_
+    mutable portMUX_TYPE statsMux_;
+    uint32_t reportedTrips_;                  // Только цикл (update)
     
     // Внутренние методы
+    static void failsafeTimerCallback(void* arg);
+    void onFailsafeTimer();
+    static void slewTimerCallback(void* arg);
+    void onSlewTimer();
+    void applyTarget(int leftSpeed, int rightSpeed, bool limited);
+    void mixPWM(int throttlePWM, int steeringPWM, int& leftSpeed, int& rightSpeed) const;
+    bool stepOutputs(bool force);
+    void writeStop();
     void applyMotorSpeed(int leftSpeed, int rightSpeed);
+    int brakeDuty(int speed, int target) const;
+    int writeMotor(uint8_t fwdChannel, uint8_t revChannel, int speed, int brake);
     int constrainSpeed(int speed) const;
 };
 
@@ -0,0 +1,103 @@
+#ifndef SLEW_LIMITER_H
+#define SLEW_LIMITER_H
+
+#include <stdint.h>
+
+// ═══════════════════════════════════════════════════════════════
+// ОГРАНИЧИТЕЛЬ СКОРОСТИ НАРАСТАНИЯ (ОДИН МОТОР)
+// ═══════════════════════════════════════════════════════════════
+// Выход идет к цели (-100..100) не быстрее заданной скорости, %/с:
+//   accel   - модуль растет (разгон, в том числе с места)
+//   decel   - модуль падает в том же направлении (сброс газа)
+//   reverse - цель в обратную сторону: выход идет к нулю, дальше - разгон
+// 0 - без ограничения (скачок сразу к цели, как без ограничителя).
+// Скачок 0 -> 100% просаживает питание ESP32-CAM и срывает колеса в пробуксовку.
+//
+// Выход хранится в 1/256 процента, шаг за тик считается один раз в setRates.
+// Не зависит от Arduino/ESP-IDF, синхронизацию обеспечивает владелец.
+
+class SlewLimiter {
+public:
+    static const int32_t kScale = 256;
+
+    SlewLimiter() : output_(0), target_(0), accelStep_(0), decelStep_(0), reverseStep_(0) {}
+
+    void setRates(uint32_t accelPerSec, uint32_t decelPerSec, uint32_t reversePerSec, uint32_t tickUs) {
+        accelStep_ = rateToStep(accelPerSec, tickUs);
+        decelStep_ = rateToStep(decelPerSec, tickUs);
+        reverseStep_ = rateToStep(reversePerSec, tickUs);
+    }
+
+    void setTarget(int speed) { target_ = (int32_t)speed * kScale; }
+
+    // Цель без ограничения: выход сразу на цели (команды регулятора с
+    // обратной связью - ограничитель добавил бы запаздывание в контур)
+    void jumpTo(int speed) {
+        target_ = (int32_t)speed * kScale;
+        output_ = target_;
+    }
+
+    // Немедленная остановка (watchdog, stop) - без ограничения
+    void reset() {
+        output_ = 0;
+        target_ = 0;
+    }
+
+    // Один тик. Возвращает true, если изменился целый выход
+    bool step() {
+        if (output_ == target_) {
+            return false;
+        }
+        const int before = getOutput();
+
+        if ((output_ > 0 && target_ < 0) || (output_ < 0 && target_ > 0)) {
+            // Смена направления: сначала до нуля
+            output_ = approach(output_, 0, reverseStep_);
+            if (output_ != 0 || reverseStep_ != 0) {
+                return getOutput() != before;
+            }
+        }
+
+        const bool growing = magnitude(target_) > magnitude(output_);
+        output_ = approach(output_, target_, growing ? accelStep_ : decelStep_);
+        return getOutput() != before;
+    }
+
+    // Выход в процентах (округление к ближайшему)
+    int getOutput() const {
+        return output_ >= 0 ? (output_ + kScale / 2) / kScale : -((-output_ + kScale / 2) / kScale);
+    }
+
+    int getTarget() const { return target_ / kScale; }
+    bool isSettled() const { return output_ == target_; }
+
+private:
+    static int32_t rateToStep(uint32_t perSec, uint32_t tickUs) {
+        if (perSec == 0) {
+            return 0;
+        }
+        const int32_t step = (int32_t)((uint64_t)perSec * kScale * tickUs / 1000000);
+        return step > 0 ? step : 1;
+    }
+
+    static int32_t magnitude(int32_t value) { return value < 0 ? -value : value; }
+
+    // Шаг 0 - сразу к цели
+    static int32_t approach(int32_t from, int32_t to, int32_t step) {
+        if (step == 0) {
+            return to;
+        }
+        if (from < to) {
+            return from + step < to ? from + step : to;
+        }
+        return from - step > to ? from - step : to;
+    }
+
+    int32_t output_;
+    int32_t target_;
+    int32_t accelStep_;
+    int32_t decelStep_;
+    int32_t reverseStep_;
+};
+
+#endif // SLEW_LIMITER_H
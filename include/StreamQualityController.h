@@ -0,0 +1,88 @@
+#ifndef STREAM_QUALITY_CONTROLLER_H
+#define STREAM_QUALITY_CONTROLLER_H
+
+#include <stdint.h>
+
+// ═══════════════════════════════════════════════════════════════
+// АДАПТИВНОЕ КАЧЕСТВО ВИДЕОСТРИМА
+// ═══════════════════════════════════════════════════════════════
+// Замкнутый контур: по времени отправки кадров, размеру JPEG и FPS
+// выбирает ступень из лестницы (разрешение + качество JPEG), чтобы
+// удерживать целевую задержку кадра на перегруженном WiFi.
+//   - облегчаем кадр, если отправка дольше цели или канал занят почти
+//     непрерывно, а FPS ниже STREAM_QC_MIN_FPS
+//   - возвращаем качество, только если прогноз времени отправки более
+//     тяжелого кадра (по размерам JPEG ступеней) укладывается в цель
+// Не зависит от Arduino/ESP-IDF: применение ступени к сенсору делает
+// FrameBroker, здесь только логика с гистерезисом.
+
+class StreamQualityController {
+public:
+    // Ступень лестницы качества (0 - лучшее качество)
+    struct OperatingPoint {
+        uint16_t width;
+        uint16_t height;
+        uint8_t quality;        // jpeg_quality сенсора (меньше = лучше)
+    };
+
+    StreamQualityController();
+
+    // Выключение возвращает ступень 0: evaluate() один раз вернет true,
+    // чтобы владелец применил исходные настройки сенсора
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled_; }
+
+    void setTargetLatencyMs(uint32_t targetMs);
+    uint32_t getTargetLatencyMs() const { return targetLatencyMs_; }
+
+    // Отчет об отправленном кадре (вызывается задачами отправки)
+    void onFrameSent(uint32_t sendUs, uint32_t jpegBytes);
+
+    // Периодическая оценка окна измерений
+    // Возвращает true, если ступень изменилась и ее нужно применить к сенсору
+    // (в том числе сброс на ступень 0 после setEnabled(false))
+    bool evaluate(uint32_t nowMs);
+
+    int getLevel() const { return level_; }
+    static int getLevelCount();
+    const OperatingPoint& getOperatingPoint() const;
+
+    // Метрики последнего завершенного окна
+    uint32_t getAvgSendUs() const { return avgSendUs_; }
+    uint32_t getAvgFrameBytes() const { return avgFrameBytes_; }
+    float getFps() const { return fps_; }
+
+    // Ожидаемый размер кадра ступени: измеренный на ней или оценка от
+    // текущего размера по пикселям и качеству лестницы
+    uint32_t estimateFrameBytes(int level) const;
+
+private:
+    static const int kMaxLevels = 8;
+
+    bool enabled_;
+    uint32_t targetLatencyMs_;
+    int level_;
+    bool applyPending_;         // Ступень сменилась вне evaluate() (сброс при выключении)
+
+    // Накопители текущего окна
+    uint32_t windowStartMs_;
+    uint32_t windowFrames_;
+    uint64_t windowSendUs_;
+    uint64_t windowBytes_;
+
+    // Гистерезис: сколько окон подряд задержка выше/ниже порогов
+    int overCount_;
+    int underCount_;
+
+    // Результаты последнего окна
+    uint32_t avgSendUs_;
+    uint32_t avgFrameBytes_;
+    float fps_;
+
+    // Средний размер кадра, последний раз измеренный на каждой ступени (0 - не было)
+    uint32_t levelFrameBytes_[kMaxLevels];
+
+    void resetWindow(uint32_t nowMs);
+};
+
+#endif // STREAM_QUALITY_CONTROLLER_H
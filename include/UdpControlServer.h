@@ -0,0 +1,57 @@
+#ifndef UDP_CONTROL_SERVER_H
+#define UDP_CONTROL_SERVER_H
+
+#include <Arduino.h>
+#include <AsyncUDP.h>
+#include <functional>
+#include "hardware_config.h"
+#include "ControlSequencer.h"
+
+#ifdef FEATURE_UDP_CONTROL
+
+// ═══════════════════════════════════════════════════════════════
+// UDP КАНАЛ УПРАВЛЕНИЯ
+// ═══════════════════════════════════════════════════════════════
+// Команды движения датаграммами в формате ControlPacket.h. В отличие от
+// TCP, после сбоя WiFi пакеты не выстраиваются в очередь за потерянным:
+// для каждого источника (IP:порт) ControlSequencer отбрасывает старые,
+// повторные и устаревшие пакеты - побеждает команда с новейшим seq.
+// Принятые команды идут тем же путем, что и /move.
+
+class UdpControlServer {
+public:
+    typedef std::function<void(int throttlePWM, int steeringPWM)> CommandHandler;
+
+    UdpControlServer();
+
+    bool begin(uint16_t port, CommandHandler handler);
+    void end();
+
+    // Счетчики по источникам и отброшенные пакеты
+    String getStatsJson();
+
+private:
+    struct Source {
+        bool used;
+        uint32_t ip;
+        uint16_t port;
+        uint32_t lastSeenMs;
+        ControlSequencer sequencer;
+
+        Source();
+    };
+
+    void handlePacket(AsyncUDPPacket& packet);
+    Source* findSource(uint32_t ip, uint16_t port, uint32_t nowMs);
+
+    AsyncUDP udp_;
+    CommandHandler handler_;
+    uint16_t port_;
+    Source sources_[CONTROL_UDP_MAX_SOURCES];
+    uint32_t malformed_;                // Не пакет управления
+    portMUX_TYPE mux_;                  // Источники: задача async_udp и веб-сервер
+};
+
+#endif // FEATURE_UDP_CONTROL
+
+#endif // UDP_CONTROL_SERVER_H
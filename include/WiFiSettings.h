@@ -10,6 +10,13 @@ enum class WiFiMode {
     AP = 1       // Режим точки доступа
 };
 
+// Торможение моторов на остановке и при смене направления
+enum class MotorBrakeMode : uint8_t {
+    COAST = 0,         // Оба входа драйвера LOW - выбег (по умолчанию)
+    BRAKE = 1,         // Оба входа HIGH - обмотка замкнута, полный тормоз
+    PROPORTIONAL = 2   // Тормоз ШИМ: на остановке - сила из настроек, при реверсе - по команде
+};
+
 /**
  * @brief Класс для управления настройками WiFi в энергонезависимой памяти
  */
@@ -31,6 +38,11 @@ public:
     bool getMotorSwapLeftRight() const { return motorSwapLeftRight; }
     bool getMotorInvertLeft() const { return motorInvertLeft; }
     bool getMotorInvertRight() const { return motorInvertRight; }
+    int getMotorAccelRate() const { return motorAccelRate; }
+    int getMotorDecelRate() const { return motorDecelRate; }
+    int getMotorReverseRate() const { return motorReverseRate; }
+    MotorBrakeMode getMotorBrakeMode() const { return motorBrakeMode; }
+    int getMotorBrakeStrength() const { return motorBrakeStrength; }
     
     // Получение настроек инверсии стиков
     bool getInvertThrottleStick() const { return invertThrottleStick; }
@@ -39,6 +51,7 @@ public:
     // Получение настроек камеры
     bool getCameraHMirror() const { return cameraHMirror; }
     bool getCameraVFlip() const { return cameraVFlip; }
+    String getCameraProfileName() const { return cameraProfileName; }
     
     // Получение настроек эффектов
     int getEffectMode() const { return effectMode; }
@@ -53,6 +66,11 @@ public:
     void setMotorSwapLeftRight(bool value);
     void setMotorInvertLeft(bool value);
     void setMotorInvertRight(bool value);
+    void setMotorAccelRate(int value);
+    void setMotorDecelRate(int value);
+    void setMotorReverseRate(int value);
+    void setMotorBrakeMode(MotorBrakeMode value);
+    void setMotorBrakeStrength(int value);
     
     // Установка настроек инверсии стиков
     void setInvertThrottleStick(bool value);
@@ -61,6 +79,7 @@ public:
     // Установка настроек камеры
     void setCameraHMirror(bool value);
     void setCameraVFlip(bool value);
+    void setCameraProfileName(const String& value);
     
     // Установка настроек эффектов
     void setEffectMode(int value);
@@ -86,6 +105,11 @@ private:
     bool motorSwapLeftRight;    // Поменять местами левый и правый моторы
     bool motorInvertLeft;       // Инвертировать направление левого мотора
     bool motorInvertRight;      // Инвертировать направление правого мотора
+    int motorAccelRate;         // Плавность разгона, %/с (0 - без ограничения)
+    int motorDecelRate;         // Плавность сброса газа, %/с
+    int motorReverseRate;       // Плавность смены направления, %/с
+    MotorBrakeMode motorBrakeMode;  // Торможение на остановке и при реверсе
+    int motorBrakeStrength;     // Сила тормоза на остановке (PROPORTIONAL), %
     
     // Настройки инверсии стиков
     bool invertThrottleStick;   // Инвертировать стик газа (вперёд/назад)
@@ -94,6 +118,7 @@ private:
     // Настройки камеры
     bool cameraHMirror;         // Горизонтальное зеркало камеры
     bool cameraVFlip;           // Вертикальный переворот камеры
+    String cameraProfileName;   // Профиль сенсора (CameraProfile.h), пусто - по типу робота
     
     // Настройки эффектов
     int effectMode;             // Режим световых эффектов (0-4: normal, police, fire, ambulance, terminator)
@@ -49,6 +49,8 @@
     #endif
     #define LED_BRIGHTNESS_DEFAULT 128   // Яркость по умолчанию (50%)
     #define LED_BRIGHTNESS_MAX 255       // Максимальная яркость
+    #define LED_UPDATE_PERIOD_US 33333   // Обновление LED в цикле: 30 Гц
+    #define LED_UPDATE_DEADLINE_US 3000
 #endif
 
 #ifdef FEATURE_BUZZER
@@ -65,6 +67,7 @@
     #define BUTTON_DEBOUNCE_MS 200  // Время антидребезга (увеличено для предотвращения ложных срабатываний при загрузке)
     #define BUTTON_INIT_DELAY_MS 2000  // Задержка перед первой проверкой кнопки после инициализации
     #define BUTTON_DIAG_INTERVAL_MS 2000  // Интервал вывода диагностики кнопки
+    #define BUTTON_POLL_PERIOD_US 20000   // Опрос кнопки в цикле: 50 Гц
 #endif
 
 #ifdef FEATURE_MOTORS
@@ -78,23 +81,95 @@
     #define MOTOR_PWM_FREQ 8000     // 8 кГц
     #define MOTOR_PWM_RESOLUTION 13 // 13-битное разрешение (8192 макс)
     
-    // Каналы PWM (как в Scout32!)
-    #define MOTOR_PWM_CHANNEL_LF 3  // Канал PWM для левого мотора вперед (GPIO12)
-    #define MOTOR_PWM_CHANNEL_LR 4  // Канал PWM для левого мотора назад (GPIO13)
-    #define MOTOR_PWM_CHANNEL_RF 2  // Канал PWM для правого мотора вперед (GPIO14)
-    #define MOTOR_PWM_CHANNEL_RR 5  // Канал PWM для правого мотора назад (GPIO15)
+    // Каналы PWM. Входы одного мотора - на общем таймере LEDC (каналы 2n и 2n+1),
+    // чтобы ШИМ тормоза на обоих входах шел в фазе (иначе вместо торможения - рывки)
+    #define MOTOR_PWM_CHANNEL_LF 2  // Канал PWM для левого мотора вперед (GPIO12, таймер 1)
+    #define MOTOR_PWM_CHANNEL_LR 3  // Канал PWM для левого мотора назад (GPIO13, таймер 1)
+    #define MOTOR_PWM_CHANNEL_RF 4  // Канал PWM для правого мотора вперед (GPIO14, таймер 2)
+    #define MOTOR_PWM_CHANNEL_RR 5  // Канал PWM для правого мотора назад (GPIO15, таймер 2)
 
     // Ограничение мощности моторов (защита от перегрева регулятора)
     #define MOTOR_MAX_POWER_PERCENT 100  // Максимальная мощность в процентах (0-100)
     
-    // Watchdog для автоостановки моторов
+    // Кривая газа/руля (таблицы DriveMixer.h строятся при компиляции)
+    #define MOTOR_DEADBAND_PERCENT 0     // Мертвая зона у центра стика (0-99)
+    #define MOTOR_EXPO_PERCENT 0         // Экспонента: 0 - линейно, 100 - кубическая кривая
+    
+    // Плавность разгона (SlewLimiter.h): скорость изменения выхода, %/с, 0 - без ограничения.
+    // Значения по умолчанию, меняются в настройках моторов
+    #define MOTOR_SLEW_TICK_US 5000              // Тик ограничителя (200 Гц, таймер esp_timer)
+    #define MOTOR_SLEW_ACCEL_DEFAULT 400         // Разгон 0 -> 100% за 250 мс
+    #define MOTOR_SLEW_DECEL_DEFAULT 800         // Сброс газа
+    #define MOTOR_SLEW_REVERSE_DEFAULT 600       // Торможение перед сменой направления
+    #define MOTOR_SLEW_RATE_MAX 10000            // Верхняя граница в настройках
+    
+    // Торможение на остановке, по watchdog и при смене направления (MX1508: оба входа
+    // HIGH - тормоз, оба LOW - выбег). Значения по умолчанию, меняются в настройках моторов
+    #define MOTOR_BRAKE_MODE_DEFAULT 0           // MotorBrakeMode: 0 - выбег, 1 - тормоз, 2 - пропорциональный
+    #define MOTOR_BRAKE_STRENGTH_DEFAULT 50      // Тормоз на остановке в пропорциональном режиме, %
+    
+    // Watchdog для автоостановки моторов (таймер esp_timer, перезапускается каждой командой)
     #define MOTOR_COMMAND_TIMEOUT_MS 500  // Если команды не приходят N мс - останавливаем моторы
+    #define MOTOR_FAILSAFE_REPORT_PERIOD_US 100000  // Сообщение о срабатывании в журнал (из цикла)
+    
+    // Расписание цикла: применение команд (задача по trigger на каждую команду)
+    #define MOTOR_UPDATE_DEADLINE_US 300
+#endif
+
+#ifdef FEATURE_CAMERA
+    // Видеострим: один захват камеры раздается всем зрителям (FrameBroker)
+    #define STREAM_MAX_CLIENTS 3            // Максимум одновременных зрителей /stream
+    #define FRAME_RING_SIZE (STREAM_MAX_CLIENTS + 2)  // По слоту на зрителя + последний кадр + слот для записи
+    #define FRAME_SLOT_CAPACITY_PSRAM (32 * 1024)     // Размер слота кадра в PSRAM
+    #define FRAME_SLOT_CAPACITY_DRAM (12 * 1024)      // Размер слота кадра без PSRAM
+    #define CAMERA_CAPTURE_TASK_PRIORITY 3  // Приоритет задачи захвата кадров
+    #define CAMERA_CAPTURE_TASK_STACK 4096
+    #define CAMERA_CAPTURE_TASK_CORE 1      // Ядро задачи захвата (WiFi/lwIP на ядре 0)
+    #define STREAM_TX_TASK_PRIORITY 2       // Приоритет задач отправки (ниже управления)
+    #define STREAM_TX_TASK_STACK 4096
+    #define STREAM_FRAME_WAIT_MS 1000       // Таймаут ожидания нового кадра отправителем
+    #define STREAM_FPS_CAP_MAX 30           // Максимум для параметра /stream?fps=N
+    #define STREAM_GRAY_JPEG_QUALITY 80     // Качество JPEG для не-JPEG кадров сенсора (ЧБ у Liner)
+
+    // Пропуск повторяющихся кадров статичной сцены (/stream?dedup=1)
+    #define STREAM_DEDUP_KEEPALIVE_MS 1000      // Минимальный интервал кадров для неизменной сцены
+    #define STREAM_DEDUP_SIZE_TOLERANCE_PCT 3   // JPEG: изменение размера меньше N% - та же сцена
+    #define STREAM_DEDUP_PIXEL_THRESHOLD 6      // ЧБ: средняя разница выборки пикселей меньше N - та же сцена
+
+    // Адаптивное качество стрима (StreamQualityController)
+    #define STREAM_QC_TARGET_LATENCY_MS 80  // Целевое время доставки кадра
+    #define STREAM_QC_WINDOW_MS 1000        // Окно усреднения измерений
+    #define STREAM_QC_MIN_FPS 10            // Канал не тянет эту частоту кадров - облегчаем кадр
+
+    // Окно сенсора (ROI): режим SVGA OV2640, выход не больше буфера кадра QVGA
+    #define CAMERA_ROI_SENSOR_WIDTH 800
+    #define CAMERA_ROI_SENSOR_HEIGHT 600
+    #define CAMERA_ROI_MAX_OUTPUT_WIDTH 320
+    #define CAMERA_ROI_MAX_OUTPUT_HEIGHT 240
+    #define CAMERA_ROI_SETTLE_FRAMES 2      // Пропустить кадры из очереди драйвера после смены окна
+
+    // Профиль сенсора по умолчанию (CameraProfile.cpp), если в настройках не выбран.
+    // "driving" повторяет прежние настройки initCamera для всех роботов: пороги
+    // LINE_* у Liner подобраны под них, профиль "line" включается только явно
+    #define CAMERA_DEFAULT_PROFILE "driving"
+#endif
+
+#ifdef FEATURE_BLACKBOX
+    // Самописец (BlackBoxRecorder): кольцо в PSRAM
+    #define BLACKBOX_BUFFER_SIZE (1024 * 1024)  // Размер кольца
+    #define BLACKBOX_WINDOW_MS 30000            // Хранить последние N мс
+    #define BLACKBOX_FRAME_INTERVAL_MS 500      // Интервал записи кадров (2 FPS)
 #endif
 
 // ═══════════════════════════════════════════════════════════════
 // КОНФИГУРАЦИЯ ПРОТОКОЛОВ (для TARGET_BRAIN)
 // ═══════════════════════════════════════════════════════════════
 
+#ifdef FEATURE_PROTOCOL_TRANSLATOR
+    #define PROTOCOL_OUTPUT_PERIOD_US 10000     // Обновление выходов Brain в цикле: 100 Гц
+    #define PROTOCOL_OUTPUT_DEADLINE_US 2000
+#endif
+
 #ifdef FEATURE_PWM_OUTPUT
     #define PWM_OUT_PIN_1 12
     #define PWM_OUT_PIN_2 13
@@ -137,6 +212,19 @@
 #define WIFI_HIDDEN false
 #define WIFI_MAX_CONNECTIONS 4
 
+// Бинарный канал управления /ws/control (ControlPacket.h)
+#define CONTROL_WS_MAX_CLIENTS 2       // Лишние соединения закрываются при очистке
+#define CONTROL_WS_CLEANUP_MS 1000     // Период очистки закрытых клиентов AsyncWebSocket
+
+#ifdef FEATURE_UDP_CONTROL
+    // UDP канал управления (UdpControlServer, тот же ControlPacket)
+    #define CONTROL_UDP_PORT 4210
+    #define CONTROL_UDP_MAX_SOURCES 4           // Одновременно отслеживаемых отправителей
+    #define CONTROL_UDP_MAX_AGE_MS 150          // Пакет старше (относительно лучшей задержки) - устарел
+    #define CONTROL_UDP_SESSION_TIMEOUT_MS 3000 // Пауза, после которой seq источника начинается заново
+    #define CONTROL_UDP_BASELINE_WINDOW_MS 10000 // Окно минимума задержки (уход часов клиента)
+#endif
+
 // IP адреса для AP режима
 #define AP_IP_ADDR 192, 168, 4, 1
 #define AP_GATEWAY 192, 168, 4, 1
@@ -157,6 +245,9 @@
     #define LINE_PID_KI 0.0            // Интегральный коэффициент PID
     #define LINE_PID_KD 0.1            // Дифференциальный коэффициент PID
     #define LINE_BASE_SPEED 50          // Базовая скорость движения (%)
+    #define LINE_FOLLOW_DEADLINE_US 10000       // Обработка кадра линии + PID
+    #define LINE_CAPTURE_TASK_PRIORITY 2        // Ожидание кадров для линии (выше цикла)
+    #define LINE_CAPTURE_TASK_STACK 3072
 #endif
 
 // Режим управления моторами
@@ -167,7 +258,22 @@ enum class ControlMode {
 // Диагностика
 #define MODE_DIAG_INTERVAL_MS 5000  // Интервал вывода диагностики режима работы
 
+// Планировщик цикла (ComponentScheduler): сон между задачами не дольше N мс
+#define SCHEDULER_MAX_SLEEP_MS 10
+
+// Быстрый журнал FAST_LOG (FastLog.h): кольцо записей и задача выгрузки в UART
+#define FAST_LOG_CAPACITY 128           // Записей в кольце (степень двойки, 40 байт каждая)
+#define FAST_LOG_DRAIN_INTERVAL_MS 20   // Период выгрузки
+#define FAST_LOG_TASK_PRIORITY 1        // Ниже управления и стрима
+#define FAST_LOG_TASK_STACK 3072
+// #define FAST_LOG_BINARY_OUTPUT       // Записи в UART как есть (scripts/fastlog_decode.py)
+
 #if defined(FEATURE_NEOPIXEL) || defined(FEATURE_BUZZER)
+// Обновление эффектов в цикле: 30 Гц, мигающие эффекты - шаг раз в 3 обновления (100 мс)
+#define EFFECT_UPDATE_PERIOD_US 33333
+#define EFFECT_UPDATE_DEADLINE_US 3000
+#define EFFECT_BLINK_TICKS 3
+
 // Эффекты и режимы
 enum class EffectMode {
     NORMAL = 0,      // Обычный режим
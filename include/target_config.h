@@ -45,6 +45,8 @@
     #define FEATURE_NEOPIXEL            // Светодиоды
     // #define FEATURE_BUZZER              // Звуковые эффекты (ОТКЛЮЧЕНО: конфликт пинов)
     #define FEATURE_REMOTE_CONTROL      // Управление с телефона/компьютера
+    #define FEATURE_BLACKBOX            // Самописец кадров и команд в PSRAM
+    #define FEATURE_UDP_CONTROL         // Команды движения по UDP (порт CONTROL_UDP_PORT)
 #endif
 
 #ifdef TARGET_LINER
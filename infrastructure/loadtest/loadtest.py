@@ -0,0 +1,478 @@
+#!/usr/bin/env python3
+"""Нагрузочный тест и soak-бенчмарк MicroBox.
+
+Открывает K соединений /stream (порт 81) и параллельно шлет команды
+с частотой 20 Гц, как пульт в браузере: HTTP /move, бинарные пакеты по
+/ws/control (--control ws) или UDP (--control udp). Записывает:
+  - интервалы между кадрами каждого зрителя (джиттер доставки видео)
+  - RTT команды (ответ /move или ACK пакета) и пропуски отправки, если
+    предыдущая команда еще не получила ответ
+
+Работает и с реальным роботом, и с mock_robot.py (без железа).
+Только стандартная библиотека Python 3.8+.
+"""
+
+import argparse
+import asyncio
+import base64
+import json
+import math
+import os
+import random
+import struct
+import sys
+import time
+
+
+PWM_NEUTRAL = 1500     # Команда "стоп": газ и руль в центре (PWM 1000..2000)
+
+
+def percentile(sorted_values, p):
+    if not sorted_values:
+        return 0.0
+    k = max(0, min(len(sorted_values) - 1, math.ceil(p / 100.0 * len(sorted_values)) - 1))
+    return sorted_values[k]
+
+
+def summarize(values_ms):
+    values = sorted(values_ms)
+    return {
+        "count": len(values),
+        "avg": round(sum(values) / len(values), 2) if values else 0.0,
+        "p50": round(percentile(values, 50), 2),
+        "p95": round(percentile(values, 95), 2),
+        "p99": round(percentile(values, 99), 2),
+        "max": round(values[-1], 2) if values else 0.0,
+    }
+
+
+def format_summary(name, s):
+    return ("%-22s n=%-6d avg=%7.1f p50=%7.1f p95=%7.1f p99=%7.1f max=%7.1f мс"
+            % (name, s["count"], s["avg"], s["p50"], s["p95"], s["p99"], s["max"]))
+
+
+async def read_headers(reader):
+    headers = {}
+    while True:
+        line = await reader.readline()
+        if not line:
+            raise ConnectionError("соединение закрыто")
+        if line in (b"\r\n", b"\n"):
+            return headers
+        key, _, value = line.decode("latin-1").partition(":")
+        headers[key.strip().lower()] = value.strip()
+
+
+# ═══════════════════════════════════════════════════════════════
+# ЗРИТЕЛЬ /stream
+# ═══════════════════════════════════════════════════════════════
+
+class StreamViewer:
+    def __init__(self, index, args):
+        self.index = index
+        self.args = args
+        self.intervals_ms = []
+        self.frames = 0
+        self.bytes = 0
+        self.reconnects = 0
+        self.errors = 0
+        self.last_error = ""
+
+    async def run(self, deadline):
+        while time.monotonic() < deadline:
+            try:
+                await asyncio.wait_for(self.session(deadline),
+                                       timeout=max(0.1, deadline - time.monotonic()))
+            except asyncio.TimeoutError:
+                break
+            except (OSError, ConnectionError, ValueError, asyncio.IncompleteReadError) as e:
+                self.errors += 1
+                self.last_error = str(e) or type(e).__name__
+                await asyncio.sleep(1.0)
+                self.reconnects += 1
+
+    async def session(self, deadline):
+        reader, writer = await asyncio.open_connection(self.args.host, self.args.stream_port)
+        try:
+            path = "/stream"
+            if self.args.fps:
+                path += "?fps=%d" % self.args.fps
+            writer.write(("GET %s HTTP/1.1\r\nHost: %s\r\n\r\n"
+                          % (path, self.args.host)).encode())
+            await writer.drain()
+
+            status = (await reader.readline()).decode("latin-1").strip()
+            headers = await read_headers(reader)
+            if " 200" not in status:
+                raise ConnectionError("ответ /stream: %s" % status)
+            content_type = headers.get("content-type", "")
+            if "boundary=" not in content_type:
+                raise ValueError("нет boundary в Content-Type: %s" % content_type)
+            boundary = b"--" + content_type.split("boundary=", 1)[1].strip().encode()
+
+            last_arrival = None
+            while time.monotonic() < deadline:
+                # Строка-разделитель части (перед ней может быть пустая строка)
+                line = await reader.readline()
+                if not line:
+                    raise ConnectionError("стрим закрыт сервером")
+                if not line.strip():
+                    continue
+                if not line.startswith(boundary):
+                    raise ValueError("ожидался разделитель части, получено %r" % line[:40])
+                part = await read_headers(reader)
+                length = int(part.get("content-length", "0"))
+                if length <= 0:
+                    raise ValueError("часть без Content-Length")
+                await reader.readexactly(length)
+
+                now = time.monotonic()
+                if last_arrival is not None:
+                    self.intervals_ms.append((now - last_arrival) * 1000.0)
+                last_arrival = now
+                self.frames += 1
+                self.bytes += length
+        finally:
+            writer.close()
+
+
+# ═══════════════════════════════════════════════════════════════
+# ПОТОК КОМАНД /move
+# ═══════════════════════════════════════════════════════════════
+
+class MoveClient:
+    """Команды с фиксированной частотой по одному keep-alive соединению.
+
+    Как и пульт в браузере, следующая команда не отправляется, пока не
+    пришел ответ на предыдущую: такие такты считаются пропущенными.
+    """
+
+    def __init__(self, args):
+        self.args = args
+        self.rtt_ms = []
+        self.sent = 0
+        self.skipped = 0
+        self.errors = 0
+        self.reconnects = 0
+        self.last_error = ""
+        self.reader = None
+        self.writer = None
+        self.busy = False
+
+    async def connect(self):
+        self.reader, self.writer = await asyncio.open_connection(self.args.host,
+                                                                 self.args.http_port)
+
+    def disconnect(self):
+        if self.writer is not None:
+            self.writer.close()
+        self.reader = self.writer = None
+
+    async def send_command(self, throttle, steering):
+        self.busy = True
+        try:
+            if self.writer is None:
+                await self.connect()
+                self.reconnects += 1
+            start = time.monotonic()
+            self.writer.write(("GET /move?t=%d&s=%d HTTP/1.1\r\nHost: %s\r\n"
+                               "Connection: keep-alive\r\n\r\n"
+                               % (throttle, steering, self.args.host)).encode())
+            await self.writer.drain()
+            status = (await self.reader.readline()).decode("latin-1").strip()
+            if not status:
+                raise ConnectionError("соединение закрыто")
+            headers = await read_headers(self.reader)
+            length = int(headers.get("content-length", "0"))
+            if length:
+                await self.reader.readexactly(length)
+            self.rtt_ms.append((time.monotonic() - start) * 1000.0)
+            self.sent += 1
+            if " 200" not in status:
+                raise ConnectionError("ответ /move: %s" % status)
+            if headers.get("connection", "").lower() == "close":
+                self.disconnect()
+        except (OSError, ConnectionError, ValueError, asyncio.IncompleteReadError,
+                asyncio.TimeoutError) as e:
+            self.errors += 1
+            self.last_error = str(e) or type(e).__name__
+            self.disconnect()
+        finally:
+            self.busy = False
+
+    async def run(self, deadline):
+        period = 1.0 / self.args.move_hz
+        next_tick = time.monotonic()
+        pending = None
+        phase = random.uniform(0, 2 * math.pi)
+        try:
+            while time.monotonic() < deadline:
+                if self.busy:
+                    self.skipped += 1
+                else:
+                    # Плавно меняющиеся значения, чтобы робот не дергался при тесте
+                    t = time.monotonic()
+                    throttle = PWM_NEUTRAL + int(self.args.move_amplitude * math.sin(t + phase))
+                    steering = PWM_NEUTRAL + int(self.args.move_amplitude * math.cos(0.5 * t + phase))
+                    pending = asyncio.ensure_future(asyncio.wait_for(
+                        self.send_command(throttle, steering), timeout=self.args.move_timeout))
+                next_tick += period
+                await asyncio.sleep(max(0.0, next_tick - time.monotonic()))
+            if pending is not None:
+                await asyncio.gather(pending, return_exceptions=True)
+            # Остановить робота в конце теста
+            await asyncio.wait_for(self.send_command(PWM_NEUTRAL, PWM_NEUTRAL), timeout=self.args.move_timeout)
+        except asyncio.TimeoutError:
+            pass
+        finally:
+            self.disconnect()
+
+
+class WsMoveClient(MoveClient):
+    """Те же команды бинарными пакетами по /ws/control (include/ControlPacket.h)."""
+
+    # Версия, тип, флаги, резерв, seq, газ, руль, время клиента
+    PACKET = struct.Struct("<BBBBIHHI")
+    COMMAND, ACK = 1, 2
+    FLAG_ACK = 0x02
+
+    def __init__(self, args):
+        super().__init__(args)
+        self.seq = 0
+
+    async def connect(self):
+        await super().connect()
+        key = base64.b64encode(os.urandom(16)).decode()
+        self.writer.write(("GET /ws/control HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\n"
+                           "Connection: Upgrade\r\nSec-WebSocket-Key: %s\r\n"
+                           "Sec-WebSocket-Version: 13\r\n\r\n" % (self.args.host, key)).encode())
+        await self.writer.drain()
+        status = (await self.reader.readline()).decode("latin-1").strip()
+        await read_headers(self.reader)
+        if " 101" not in status:
+            raise ConnectionError("ответ /ws/control: %s" % status)
+
+    def send_frame(self, opcode, payload):
+        # Кадры клиента всегда маскируются (RFC 6455)
+        mask = os.urandom(4)
+        masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+        self.writer.write(bytes([0x80 | opcode, 0x80 | len(payload)]) + mask + masked)
+
+    async def read_frame(self):
+        head = await self.reader.readexactly(2)
+        opcode, length = head[0] & 0x0F, head[1] & 0x7F
+        if length == 126:
+            length = struct.unpack(">H", await self.reader.readexactly(2))[0]
+        elif length == 127:
+            length = struct.unpack(">Q", await self.reader.readexactly(8))[0]
+        return opcode, await self.reader.readexactly(length)
+
+    async def send_command(self, throttle, steering):
+        self.busy = True
+        try:
+            if self.writer is None:
+                await self.connect()
+                self.reconnects += 1
+            self.seq = (self.seq + 1) & 0xFFFFFFFF
+            start = time.monotonic()
+            client_ms = int(start * 1000) & 0xFFFFFFFF
+            self.send_frame(0x2, self.PACKET.pack(1, self.COMMAND, 0, 0, self.seq,
+                                                  throttle, steering, client_ms))
+            await self.writer.drain()
+            while True:
+                opcode, payload = await self.read_frame()
+                if opcode == 0x8:
+                    raise ConnectionError("канал закрыт роботом")
+                if opcode == 0x9:
+                    self.send_frame(0xA, payload)
+                    continue
+                if opcode != 0x2 or len(payload) != self.PACKET.size:
+                    continue
+                _, kind, _, _, seq, _, _, echoed_ms = self.PACKET.unpack(payload)
+                if kind == self.ACK and seq == self.seq and echoed_ms == client_ms:
+                    break
+            self.rtt_ms.append((time.monotonic() - start) * 1000.0)
+            self.sent += 1
+        except (OSError, ConnectionError, ValueError, asyncio.IncompleteReadError,
+                asyncio.TimeoutError) as e:
+            self.errors += 1
+            self.last_error = str(e) or type(e).__name__
+            self.disconnect()
+        finally:
+            self.busy = False
+
+
+class UdpMoveClient(MoveClient):
+    """Команды датаграммами на CONTROL_UDP_PORT с запросом ACK.
+
+    В отличие от TCP, команда уходит каждый такт, не дожидаясь ответа на
+    предыдущую: ACK, не пришедший за --move-timeout, считается потерей.
+    Робот подтверждает только свежие пакеты, отброшенные как устаревшие
+    тоже видны как потери.
+    """
+
+    class Protocol(asyncio.DatagramProtocol):
+        def __init__(self, client):
+            self.client = client
+
+        def datagram_received(self, data, addr):
+            self.client.on_ack(data)
+
+    def __init__(self, args):
+        super().__init__(args)
+        self.seq = 0
+        self.pending = {}       # seq -> время отправки
+        self.transport = None
+
+    def on_ack(self, data):
+        if len(data) != WsMoveClient.PACKET.size:
+            return
+        _, kind, _, _, seq, _, _, _ = WsMoveClient.PACKET.unpack(data)
+        start = self.pending.pop(seq, None)
+        if kind == WsMoveClient.ACK and start is not None:
+            self.rtt_ms.append((time.monotonic() - start) * 1000.0)
+
+    def send_packet(self, throttle, steering):
+        self.seq = (self.seq + 1) & 0xFFFFFFFF
+        now = time.monotonic()
+        self.pending[self.seq] = now
+        self.transport.sendto(WsMoveClient.PACKET.pack(
+            1, WsMoveClient.COMMAND, WsMoveClient.FLAG_ACK, 0, self.seq,
+            throttle, steering, int(now * 1000) & 0xFFFFFFFF))
+        self.sent += 1
+
+    def expire(self, now):
+        for seq, start in list(self.pending.items()):
+            if now - start > self.args.move_timeout:
+                del self.pending[seq]
+                self.errors += 1
+                self.last_error = "нет ACK"
+
+    async def run(self, deadline):
+        loop = asyncio.get_running_loop()
+        self.transport, _ = await loop.create_datagram_endpoint(
+            lambda: self.Protocol(self), remote_addr=(self.args.host, self.args.udp_port))
+        period = 1.0 / self.args.move_hz
+        next_tick = time.monotonic()
+        phase = random.uniform(0, 2 * math.pi)
+        try:
+            while time.monotonic() < deadline:
+                t = time.monotonic()
+                self.send_packet(PWM_NEUTRAL + int(self.args.move_amplitude * math.sin(t + phase)),
+                                 PWM_NEUTRAL + int(self.args.move_amplitude * math.cos(0.5 * t + phase)))
+                self.expire(t)
+                next_tick += period
+                await asyncio.sleep(max(0.0, next_tick - time.monotonic()))
+            # Остановить робота в конце теста и дождаться последних ACK
+            self.send_packet(PWM_NEUTRAL, PWM_NEUTRAL)
+            await asyncio.sleep(min(self.args.move_timeout, 0.5))
+            self.expire(time.monotonic() + self.args.move_timeout)
+        finally:
+            self.transport.close()
+
+
+# ═══════════════════════════════════════════════════════════════
+# ОТЧЕТ
+# ═══════════════════════════════════════════════════════════════
+
+def build_report(viewers, mover, elapsed):
+    all_intervals = [v for viewer in viewers for v in viewer.intervals_ms]
+    report = {
+        "durationSec": round(elapsed, 1),
+        "stream": {
+            "viewers": [{
+                "index": v.index,
+                "frames": v.frames,
+                "fps": round(v.frames / elapsed, 2) if elapsed > 0 else 0.0,
+                "kbps": round(v.bytes * 8 / 1000.0 / elapsed, 1) if elapsed > 0 else 0.0,
+                "reconnects": v.reconnects,
+                "errors": v.errors,
+                "lastError": v.last_error,
+                "interArrivalMs": summarize(v.intervals_ms),
+            } for v in viewers],
+            "interArrivalMs": summarize(all_intervals),
+        },
+    }
+    if mover is not None:
+        report["move"] = {
+            "channel": mover.args.control,
+            "sent": mover.sent,
+            "skipped": mover.skipped,
+            "errors": mover.errors,
+            "reconnects": mover.reconnects,
+            "lastError": mover.last_error,
+            "rttMs": summarize(mover.rtt_ms),
+        }
+    return report
+
+
+def print_report(report, title):
+    print("── %s (%.0f с) ──" % (title, report["durationSec"]))
+    for v in report["stream"]["viewers"]:
+        print(format_summary("зритель %d (%.1f fps)" % (v["index"], v["fps"]), v["interArrivalMs"])
+              + ("  ошибок: %d (%s)" % (v["errors"], v["lastError"]) if v["errors"] else ""))
+    print(format_summary("кадры, все зрители", report["stream"]["interArrivalMs"]))
+    move = report.get("move")
+    if move:
+        channel = {"http": "/move", "ws": "/ws/control", "udp": "UDP"}[move["channel"]]
+        print(format_summary("RTT " + channel, move["rttMs"])
+              + "  пропущено тактов: %d, ошибок: %d" % (move["skipped"], move["errors"]))
+    sys.stdout.flush()
+
+
+async def periodic_report(viewers, mover, start, interval):
+    while True:
+        await asyncio.sleep(interval)
+        print_report(build_report(viewers, mover, time.monotonic() - start), "промежуточно")
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Нагрузочный тест видео и управления MicroBox")
+    parser.add_argument("--host", default="192.168.4.1", help="Адрес робота или мока")
+    parser.add_argument("--http-port", type=int, default=80, help="Порт управления (/move)")
+    parser.add_argument("--stream-port", type=int, default=81, help="Порт видео (/stream)")
+    parser.add_argument("-k", "--viewers", type=int, default=2, help="Число соединений /stream")
+    parser.add_argument("--fps", type=int, default=0, help="Ограничение ?fps= для зрителей")
+    parser.add_argument("--control", choices=("http", "ws", "udp"), default="http",
+                        help="Канал команд: HTTP /move, бинарный /ws/control или UDP")
+    parser.add_argument("--udp-port", type=int, default=4210, help="Порт UDP управления")
+    parser.add_argument("--move-hz", type=float, default=20.0, help="Частота команд /move (0 - без команд)")
+    parser.add_argument("--move-amplitude", type=int, default=0,
+                        help="Амплитуда газа/руля в командах (0 - робот стоит на месте)")
+    parser.add_argument("--move-timeout", type=float, default=2.0, help="Таймаут ответа /move, с")
+    parser.add_argument("-d", "--duration", type=float, default=30.0, help="Длительность, с")
+    parser.add_argument("--report-interval", type=float, default=0.0,
+                        help="Промежуточный отчет каждые N секунд (для soak-теста)")
+    parser.add_argument("--json", help="Записать итоговый отчет в JSON файл")
+    args = parser.parse_args()
+
+    viewers = [StreamViewer(i, args) for i in range(args.viewers)]
+    mover = None
+    if args.move_hz > 0:
+        mover = {"http": MoveClient, "ws": WsMoveClient, "udp": UdpMoveClient}[args.control](args)
+
+    start = time.monotonic()
+    deadline = start + args.duration
+    tasks = [viewer.run(deadline) for viewer in viewers]
+    if mover is not None:
+        tasks.append(mover.run(deadline))
+
+    reporter = None
+    if args.report_interval > 0:
+        reporter = asyncio.ensure_future(periodic_report(viewers, mover, start, args.report_interval))
+    await asyncio.gather(*tasks)
+    if reporter is not None:
+        reporter.cancel()
+
+    report = build_report(viewers, mover, time.monotonic() - start)
+    print_report(report, "итог")
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=2, ensure_ascii=False)
+
+
+if __name__ == "__main__":
+    try:
+        asyncio.run(main())
+    except KeyboardInterrupt:
+        pass
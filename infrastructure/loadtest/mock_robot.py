@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+"""Мок робота для нагрузочного теста без железа.
+
+Повторяет HTTP интерфейс прошивки, который используют loadtest.py и
+stream_latency.py:
+  порт видео (81): /stream (multipart MJPEG, ?fps=N, X-Timestamp/X-Frame-Seq),
+                   /capture, /time
+  порт управления (80): /move?t=..&s=.., /ws/control (ControlPacket.h)
+  UDP управление (4210): ControlPacket с ACK
+
+Кадры берутся по кругу из каталога с JPEG (например, распакованного
+scripts/blackbox_extract.py). Без каталога отдаются синтетические кадры
+заданного размера - нагрузочному тесту содержимое JPEG не важно.
+"""
+
+import argparse
+import asyncio
+import base64
+import glob
+import hashlib
+import os
+import random
+import struct
+import time
+
+PART_BOUNDARY = b"123456789000000000000987654321"
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+CONTROL_PACKET = struct.Struct("<BBBBIHHI")    # include/ControlPacket.h
+
+
+def load_frames(directory, synthetic_size):
+    frames = []
+    if directory:
+        for path in sorted(glob.glob(os.path.join(directory, "*.jpg"))):
+            with open(path, "rb") as f:
+                frames.append(f.read())
+        if not frames:
+            raise SystemExit("В каталоге %s нет *.jpg" % directory)
+    else:
+        # SOI + шум + EOI: достаточно для проверки транспорта
+        for _ in range(8):
+            size = max(4, int(synthetic_size * random.uniform(0.8, 1.2)))
+            frames.append(b"\xff\xd8" + os.urandom(size - 4) + b"\xff\xd9")
+    return frames
+
+
+async def read_request(reader):
+    """Строка запроса и заголовки; None, если клиент закрыл соединение."""
+    line = await reader.readline()
+    if not line:
+        return None
+    method, target, _ = line.decode("latin-1").split(" ", 2)
+    headers = {}
+    while True:
+        line = await reader.readline()
+        if line in (b"\r\n", b"\n", b""):
+            break
+        key, _, value = line.decode("latin-1").partition(":")
+        headers[key.strip().lower()] = value.strip()
+    path, _, query = target.partition("?")
+    params = dict(p.partition("=")[::2] for p in query.split("&") if p)
+    return method, path, params, headers
+
+
+def response(status, body, content_type="text/plain", keep_alive=True):
+    head = ("HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %d\r\n"
+            "Connection: %s\r\n\r\n" % (status, content_type, len(body),
+                                        "keep-alive" if keep_alive else "close"))
+    return head.encode() + body
+
+
+class MockRobot:
+    def __init__(self, args):
+        self.args = args
+        self.frames = load_frames(args.frames, args.frame_size)
+        self.started = time.monotonic()
+        self.viewers = 0
+        self.moves = 0
+
+    def latest_frame(self):
+        """Последний кадр "сенсора": номер растет с частотой --fps, общий для всех зрителей."""
+        seq = int((time.monotonic() - self.started) * self.args.fps) + 1
+        return seq, self.frames[seq % len(self.frames)]
+
+    def now_us(self):
+        """Часы робота: мкс от старта (как esp_timer_get_time)."""
+        return int((time.monotonic() - self.started) * 1000000)
+
+    async def handle_camera(self, reader, writer):
+        try:
+            request = await read_request(reader)
+            if request is None:
+                return
+            _, path, params, _ = request
+            if path == "/stream":
+                await self.stream(writer, params)
+            elif path == "/time":
+                body = ('{"timeUs":%d}' % self.now_us()).encode()
+                writer.write(response("200 OK", body, "application/json", keep_alive=False))
+                await writer.drain()
+            elif path == "/capture":
+                writer.write(response("200 OK", self.latest_frame()[1], "image/jpeg", keep_alive=False))
+                await writer.drain()
+            else:
+                writer.write(response("404 Not Found", b"Not found", keep_alive=False))
+                await writer.drain()
+        except (ConnectionError, asyncio.IncompleteReadError):
+            pass
+        finally:
+            writer.close()
+
+    async def stream(self, writer, params):
+        if self.viewers >= self.args.max_viewers:
+            writer.write(response("503 Service Unavailable", b"Too many stream clients",
+                                  keep_alive=False))
+            await writer.drain()
+            return
+
+        fps = min(int(params.get("fps", 0) or 0) or self.args.fps, self.args.fps)
+        interval = 1.0 / fps
+        self.viewers += 1
+        try:
+            writer.write(b"HTTP/1.1 200 OK\r\nContent-Type: multipart/x-mixed-replace;boundary="
+                         + PART_BOUNDARY + b"\r\nConnection: close\r\n\r\n")
+            next_time = time.monotonic()
+            while True:
+                seq, frame = self.latest_frame()
+                # Кадр "снят" чуть раньше отправки, как у сенсора с очередью драйвера
+                captured_us = self.now_us() - self.args.capture_delay_ms * 1000
+                writer.write(b"\r\n--" + PART_BOUNDARY + b"\r\nContent-Type: image/jpeg\r\n"
+                             b"Content-Length: %d\r\nX-Timestamp: %d.%06d\r\nX-Frame-Seq: %d\r\n\r\n"
+                             % (len(frame), captured_us // 1000000, captured_us % 1000000, seq)
+                             + frame)
+                await writer.drain()
+                next_time += interval
+                await asyncio.sleep(max(0.0, next_time - time.monotonic()))
+        finally:
+            self.viewers -= 1
+
+    async def handle_control(self, reader, writer):
+        try:
+            while True:
+                request = await read_request(reader)
+                if request is None:
+                    break
+                _, path, params, headers = request
+                keep_alive = headers.get("connection", "").lower() != "close"
+                if path == "/ws/control" and "sec-websocket-key" in headers:
+                    await self.control_socket(reader, writer, headers["sec-websocket-key"])
+                    break
+                if path == "/move" and "t" in params and "s" in params:
+                    self.moves += 1
+                    if self.args.move_delay_ms:
+                        await asyncio.sleep(self.args.move_delay_ms / 1000.0)
+                    writer.write(response("200 OK", b"OK", keep_alive=keep_alive))
+                else:
+                    writer.write(response("404 Not Found", b"Not found", keep_alive=keep_alive))
+                await writer.drain()
+                if not keep_alive:
+                    break
+        except (ConnectionError, asyncio.IncompleteReadError):
+            pass
+        finally:
+            writer.close()
+
+
+    async def control_socket(self, reader, writer, key):
+        accept = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+        writer.write(("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+                      "Connection: Upgrade\r\nSec-WebSocket-Accept: %s\r\n\r\n" % accept).encode())
+        await writer.drain()
+        while True:
+            head = await reader.readexactly(2)
+            opcode, length = head[0] & 0x0F, head[1] & 0x7F
+            if length == 126:
+                length = struct.unpack(">H", await reader.readexactly(2))[0]
+            elif length == 127:
+                length = struct.unpack(">Q", await reader.readexactly(8))[0]
+            mask = await reader.readexactly(4) if head[1] & 0x80 else b"\0\0\0\0"
+            payload = bytes(b ^ mask[i % 4] for i, b in enumerate(await reader.readexactly(length)))
+            if opcode == 0x8:
+                return
+            if opcode != 0x2 or len(payload) != CONTROL_PACKET.size:
+                continue
+            ack = self.control_ack(payload)
+            if ack is None:
+                continue
+            if self.args.move_delay_ms:
+                await asyncio.sleep(self.args.move_delay_ms / 1000.0)
+            writer.write(bytes([0x82, len(ack)]) + ack)
+            await writer.drain()
+
+
+    def control_ack(self, payload):
+        """Команда ControlPacket -> ACK (None, если это не команда)."""
+        if len(payload) != CONTROL_PACKET.size:
+            return None
+        version, kind, flags, _, seq, throttle, steering, client_ms = CONTROL_PACKET.unpack(payload)
+        if version != 1 or kind != 1:
+            return None
+        self.moves += 1
+        return CONTROL_PACKET.pack(1, 2, flags, 0, seq, throttle, steering, client_ms)
+
+
+class UdpControl(asyncio.DatagramProtocol):
+    """UDP канал управления: ACK на пакеты с флагом запроса подтверждения."""
+
+    def __init__(self, robot):
+        self.robot = robot
+        self.transport = None
+
+    def connection_made(self, transport):
+        self.transport = transport
+
+    def datagram_received(self, data, addr):
+        ack = self.robot.control_ack(data)
+        if ack is None or not data[2] & 0x02:
+            return
+        if self.robot.args.move_delay_ms:
+            asyncio.get_running_loop().call_later(self.robot.args.move_delay_ms / 1000.0,
+                                                  self.transport.sendto, ack, addr)
+        else:
+            self.transport.sendto(ack, addr)
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Мок робота MicroBox для loadtest.py")
+    parser.add_argument("--bind", default="127.0.0.1")
+    parser.add_argument("--http-port", type=int, default=8080, help="Порт управления (на роботе 80)")
+    parser.add_argument("--stream-port", type=int, default=8081, help="Порт видео (на роботе 81)")
+    parser.add_argument("--udp-port", type=int, default=4210, help="Порт UDP управления")
+    parser.add_argument("--frames", help="Каталог с *.jpg для повтора")
+    parser.add_argument("--frame-size", type=int, default=10000, help="Размер синтетического кадра")
+    parser.add_argument("--fps", type=int, default=25, help="Частота кадров сенсора")
+    parser.add_argument("--max-viewers", type=int, default=3, help="Как STREAM_MAX_CLIENTS")
+    parser.add_argument("--capture-delay-ms", type=int, default=20,
+                        help="Возраст кадра в момент отправки (имитация очереди сенсора)")
+    parser.add_argument("--move-delay-ms", type=float, default=0.0, help="Задержка ответа /move")
+    args = parser.parse_args()
+
+    robot = MockRobot(args)
+    camera = await asyncio.start_server(robot.handle_camera, args.bind, args.stream_port)
+    control = await asyncio.start_server(robot.handle_control, args.bind, args.http_port)
+    await asyncio.get_running_loop().create_datagram_endpoint(
+        lambda: UdpControl(robot), local_addr=(args.bind, args.udp_port))
+    print("Мок робота: управление %s:%d, видео %s:%d, кадров в наборе: %d"
+          % (args.bind, args.http_port, args.bind, args.stream_port, len(robot.frames)))
+    async with camera, control:
+        await asyncio.gather(camera.serve_forever(), control.serve_forever())
+
+
+if __name__ == "__main__":
+    try:
+        asyncio.run(main())
+    except KeyboardInterrupt:
+        pass
@@ -0,0 +1,198 @@
+#!/usr/bin/env python3
+"""Задержка видео от захвата сенсором до получения клиентом.
+
+Каждая часть /stream несет X-Timestamp (время захвата по часам робота,
+esp_timer) и X-Frame-Seq. Часы робота и хоста сопоставляются через /time
+на порту видео: из нескольких запросов берется самый быстрый, смещение
+часов = timeUs - середина запроса. Синхронизация повторяется в фоне,
+чтобы учесть уход кварца.
+
+Результат - распределение задержки "сенсор -> получен последний байт
+JPEG" и пропуски кадров по X-Frame-Seq. Отрисовка в браузере добавляет
+еще время декодирования, здесь оно не входит.
+
+Только стандартная библиотека Python 3.8+, работает и с mock_robot.py.
+"""
+
+import argparse
+import asyncio
+import json
+import time
+
+from loadtest import format_summary, read_headers, summarize
+
+
+def host_us():
+    return int(time.monotonic() * 1000000)
+
+
+# ═══════════════════════════════════════════════════════════════
+# СИНХРОНИЗАЦИЯ ЧАСОВ
+# ═══════════════════════════════════════════════════════════════
+
+class ClockSync:
+    def __init__(self, args):
+        self.args = args
+        self.offset_us = None   # часы робота - часы хоста
+        self.rtt_us = None      # RTT лучшего запроса (погрешность +-rtt/2)
+        self.history = []       # (host_us, offset_us) для оценки ухода часов
+
+    async def probe(self):
+        reader, writer = await asyncio.open_connection(self.args.host, self.args.stream_port)
+        try:
+            request = ("GET /time HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n"
+                       % self.args.host).encode()
+            t0 = host_us()
+            writer.write(request)
+            await writer.drain()
+            status = (await reader.readline()).decode("latin-1")
+            headers = await read_headers(reader)
+            body = await reader.readexactly(int(headers.get("content-length", "0")))
+            t1 = host_us()
+            if " 200" not in status:
+                raise ConnectionError("ответ /time: %s" % status.strip())
+            robot_us = json.loads(body)["timeUs"]
+            return t1 - t0, robot_us - (t0 + t1) // 2
+        finally:
+            writer.close()
+
+    async def sync(self):
+        best = None
+        for _ in range(self.args.sync_probes):
+            try:
+                sample = await asyncio.wait_for(self.probe(), timeout=2.0)
+            except (OSError, ConnectionError, ValueError, KeyError,
+                    asyncio.TimeoutError, asyncio.IncompleteReadError):
+                continue
+            if best is None or sample[0] < best[0]:
+                best = sample
+        if best is None:
+            raise ConnectionError("нет ответа /time - прошивка без синхронизации часов?")
+        self.rtt_us, self.offset_us = best
+        self.history.append((host_us(), self.offset_us))
+
+    async def run(self, deadline):
+        while time.monotonic() + self.args.sync_interval < deadline:
+            await asyncio.sleep(self.args.sync_interval)
+            try:
+                await self.sync()
+            except ConnectionError:
+                pass
+
+    def drift_ppm(self):
+        if len(self.history) < 2:
+            return 0.0
+        (h0, o0), (h1, o1) = self.history[0], self.history[-1]
+        return (o1 - o0) * 1e6 / (h1 - h0) if h1 > h0 else 0.0
+
+
+# ═══════════════════════════════════════════════════════════════
+# ПРИЕМ КАДРОВ
+# ═══════════════════════════════════════════════════════════════
+
+def parse_timestamp(value):
+    """'сек.мкс' из X-Timestamp -> мкс."""
+    sec, _, usec = value.partition(".")
+    return int(sec) * 1000000 + int(usec.ljust(6, "0")[:6])
+
+
+async def receive_frames(args, clock, deadline, frames):
+    reader, writer = await asyncio.open_connection(args.host, args.stream_port)
+    try:
+        path = "/stream" + ("?fps=%d" % args.fps if args.fps else "")
+        writer.write(("GET %s HTTP/1.1\r\nHost: %s\r\n\r\n" % (path, args.host)).encode())
+        await writer.drain()
+        status = (await reader.readline()).decode("latin-1").strip()
+        headers = await read_headers(reader)
+        if " 200" not in status:
+            raise ConnectionError("ответ /stream: %s" % status)
+        boundary = b"--" + headers.get("content-type", "").split("boundary=", 1)[-1].strip().encode()
+
+        while time.monotonic() < deadline:
+            line = await reader.readline()
+            if not line:
+                raise ConnectionError("стрим закрыт сервером")
+            if not line.strip():
+                continue
+            if not line.startswith(boundary):
+                raise ValueError("ожидался разделитель части, получено %r" % line[:40])
+            part = await read_headers(reader)
+            await reader.readexactly(int(part.get("content-length", "0")))
+            received = host_us()
+
+            if "x-timestamp" not in part:
+                raise ValueError("нет X-Timestamp в части - старая прошивка?")
+            captured = parse_timestamp(part["x-timestamp"])
+            seq = int(part.get("x-frame-seq", "0"))
+            latency_ms = (received + clock.offset_us - captured) / 1000.0
+            frames.append((seq, captured, received, latency_ms))
+    finally:
+        writer.close()
+
+
+def build_report(frames, clock, elapsed):
+    latencies = [f[3] for f in frames]
+    gaps = 0
+    for prev, cur in zip(frames, frames[1:]):
+        if cur[0] > prev[0] + 1:
+            gaps += cur[0] - prev[0] - 1
+    return {
+        "durationSec": round(elapsed, 1),
+        "frames": len(frames),
+        "fps": round(len(frames) / elapsed, 2) if elapsed > 0 else 0.0,
+        "skippedSeq": gaps,     # Кадры сенсора, не доставленные этому зрителю
+        "clock": {
+            "syncRttMs": round(clock.rtt_us / 1000.0, 2),
+            "syncs": len(clock.history),
+            "driftPpm": round(clock.drift_ppm(), 1),
+        },
+        "captureToReceiveMs": summarize(latencies),
+    }
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Задержка видео MicroBox: захват сенсором -> клиент")
+    parser.add_argument("--host", default="192.168.4.1", help="Адрес робота или мока")
+    parser.add_argument("--stream-port", type=int, default=81, help="Порт видео (/stream, /time)")
+    parser.add_argument("--fps", type=int, default=0, help="Ограничение ?fps= для стрима")
+    parser.add_argument("-d", "--duration", type=float, default=30.0, help="Длительность, с")
+    parser.add_argument("--sync-probes", type=int, default=10, help="Запросов /time на синхронизацию")
+    parser.add_argument("--sync-interval", type=float, default=5.0, help="Повтор синхронизации, с")
+    parser.add_argument("--csv", help="Записать покадровые данные в CSV")
+    parser.add_argument("--json", help="Записать итоговый отчет в JSON файл")
+    args = parser.parse_args()
+
+    clock = ClockSync(args)
+    await clock.sync()
+    print("Часы: смещение %.3f с, RTT синхронизации %.2f мс"
+          % (clock.offset_us / 1e6, clock.rtt_us / 1000.0))
+
+    frames = []
+    start = time.monotonic()
+    deadline = start + args.duration
+    try:
+        await asyncio.wait_for(asyncio.gather(receive_frames(args, clock, deadline, frames),
+                                              clock.run(deadline)),
+                               timeout=args.duration + 5.0)
+    except asyncio.TimeoutError:
+        pass
+    report = build_report(frames, clock, time.monotonic() - start)
+
+    print(format_summary("сенсор -> клиент", report["captureToReceiveMs"]))
+    print("кадров: %d (%.1f fps), пропущено по seq: %d, уход часов: %.1f ppm"
+          % (report["frames"], report["fps"], report["skippedSeq"], report["clock"]["driftPpm"]))
+    if args.csv:
+        with open(args.csv, "w") as f:
+            f.write("seq,capture_us,receive_host_us,latency_ms\n")
+            for seq, captured, received, latency in frames:
+                f.write("%d,%d,%d,%.3f\n" % (seq, captured, received, latency))
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=2, ensure_ascii=False)
+
+
+if __name__ == "__main__":
+    try:
+        asyncio.run(main())
+    except KeyboardInterrupt:
+        pass
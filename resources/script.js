@@ -285,6 +285,66 @@ class CommandController {
         this.sendInterval = 250;
         this.isSending = false;
         this.fetchTimeout = 200;
+        
+        // Бинарный канал /ws/control (формат - include/ControlPacket.h),
+        // /move остается запасным путем, пока канал не подключен
+        this.CONTROL_PACKET_SIZE = 16;
+        this.socket = null;
+        this.socketSeq = 0;
+        this.socketRetryTime = 0;
+        this.socketRetryInterval = 1000;
+        this.rtt = { count: 0, lastMs: 0, avgMs: 0, maxMs: 0, jitterMs: 0 };
+    }
+    
+    connectSocket() {
+        if (!('WebSocket' in window)) return;
+        
+        const protocol = location.protocol === 'https:' ? 'wss' : 'ws';
+        const socket = new WebSocket(`${protocol}://${location.host}/ws/control`);
+        socket.binaryType = 'arraybuffer';
+        socket.onopen = () => Logger.info('Канал управления WebSocket подключен');
+        socket.onmessage = (event) => this.handleAck(event.data);
+        socket.onerror = () => socket.close();
+        socket.onclose = () => {
+            if (this.socket === socket) {
+                this.socket = null;
+                this.socketRetryTime = Date.now() + this.socketRetryInterval;
+            }
+        };
+        this.socket = socket;
+    }
+    
+    encodePacket(throttle, steering) {
+        const view = new DataView(new ArrayBuffer(this.CONTROL_PACKET_SIZE));
+        this.socketSeq = (this.socketSeq + 1) >>> 0;
+        view.setUint8(0, 1);                  // Версия
+        view.setUint8(1, 1);                  // Команда
+        view.setUint8(2, 0);                  // Флаги (по WebSocket ACK приходит всегда)
+        view.setUint32(4, this.socketSeq, true);
+        view.setUint16(8, throttle, true);
+        view.setUint16(10, steering, true);
+        view.setUint32(12, Math.floor(performance.now()) >>> 0, true);
+        return view.buffer;
+    }
+    
+    handleAck(data) {
+        if (!(data instanceof ArrayBuffer) || data.byteLength !== this.CONTROL_PACKET_SIZE) return;
+        const view = new DataView(data);
+        if (view.getUint8(0) !== 1 || view.getUint8(1) !== 2) return;
+        
+        // RTT по времени клиента, которое робот вернул без изменений
+        const rttMs = ((Math.floor(performance.now()) >>> 0) - view.getUint32(12, true)) >>> 0;
+        const rtt = this.rtt;
+        if (rtt.count > 0) {
+            rtt.jitterMs += (Math.abs(rttMs - rtt.lastMs) - rtt.jitterMs) / 16;
+        }
+        rtt.count++;
+        rtt.lastMs = rttMs;
+        rtt.avgMs += (rttMs - rtt.avgMs) / Math.min(rtt.count, 100);
+        rtt.maxMs = Math.max(rtt.maxMs, rttMs);
+        if (rtt.count % 200 === 0) {
+            Logger.debug(`RTT управления: avg=${rtt.avgMs.toFixed(1)}ms jitter=${rtt.jitterMs.toFixed(1)}ms max=${rtt.maxMs}ms`);
+        }
     }
     
     async loadConfig() {
@@ -312,6 +372,9 @@ class CommandController {
         if (this.isSending) return;
         
         const now = Date.now();
+        if (this.socket === null && now >= this.socketRetryTime) {
+            this.connectSocket();
+        }
         
         // Определяем команду остановки и предыдущее движение
         const isStopCommand = (this.targetThrottle === this.STOP_COMMAND_VALUE && 
@@ -337,6 +400,17 @@ class CommandController {
         
         if (!shouldSend) return;
         
+        if (this.socket && this.socket.readyState === WebSocket.OPEN) {
+            // Очередь не копим: пока предыдущий пакет не ушел, следующий бессмыслен
+            if (this.socket.bufferedAmount === 0) {
+                this.socket.send(this.encodePacket(this.targetThrottle, this.targetSteering));
+                this.lastSentThrottle = this.targetThrottle;
+                this.lastSentSteering = this.targetSteering;
+                this.lastSendTime = now;
+            }
+            return;
+        }
+        
         this.isSending = true;
         
         try {
@@ -1728,6 +1802,11 @@ class ClassicRobotUI extends BaseRobotUI {
             swapLeftRight: document.getElementById('motorSwapLeftRight')?.checked || false,
             invertLeft: document.getElementById('motorInvertLeft')?.checked || false,
             invertRight: document.getElementById('motorInvertRight')?.checked || false,
+            accelRate: parseInt(document.getElementById('motorAccelRate')?.value) || 0,
+            decelRate: parseInt(document.getElementById('motorDecelRate')?.value) || 0,
+            reverseRate: parseInt(document.getElementById('motorReverseRate')?.value) || 0,
+            brakeMode: document.getElementById('motorBrakeMode')?.value || 'coast',
+            brakeStrength: parseInt(document.getElementById('motorBrakeStrength')?.value) || 0,
             invertThrottle: document.getElementById('invertThrottleStick')?.checked || false,
             invertSteering: document.getElementById('invertSteeringStick')?.checked || false
         };
@@ -1863,6 +1942,16 @@ class ClassicRobotUI extends BaseRobotUI {
                     setChecked('motorSwapLeftRight', data.motors.swapLeftRight);
                     setChecked('motorInvertLeft', data.motors.invertLeft);
                     setChecked('motorInvertRight', data.motors.invertRight);
+                    
+                    const setValue = (id, value) => {
+                        const el = document.getElementById(id);
+                        if (el && value !== undefined) el.value = value;
+                    };
+                    setValue('motorAccelRate', data.motors.accelRate);
+                    setValue('motorDecelRate', data.motors.decelRate);
+                    setValue('motorReverseRate', data.motors.reverseRate);
+                    setValue('motorBrakeMode', data.motors.brakeMode);
+                    setValue('motorBrakeStrength', data.motors.brakeStrength);
                 }
                 
                 if (data.sticks) {
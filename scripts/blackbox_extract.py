@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Распаковка файла самописца (/api/blackbox/download).
+
+Кадры сохраняются как JPEG, команды и выходы моторов - в events.csv.
+Формат файла описан в include/BlackBoxRecorder.h.
+
+Пример:
+    curl -o box.mbbx http://192.168.4.1/api/blackbox/download
+    python3 scripts/blackbox_extract.py box.mbbx out/
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+FILE_HEADER = struct.Struct("<4sHHIIqq")
+RECORD_HEADER = struct.Struct("<BBHIq")
+
+RECORD_FRAME = 1
+RECORD_COMMAND = 2
+RECORD_MOTOR = 3
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Распаковка файла самописца MicroBox")
+    parser.add_argument("input", help="Файл .mbbx")
+    parser.add_argument("output", help="Каталог для кадров и events.csv")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+
+    magic, version, header_size, count, _, first_us, last_us = FILE_HEADER.unpack_from(data, 0)
+    if magic != b"MBBX" or version != 1:
+        sys.exit("Не файл самописца или неизвестная версия")
+
+    os.makedirs(args.output, exist_ok=True)
+    frames = 0
+    pos = header_size
+    with open(os.path.join(args.output, "events.csv"), "w") as events:
+        events.write("time_ms,type,a,b\n")
+        while pos + RECORD_HEADER.size <= len(data):
+            rtype, _, _, length, ts_us = RECORD_HEADER.unpack_from(data, pos)
+            payload = data[pos + RECORD_HEADER.size:pos + RECORD_HEADER.size + length]
+            pos += RECORD_HEADER.size + ((length + 3) & ~3)
+            time_ms = (ts_us - first_us) / 1000.0
+
+            if rtype == RECORD_FRAME:
+                width, height = struct.unpack_from("<HH", payload, 0)
+                name = "frame_%05d_%09.1fms.jpg" % (frames, time_ms)
+                with open(os.path.join(args.output, name), "wb") as jpg:
+                    jpg.write(payload[4:])
+                events.write("%.1f,frame,%d,%d\n" % (time_ms, width, height))
+                frames += 1
+            elif rtype in (RECORD_COMMAND, RECORD_MOTOR):
+                a, b = struct.unpack_from("<hh", payload, 0)
+                kind = "command" if rtype == RECORD_COMMAND else "motor"
+                events.write("%.1f,%s,%d,%d\n" % (time_ms, kind, a, b))
+
+    print("Записей: %d, кадров: %d, длительность: %.1f с"
+          % (count, frames, (last_us - first_us) / 1e6))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""Расшифровка бинарного журнала FAST_LOG (FAST_LOG_BINARY_OUTPUT).
+
+Прошивка пишет в UART кадры записей вперемешку с обычным текстом
+(DEBUG_PRINTLN, Serial.println). Кадр описан в src/FastLog.cpp:
+    0xFF 0xA5, число аргументов (1 байт), адрес формата (u32),
+    время в мкс (u32), аргументы (u32 каждый) - little-endian.
+Строки формата и аргументы %s - адреса во flash; текст берется из
+firmware.elf той же сборки. Обычный текст выводится как есть.
+
+Примеры:
+    pio device monitor -b 115200 --raw > uart.bin
+    python3 scripts/fastlog_decode.py .pio/build/classic-debug/firmware.elf uart.bin
+
+    # Напрямую с порта (нужен pyserial)
+    python3 scripts/fastlog_decode.py firmware.elf --port /dev/ttyUSB0
+"""
+
+import argparse
+import codecs
+import re
+import struct
+import sys
+
+FRAME_SYNC = b"\xff\xa5"
+FRAME_HEADER = struct.Struct("<BII")    # число аргументов, формат, время
+MAX_ARGS = 6                            # FAST_LOG_MAX_ARGS
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+# %[флаги][ширина][.точность][длина]преобразование
+SPEC_RE = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diuxXocsfFeEgGp%])")
+
+
+class ElfStrings:
+    """Строки по адресу из загружаемых секций ELF32 (только stdlib)."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            sys.exit("%s: не ELF32" % path)
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            _, stype, flags, addr, offset, size = struct.unpack_from(
+                "<IIIIII", self.data, shoff + i * shentsize)
+            if flags & SHF_ALLOC and stype != SHT_NOBITS and size:
+                self.sections.append((addr, size, offset))
+        self.cache = {}
+
+    def string(self, addr):
+        if addr in self.cache:
+            return self.cache[addr]
+        text = None
+        for start, size, offset in self.sections:
+            if start <= addr < start + size:
+                pos = offset + addr - start
+                end = self.data.find(b"\0", pos, offset + size)
+                if end >= 0:
+                    text = self.data[pos:end].decode("utf-8", errors="replace")
+                break
+        self.cache[addr] = text
+        return text
+
+
+def format_record(elf, fmt, args):
+    """Текст записи по правилам FastLog::format."""
+    words = iter(args)
+
+    def convert(match):
+        flags, conv = match.group(1), match.group(2)
+        if conv == "%":
+            return "%"
+        word = next(words, 0)
+        if conv in "di":
+            return ("%" + flags + "d") % struct.unpack("<i", struct.pack("<I", word))[0]
+        if conv in "fFeEgG":
+            return ("%" + flags + conv) % struct.unpack("<f", struct.pack("<I", word))[0]
+        if conv == "s":
+            text = elf.string(word) if word else "(null)"
+            return ("%" + flags + "s") % (text if text is not None else "<0x%08x>" % word)
+        if conv == "p":
+            return "0x%08x" % word
+        if conv == "c":
+            return chr(word & 0xFF)
+        if conv == "u":
+            return ("%" + flags + "d") % word
+        return ("%" + flags + conv) % word
+
+    return SPEC_RE.sub(convert, fmt).rstrip("\r\n")
+
+
+def decode(elf, stream, out):
+    buf = b""
+    # Текст между кадрами может разрываться посреди символа UTF-8
+    text = codecs.getincrementaldecoder("utf-8")(errors="replace")
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            break
+        buf += chunk
+        while True:
+            sync = buf.find(FRAME_SYNC)
+            if sync < 0:
+                # Хвост может оказаться началом кадра
+                keep = 1 if buf.endswith(FRAME_SYNC[:1]) else 0
+                out.write(text.decode(buf[:len(buf) - keep]))
+                buf = buf[len(buf) - keep:]
+                break
+            out.write(text.decode(buf[:sync]))
+            buf = buf[sync:]
+            if len(buf) < 2 + FRAME_HEADER.size:
+                break
+            count, fmt_addr, ts_us = FRAME_HEADER.unpack_from(buf, 2)
+            fmt = elf.string(fmt_addr) if count <= MAX_ARGS else None
+            if fmt is None:
+                # Не кадр: пропускаем байт синхронизации
+                out.write(text.decode(buf[:1]))
+                buf = buf[1:]
+                continue
+            size = 2 + FRAME_HEADER.size + count * 4
+            if len(buf) < size:
+                break
+            args = struct.unpack_from("<%dI" % count, buf, 2 + FRAME_HEADER.size)
+            out.write("[%u.%03u] %s\n" % (ts_us // 1000000, ts_us // 1000 % 1000,
+                                          format_record(elf, fmt, args)))
+            buf = buf[size:]
+        out.flush()
+    out.write(text.decode(buf, final=True))
+
+
+class SerialStream:
+    """Порт как поток: read() ждет данные, а не возвращает пустой ответ по таймауту."""
+
+    def __init__(self, port, baud):
+        import serial  # pylint: disable=import-outside-toplevel
+        self.port = serial.Serial(port, baud, timeout=0.1)
+
+    def read(self, size):
+        while True:
+            data = self.port.read(size)
+            if data:
+                return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Расшифровка журнала FAST_LOG MicroBox")
+    parser.add_argument("elf", help="firmware.elf той же сборки")
+    parser.add_argument("input", nargs="?", default="-", help="Запись UART (по умолчанию stdin)")
+    parser.add_argument("--port", help="Читать с последовательного порта (pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    elf = ElfStrings(args.elf)
+    if args.port:
+        stream = SerialStream(args.port, args.baud)
+    elif args.input == "-":
+        stream = sys.stdin.buffer
+    else:
+        stream = open(args.input, "rb")
+
+    try:
+        decode(elf, stream, sys.stdout)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -1,6 +1,12 @@
 #include "BaseRobot.h"
 #include "hardware_config.h"
 #include "CameraServer.h"
+#include "FrameBroker.h"
+#include "BlackBoxRecorder.h"
+#include "ControlPacket.h"
+#include "UdpControlServer.h"
+#include "FastLog.h"
+#include "CommandTrace.h"
 #include <ESPmDNS.h>
 #include <esp_camera.h>
 
@@ -8,15 +14,32 @@
 #include "embedded_resources.h"
 #endif
 
+// Часы планировщика цикла
+static uint32_t schedulerClockUs() {
+    return micros();
+}
+
+// trigger() планировщика будит задачу цикла
+static void schedulerWake(void* task) {
+    xTaskNotifyGive(static_cast<TaskHandle_t>(task));
+}
+
 BaseRobot::BaseRobot() :
     initialized_(false),
     cameraInitialized_(false),
     wifiConnected_(false),
     wifiAPMode_(true),
     server_(nullptr),
+    controlSocket_(nullptr),
+    controlClients_(0),
     wifiSettings_(nullptr),
     firmwareUpdate_(nullptr),
-    motorController_(nullptr)
+    motorController_(nullptr),
+    blackBox_(nullptr),
+    udpControl_(nullptr),
+    scheduler_(schedulerClockUs),
+    commandTaskId_(-1),
+    cameraProfile_(nullptr)
 {
     // Генерация имени устройства на основе MAC адреса
     uint8_t mac[6];
@@ -37,6 +60,11 @@ bool BaseRobot::init() {
     
     DEBUG_PRINTLN("=== Инициализация BaseRobot ===");
     
+    // init() и loop() выполняются в одной задаче (loopTask): ее будят почтовый
+    // ящик команд и события планировщика
+    commandMailbox_.attachWaiter(xTaskGetCurrentTaskHandle());
+    scheduler_.attachWaker(schedulerWake, xTaskGetCurrentTaskHandle());
+    
     // Инициализация WiFi настроек
     wifiSettings_ = new WiFiSettings();
     if (!wifiSettings_->init()) {
@@ -59,6 +87,18 @@ bool BaseRobot::init() {
         DEBUG_PRINTLN("ПРЕДУПРЕЖДЕНИЕ: Не удалось инициализировать mDNS");
     }
     
+    // Самописец создается до камеры и моторов: они получают указатель на него
+#ifdef FEATURE_BLACKBOX
+    blackBox_ = new BlackBoxRecorder();
+    if (blackBox_->init()) {
+#ifdef FEATURE_CAMERA
+        FrameBroker::instance().setBlackBox(blackBox_);
+#endif
+    } else {
+        DEBUG_PRINTLN("ПРЕДУПРЕЖДЕНИЕ: Самописец не запущен");
+    }
+#endif
+
     // Инициализация камеры (если включена)
 #ifdef FEATURE_CAMERA
     if (!initCamera()) {
@@ -79,6 +119,25 @@ bool BaseRobot::init() {
         return false;
     }
     
+    // UDP канал управления - после моторов, команды идут тем же путем, что и /move
+#ifdef FEATURE_UDP_CONTROL
+    udpControl_ = new UdpControlServer();
+    if (!udpControl_->begin(CONTROL_UDP_PORT, [this](int throttlePWM, int steeringPWM) {
+            applyControlCommand(throttlePWM, steeringPWM, CommandTrace::now());
+        })) {
+        DEBUG_PRINTLN("ПРЕДУПРЕЖДЕНИЕ: UDP канал управления не запущен");
+    }
+#endif
+    
+    // Расписание цикла: общие задачи, затем задачи наследника
+    // (закрытые клиенты AsyncWebSocket освобождаются только явной очисткой)
+    scheduler_.add("ws-cleanup", CONTROL_WS_CLEANUP_MS * 1000UL, 0, [this]() {
+        if (controlSocket_) {
+            controlSocket_->cleanupClients(CONTROL_WS_MAX_CLIENTS);
+        }
+    });
+    scheduleSpecificComponents(scheduler_);
+    
     initialized_ = true;
     DEBUG_PRINTLN("=== BaseRobot успешно инициализирован ===");
     return true;
@@ -89,12 +148,20 @@ void BaseRobot::update() {
         return;
     }
     
-    // Обновление специфичных компонентов
-    updateSpecificComponents();
+    // Задачи, срок которых наступил (у каждой свой период)
+    scheduler_.runDue(0);
 }
 
 void BaseRobot::shutdown() {
     if (initialized_) {
+#ifdef FEATURE_UDP_CONTROL
+        if (udpControl_) {
+            udpControl_->end();
+            delete udpControl_;
+            udpControl_ = nullptr;
+        }
+#endif
+        
         shutdownSpecificComponents();
         
         if (motorController_) {
@@ -103,14 +170,25 @@ void BaseRobot::shutdown() {
         
         if (server_) {
             server_->end();
-            delete server_;
+            delete server_;     // Удаляет и зарегистрированные обработчики (controlSocket_)
             server_ = nullptr;
+            controlSocket_ = nullptr;
         }
         
         if (firmwareUpdate_) {
             delete firmwareUpdate_;
             firmwareUpdate_ = nullptr;
         }
+
+#ifdef FEATURE_BLACKBOX
+        if (blackBox_) {
+#ifdef FEATURE_CAMERA
+            FrameBroker::instance().setBlackBox(nullptr);
+#endif
+            delete blackBox_;
+            blackBox_ = nullptr;
+        }
+#endif
         
         if (wifiSettings_) {
             delete wifiSettings_;
@@ -124,8 +202,17 @@ void BaseRobot::shutdown() {
 }
 
 void BaseRobot::loop() {
-    update();
-    delay(10); // Небольшая задержка для стабильности
+    if (!initialized_) {
+        delay(SCHEDULER_MAX_SLEEP_MS);
+        return;
+    }
+    
+    // Задачи по расписанию, затем сон до ближайшего срока. Новая команда
+    // движения или событие планировщика (кадр Лайнера) будят цикл раньше
+    uint32_t sleepUs = scheduler_.runDue(SCHEDULER_MAX_SLEEP_MS * 1000UL);
+    if (sleepUs > 0) {
+        commandMailbox_.wait(pdMS_TO_TICKS((sleepUs + 999) / 1000));
+    }
 }
 
 IPAddress BaseRobot::getIP() const {
@@ -157,6 +244,35 @@ bool BaseRobot::initWiFi() {
     return true;
 }
 
+// Числовое поле "key":N из тела /api/settings/save (без JSON парсера, как остальные поля)
+static bool parseSettingsInt(const String& body, const char* key, int& value) {
+    String pattern = String("\"") + key + "\":";
+    int start = body.indexOf(pattern);
+    if (start < 0) {
+        return false;
+    }
+    start += pattern.length();
+    int end = body.indexOf(",", start);
+    if (end == -1) end = body.indexOf("}", start);
+    if (end <= start) {
+        return false;
+    }
+    value = body.substring(start, end).toInt();
+    return true;
+}
+
+// Режим торможения в JSON настроек
+static const char* brakeModeName(MotorBrakeMode mode) {
+    switch (mode) {
+        case MotorBrakeMode::BRAKE:
+            return "brake";
+        case MotorBrakeMode::PROPORTIONAL:
+            return "proportional";
+        default:
+            return "coast";
+    }
+}
+
 bool BaseRobot::initWebServer() {
     DEBUG_PRINTLN("Инициализация веб-сервера...");
     
@@ -232,7 +348,12 @@ bool BaseRobot::initWebServer() {
         json += "\"motors\":{";
         json += "\"swapLeftRight\":" + String(wifiSettings_->getMotorSwapLeftRight() ? "true" : "false") + ",";
         json += "\"invertLeft\":" + String(wifiSettings_->getMotorInvertLeft() ? "true" : "false") + ",";
-        json += "\"invertRight\":" + String(wifiSettings_->getMotorInvertRight() ? "true" : "false");
+        json += "\"invertRight\":" + String(wifiSettings_->getMotorInvertRight() ? "true" : "false") + ",";
+        json += "\"accelRate\":" + String(wifiSettings_->getMotorAccelRate()) + ",";
+        json += "\"decelRate\":" + String(wifiSettings_->getMotorDecelRate()) + ",";
+        json += "\"reverseRate\":" + String(wifiSettings_->getMotorReverseRate()) + ",";
+        json += "\"brakeMode\":\"" + String(brakeModeName(wifiSettings_->getMotorBrakeMode())) + "\",";
+        json += "\"brakeStrength\":" + String(wifiSettings_->getMotorBrakeStrength());
         json += "},";
         
         // Настройки стиков
@@ -332,6 +453,37 @@ bool BaseRobot::initWebServer() {
                     wifiSettings_->setMotorInvertRight(false);
                 }
                 
+                // Плавность моторов, %/с (0 - без ограничения)
+#ifdef FEATURE_MOTORS
+                int rate;
+                if (parseSettingsInt(settingsBody, "accelRate", rate)) {
+                    wifiSettings_->setMotorAccelRate(constrain(rate, 0, MOTOR_SLEW_RATE_MAX));
+                }
+                if (parseSettingsInt(settingsBody, "decelRate", rate)) {
+                    wifiSettings_->setMotorDecelRate(constrain(rate, 0, MOTOR_SLEW_RATE_MAX));
+                }
+                if (parseSettingsInt(settingsBody, "reverseRate", rate)) {
+                    wifiSettings_->setMotorReverseRate(constrain(rate, 0, MOTOR_SLEW_RATE_MAX));
+                }
+                
+                // Торможение: режим и сила тормоза на остановке, %
+                if (settingsBody.indexOf("\"brakeMode\":\"coast\"") >= 0) {
+                    wifiSettings_->setMotorBrakeMode(MotorBrakeMode::COAST);
+                } else if (settingsBody.indexOf("\"brakeMode\":\"brake\"") >= 0) {
+                    wifiSettings_->setMotorBrakeMode(MotorBrakeMode::BRAKE);
+                } else if (settingsBody.indexOf("\"brakeMode\":\"proportional\"") >= 0) {
+                    wifiSettings_->setMotorBrakeMode(MotorBrakeMode::PROPORTIONAL);
+                }
+                if (parseSettingsInt(settingsBody, "brakeStrength", rate)) {
+                    wifiSettings_->setMotorBrakeStrength(constrain(rate, 0, 100));
+                }
+#endif
+                
+                // Swap/invert, плавность и торможение применяются контроллером один раз здесь
+                if (motorController_) {
+                    motorController_->onSettingsChanged();
+                }
+                
                 // Настройки стиков (применяются сразу)
                 if (settingsBody.indexOf("\"invertThrottle\":true") >= 0) {
                     wifiSettings_->setInvertThrottleStick(true);
@@ -399,10 +551,8 @@ bool BaseRobot::initWebServer() {
     // API endpoint: Применение настроек камеры (без перезагрузки)
     server_->on("/api/camera/apply", HTTP_POST, [this](AsyncWebServerRequest* request) {
 #ifdef FEATURE_CAMERA
-        sensor_t* s = esp_camera_sensor_get();
-        if (s != nullptr && wifiSettings_ != nullptr) {
-            s->set_hmirror(s, wifiSettings_->getCameraHMirror() ? 1 : 0);
-            s->set_vflip(s, wifiSettings_->getCameraVFlip() ? 1 : 0);
+        // Профиль не меняется, записываются только изменившиеся зеркало/переворот
+        if (cameraProfile_ != nullptr && applyCameraProfile(*cameraProfile_) >= 0) {
             request->send(200, "application/json", "{\"status\":\"ok\",\"message\":\"Настройки камеры применены\"}");
         } else {
             request->send(500, "application/json", "{\"status\":\"error\",\"message\":\"Камера не инициализирована\"}");
@@ -411,21 +561,248 @@ bool BaseRobot::initWebServer() {
         request->send(500, "application/json", "{\"status\":\"error\",\"message\":\"Камера отключена\"}");
 #endif
     });
-    
+
+    // API endpoint: Профиль настроек сенсора камеры
+    // Параметры: name=<профиль> - переключить (можно на ходу), save=1 - запомнить в настройках
+    server_->on("/api/camera/profile", HTTP_GET, [this](AsyncWebServerRequest* request) {
+#ifdef FEATURE_CAMERA
+        if (!cameraInitialized_) {
+            request->send(500, "application/json", "{\"status\":\"error\",\"message\":\"Камера не инициализирована\"}");
+            return;
+        }
+        
+        int writes = 0;
+        if (request->hasParam("name")) {
+            String name = request->getParam("name")->value();
+            const CameraProfile* profile = findCameraProfile(name.c_str());
+            if (profile == nullptr) {
+                request->send(400, "application/json", "{\"status\":\"error\",\"message\":\"Неизвестный профиль\"}");
+                return;
+            }
+            writes = applyCameraProfile(*profile);
+            if (request->hasParam("save") && request->getParam("save")->value().toInt() != 0) {
+                wifiSettings_->setCameraProfileName(name);
+                wifiSettings_->save();
+            }
+        }
+        
+        String json = "{";
+        json += "\"profile\":\"" + String(cameraProfile_ ? cameraProfile_->name : "") + "\",";
+        json += "\"writes\":" + String(writes) + ",";
+        json += "\"profiles\":[";
+        for (int i = 0; i < getCameraProfileCount(); i++) {
+            if (i > 0) json += ",";
+            json += "\"" + String(getCameraProfile(i).name) + "\"";
+        }
+        json += "],\"applied\":{";
+        for (int i = 0; i < CAM_PARAM_COUNT; i++) {
+            if (i > 0) json += ",";
+            json += "\"" + String(getCameraParamName((CameraParam)i)) + "\":" + String(cameraState_.get((CameraParam)i));
+        }
+        json += "}}";
+        request->send(200, "application/json", json);
+#else
+        request->send(500, "application/json", "{\"status\":\"error\",\"message\":\"Камера отключена\"}");
+#endif
+    });
+
+    // API endpoint: Окно сенсора (ROI) - захват только выбранной полосы кадра
+    // Параметры: x, y, w, h - окно в координатах SVGA (800x600, весь угол обзора),
+    // off=1 - вернуть полный кадр. Без параметров - текущее окно
+    server_->on("/api/camera/roi", HTTP_GET, [](AsyncWebServerRequest* request) {
+#ifdef FEATURE_CAMERA
+        FrameBroker& broker = FrameBroker::instance();
+        if (request->hasParam("off") && request->getParam("off")->value().toInt() != 0) {
+            broker.clearRoi();
+        } else if (request->hasParam("w") && request->hasParam("h")) {
+            int x = request->hasParam("x") ? request->getParam("x")->value().toInt() : 0;
+            int y = request->hasParam("y") ? request->getParam("y")->value().toInt() : 0;
+            int w = request->getParam("w")->value().toInt();
+            int h = request->getParam("h")->value().toInt();
+            if (x < 0 || y < 0 || w <= 0 || h <= 0) {
+                request->send(400, "application/json", "{\"status\":\"error\",\"message\":\"Неверное окно\"}");
+                return;
+            }
+            if (!broker.setRoi(x, y, w, h)) {
+                request->send(409, "application/json", "{\"status\":\"error\",\"message\":\"Окно сенсора не поддерживается\"}");
+                return;
+            }
+        }
+
+        // Окно выравнивается брокером: отвечаем фактическими значениями
+        const FrameRoi roi = broker.getRoi();
+        String json = "{";
+        json += "\"active\":" + String(roi.active ? "true" : "false") + ",";
+        json += "\"x\":" + String(roi.active ? roi.x : 0) + ",";
+        json += "\"y\":" + String(roi.active ? roi.y : 0) + ",";
+        json += "\"width\":" + String(roi.active ? roi.width : CAMERA_ROI_SENSOR_WIDTH) + ",";
+        json += "\"height\":" + String(roi.active ? roi.height : CAMERA_ROI_SENSOR_HEIGHT) + ",";
+        json += "\"outWidth\":" + String(roi.active ? roi.outWidth : 0) + ",";
+        json += "\"outHeight\":" + String(roi.active ? roi.outHeight : 0) + ",";
+        json += "\"sensorWidth\":" + String(CAMERA_ROI_SENSOR_WIDTH) + ",";
+        json += "\"sensorHeight\":" + String(CAMERA_ROI_SENSOR_HEIGHT);
+        json += "}";
+        request->send(200, "application/json", json);
+#else
+        request->send(500, "application/json", "{\"status\":\"error\",\"message\":\"Камера отключена\"}");
+#endif
+    });
+
+    // API endpoint: Статистика зрителей стрима
+    server_->on("/api/stream/stats", HTTP_GET, [](AsyncWebServerRequest* request) {
+#ifdef FEATURE_CAMERA
+        request->send(200, "application/json", getCameraStreamStatsJson());
+#else
+        request->send(500, "application/json", "{\"status\":\"error\",\"message\":\"Камера отключена\"}");
+#endif
+    });
+
+    // API endpoint: Адаптивное качество стрима (текущая ступень и цель)
+    // Параметры: adaptive=0|1 - вкл/выкл регулятор, target=<мс> - целевая задержка кадра
+    // ВАЖНО: регистрируется после остальных /api/camera/* - AsyncWebServer
+    // сопоставляет этот путь и со всеми вложенными путями
+    server_->on("/api/camera", HTTP_GET, [this](AsyncWebServerRequest* request) {
+#ifdef FEATURE_CAMERA
+        FrameBroker& broker = FrameBroker::instance();
+        if (request->hasParam("adaptive")) {
+            if (!broker.setAdaptiveQuality(request->getParam("adaptive")->value().toInt() != 0)) {
+                request->send(409, "application/json", "{\"status\":\"error\",\"message\":\"Адаптивное качество только для JPEG сенсора\"}");
+                return;
+            }
+        }
+        if (request->hasParam("target")) {
+            int targetMs = request->getParam("target")->value().toInt();
+            if (targetMs > 0) {
+                broker.setTargetLatencyMs(targetMs);
+            }
+        }
+
+        StreamQualityController quality = broker.getQualitySnapshot();
+        const StreamQualityController::OperatingPoint& point = quality.getOperatingPoint();
+
+        String json = "{";
+        json += "\"adaptive\":" + String(quality.isEnabled() ? "true" : "false") + ",";
+        json += "\"targetLatencyMs\":" + String(quality.getTargetLatencyMs()) + ",";
+        json += "\"level\":" + String(quality.getLevel()) + ",";
+        json += "\"levels\":" + String(StreamQualityController::getLevelCount()) + ",";
+        json += "\"width\":" + String(point.width) + ",";
+        json += "\"height\":" + String(point.height) + ",";
+        json += "\"quality\":" + String(point.quality) + ",";
+        json += "\"avgSendMs\":" + String(quality.getAvgSendUs() / 1000.0f, 1) + ",";
+        json += "\"avgFrameBytes\":" + String(quality.getAvgFrameBytes()) + ",";
+        json += "\"fps\":" + String(quality.getFps(), 1);
+        json += "}";
+        request->send(200, "application/json", json);
+#else
+        request->send(500, "application/json", "{\"status\":\"error\",\"message\":\"Камера отключена\"}");
+#endif
+    });
+
+    // API endpoint: Выгрузка самописца одним файлом (формат - BlackBoxRecorder.h)
+    // ВАЖНО: регистрируется до /api/blackbox (сопоставление по префиксу)
+    server_->on("/api/blackbox/download", HTTP_GET, [this](AsyncWebServerRequest* request) {
+#ifdef FEATURE_BLACKBOX
+        if (!blackBox_ || !blackBox_->beginDownload()) {
+            request->send(409, "application/json", "{\"status\":\"error\",\"message\":\"Самописец недоступен или уже выгружается\"}");
+            return;
+        }
+        // Кольцо заморожено до отключения клиента: размер файла известен заранее,
+        // данные отдаются частями прямо из PSRAM без промежуточной копии
+        BlackBoxRecorder* blackBox = blackBox_;
+        AsyncWebServerResponse* response = request->beginResponse("application/octet-stream",
+            blackBox->getDownloadSize(),
+            [blackBox](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                return blackBox->readDownload(buffer, maxLen, index);
+            });
+        response->addHeader("Content-Disposition", "attachment; filename=blackbox.mbbx");
+        request->onDisconnect([blackBox]() {
+            blackBox->endDownload();
+        });
+        request->send(response);
+#else
+        request->send(500, "application/json", "{\"status\":\"error\",\"message\":\"Самописец отключен\"}");
+#endif
+    });
+
+    // API endpoint: Состояние самописца
+    server_->on("/api/blackbox", HTTP_GET, [this](AsyncWebServerRequest* request) {
+#ifdef FEATURE_BLACKBOX
+        if (blackBox_) {
+            request->send(200, "application/json", blackBox_->getStatusJson());
+            return;
+        }
+#endif
+        request->send(500, "application/json", "{\"status\":\"error\",\"message\":\"Самописец отключен\"}");
+    });
+
+    // API endpoint: Расписание цикла - опоздания старта (джиттер), время выполнения,
+    // превышения deadline и пропущенные периоды по задачам. ?reset=1 - сброс
+    server_->on("/api/scheduler/stats", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        String json = "{\"tasks\":[";
+        ComponentScheduler::TaskStats stats;
+        for (int i = 0; scheduler_.getStats(i, stats); i++) {
+            if (i > 0) {
+                json += ",";
+            }
+            json += "{\"name\":\"" + String(stats.name) + "\",";
+            json += "\"periodUs\":" + String(stats.periodUs) + ",";
+            json += "\"deadlineUs\":" + String(stats.deadlineUs) + ",";
+            json += "\"runs\":" + String(stats.runs) + ",";
+            json += "\"overruns\":" + String(stats.overruns) + ",";
+            json += "\"skipped\":" + String(stats.skipped) + ",";
+            json += "\"avgRunUs\":" + String(stats.runs ? (uint32_t)(stats.totalRunUs / stats.runs) : 0) + ",";
+            json += "\"maxRunUs\":" + String(stats.maxRunUs) + ",";
+            json += "\"latenessAvgUs\":" + String(stats.lateness.getAvgUs()) + ",";
+            json += "\"latenessP99Us\":" + String(stats.lateness.percentileUs(99)) + ",";
+            json += "\"latenessMaxUs\":" + String(stats.lateness.getMaxUs()) + "}";
+        }
+        json += "]}";
+        if (request->hasParam("reset") && request->getParam("reset")->value() == "1") {
+            scheduler_.resetStats();
+        }
+        request->send(200, "application/json", json);
+    });
+
+    // API endpoint: Задержки команды движения по этапам (приход -> ledcWrite). ?reset=1 - сброс
+    server_->on("/api/trace/commands", HTTP_GET, [](AsyncWebServerRequest* request) {
+        String json = CommandTrace::getStatsJson();
+        if (request->hasParam("reset") && request->getParam("reset")->value() == "1") {
+            CommandTrace::reset();
+        }
+        request->send(200, "application/json", json);
+    });
+
+    // API endpoint: Watchdog моторов - срабатывания и задержка остановки после таймаута
+    server_->on("/api/motors/failsafe", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        if (motorController_) {
+            request->send(200, "application/json", motorController_->getFailsafeStatsJson());
+            return;
+        }
+        request->send(500, "application/json", "{\"status\":\"error\",\"message\":\"Моторы отключены\"}");
+    });
+
+    // API endpoint: UDP канал управления - счетчики потерь/перестановок по источникам
+    server_->on("/api/control/udp", HTTP_GET, [this](AsyncWebServerRequest* request) {
+#ifdef FEATURE_UDP_CONTROL
+        if (udpControl_) {
+            request->send(200, "application/json", udpControl_->getStatsJson());
+            return;
+        }
+#endif
+        request->send(500, "application/json", "{\"status\":\"error\",\"message\":\"UDP управление отключено\"}");
+    });
+
     // Move command - motor control
     server_->on("/move", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        const uint32_t arrivalUs = CommandTrace::now();
         if (request->hasParam("t") && request->hasParam("s")) {
             int throttle = request->getParam("t")->value().toInt();
             int steering = request->getParam("s")->value().toInt();
             
-            // Debug logging
-            Serial.print("CMD: t=");
-            Serial.print(throttle);
-            Serial.print(" s=");
-            Serial.println(steering);
+            // Журнал без ожидания UART (20 команд в секунду)
+            FAST_LOG("CMD: t=%d s=%d", throttle, steering);
             
-            // Вызываем метод наследника для обработки команды
-            handleMotorCommand(throttle, steering);
+            applyControlCommand(throttle, steering, arrivalUs);
             request->send(200, "text/plain", "OK");
         } else {
             request->send(400, "text/plain", "Missing parameters");
@@ -458,6 +835,14 @@ bool BaseRobot::initWebServer() {
     // Настройка специфичных обработчиков наследником
     setupWebHandlers(server_);
     
+    // Бинарный канал управления: постоянное соединение вместо HTTP запроса на команду
+    controlSocket_ = new AsyncWebSocket("/ws/control");
+    controlSocket_->onEvent([this](AsyncWebSocket* socket, AsyncWebSocketClient* client,
+                                   AwsEventType type, void* arg, uint8_t* data, size_t len) {
+        handleControlSocketEvent(socket, client, type, arg, data, len);
+    });
+    server_->addHandler(controlSocket_);
+    
     DEBUG_PRINTLN("Регистрация обработчика 404...");
     // Обработчик 404
     server_->onNotFound([](AsyncWebServerRequest* request) {
@@ -472,6 +857,68 @@ bool BaseRobot::initWebServer() {
     return true;
 }
 
+void BaseRobot::applyControlCommand(int throttlePWM, int steeringPWM, uint32_t arrivalUs) {
+#ifdef FEATURE_BLACKBOX
+    if (blackBox_) {
+        blackBox_->recordCommand(throttlePWM, steeringPWM);
+    }
+#endif
+
+    CommandTrace::handled(arrivalUs);
+
+    // Вызываем метод наследника для обработки команды
+    handleMotorCommand(throttlePWM, steeringPWM);
+}
+
+void BaseRobot::postMotorCommand(int throttlePWM, int steeringPWM) {
+    // Цикл не опрашивает ящик по таймеру: задача команд запускается только
+    // новой командой (trigger будит цикл, как и post)
+    commandMailbox_.post(throttlePWM, steeringPWM);
+    scheduler_.trigger(commandTaskId_);
+}
+
+void BaseRobot::handleControlSocketEvent(AsyncWebSocket* socket, AsyncWebSocketClient* client,
+                                         AwsEventType type, void* arg, uint8_t* data, size_t len) {
+    switch (type) {
+        case WS_EVT_CONNECT:
+            controlClients_++;
+            DEBUG_PRINTF("Канал управления: клиент %u подключен\n", client->id());
+            break;
+            
+        case WS_EVT_DISCONNECT:
+            DEBUG_PRINTF("Канал управления: клиент %u отключен\n", client->id());
+            // Последний пульт пропал - не ждем watchdog, останавливаемся сразу
+            if (controlClients_ > 0 && --controlClients_ == 0) {
+                applyControlCommand(1500, 1500, CommandTrace::now());
+            }
+            break;
+            
+        case WS_EVT_DATA: {
+            const uint32_t arrivalUs = CommandTrace::now();
+            // Пакет всегда приходит одним бинарным сообщением (TCP сохраняет порядок,
+            // поэтому проверка seq здесь не нужна - она для каналов без гарантий)
+            AwsFrameInfo* info = static_cast<AwsFrameInfo*>(arg);
+            ControlPacket packet;
+            if (!info->final || info->index != 0 || info->len != len ||
+                info->opcode != WS_BINARY || !decodeControlPacket(data, len, packet) ||
+                packet.type != CONTROL_PACKET_COMMAND) {
+                break;
+            }
+            
+            applyControlCommand(packet.throttle, packet.steering, arrivalUs);
+            
+            // Подтверждение: клиент считает RTT по своему времени из пакета
+            uint8_t ack[CONTROL_PACKET_SIZE];
+            packet.type = CONTROL_PACKET_ACK;
+            client->binary(ack, encodeControlPacket(packet, ack));
+            break;
+        }
+            
+        default:
+            break;
+    }
+}
+
 bool BaseRobot::initMDNS() {
     DEBUG_PRINTLN("Инициализация mDNS...");
     
@@ -555,31 +1002,28 @@ bool BaseRobot::initCamera() {
         return false;
     }
     
-    // Настройка параметров камеры
+    // Настройка параметров камеры: профиль из настроек (или по типу робота)
+    // Драйвер после инициализации уже знает свои значения регистров,
+    // поэтому пишутся только параметры, отличающиеся от них
     sensor_t* s = esp_camera_sensor_get();
     if (s != nullptr) {
-        s->set_brightness(s, 0);     // -2 to 2
-        s->set_contrast(s, 0);       // -2 to 2
-        s->set_saturation(s, 0);     // -2 to 2
-        s->set_special_effect(s, 0); // 0 to 6 (0 - No Effect)
-        s->set_whitebal(s, 1);       // 0 = disable , 1 = enable
-        s->set_awb_gain(s, 1);       // 0 = disable , 1 = enable
-        s->set_wb_mode(s, 0);        // 0 to 4
-        s->set_exposure_ctrl(s, 1);  // 0 = disable , 1 = enable
-        s->set_aec2(s, 0);           // 0 = disable , 1 = enable
-        s->set_ae_level(s, 0);       // -2 to 2
-        s->set_aec_value(s, 300);    // 0 to 1200
-        s->set_gain_ctrl(s, 1);      // 0 = disable , 1 = enable
-        s->set_agc_gain(s, 0);       // 0 to 30
-        s->set_gainceiling(s, (gainceiling_t)0);  // 0 to 6
-        s->set_bpc(s, 0);            // 0 = disable , 1 = enable
-        s->set_wpc(s, 1);            // 0 = disable , 1 = enable
-        s->set_raw_gma(s, 1);        // 0 = disable , 1 = enable
-        s->set_lenc(s, 1);           // 0 = disable , 1 = enable
-        s->set_hmirror(s, wifiSettings_->getCameraHMirror() ? 1 : 0);  // Горизонтальное зеркало
-        s->set_vflip(s, wifiSettings_->getCameraVFlip() ? 1 : 0);      // Вертикальный переворот
-        s->set_dcw(s, 1);            // 0 = disable , 1 = enable
-        s->set_colorbar(s, 0);       // 0 = disable , 1 = enable
+        const camera_status_t& st = s->status;
+        const int16_t initial[CAM_PARAM_COUNT] = {
+            st.brightness, st.contrast, st.saturation, st.special_effect,
+            st.awb, st.awb_gain, st.wb_mode, st.aec, st.aec2, st.ae_level,
+            (int16_t)st.aec_value, st.agc, st.agc_gain, st.gainceiling,
+            st.bpc, st.wpc, st.raw_gma, st.lenc, st.hmirror, st.vflip,
+            st.dcw, st.colorbar
+        };
+        cameraState_.seed(initial);
+        
+        const CameraProfile* profile = findCameraProfile(wifiSettings_->getCameraProfileName().c_str());
+        if (profile == nullptr) {
+            profile = findCameraProfile(CAMERA_DEFAULT_PROFILE);
+        }
+        int writes = applyCameraProfile(profile ? *profile : getCameraProfile(0));
+        DEBUG_PRINTF("Профиль камеры '%s': записано регистров %d из %d\n",
+                     cameraProfile_ ? cameraProfile_->name : "?", writes, (int)CAM_PARAM_COUNT);
     }
     
     // Запуск камера-сервера
@@ -593,6 +1037,74 @@ bool BaseRobot::initCamera() {
 #endif
 }
 
+int BaseRobot::applyCameraProfile(const CameraProfile& profile) {
+#ifdef FEATURE_CAMERA
+    sensor_t* s = esp_camera_sensor_get();
+    if (s == nullptr) {
+        return -1;
+    }
+    
+    int16_t target[CAM_PARAM_COUNT];
+    resolveCameraProfile(profile,
+                         wifiSettings_ && wifiSettings_->getCameraHMirror(),
+                         wifiSettings_ && wifiSettings_->getCameraVFlip(),
+                         target);
+    
+    // Вызывается из веб-сервера, пока задача захвата может менять
+    // качество и окно сенсора: записи идут под общей блокировкой сенсора
+    FrameBroker& broker = FrameBroker::instance();
+    broker.lockSensor();
+    uint32_t mask = cameraState_.diff(target);
+    int writes = 0;
+    for (int i = 0; i < CAM_PARAM_COUNT; i++) {
+        if (!((mask >> i) & 1)) {
+            continue;
+        }
+        int v = target[i];
+        int res = -1;
+        switch ((CameraParam)i) {
+            case CAM_BRIGHTNESS:     res = s->set_brightness(s, v); break;
+            case CAM_CONTRAST:       res = s->set_contrast(s, v); break;
+            case CAM_SATURATION:     res = s->set_saturation(s, v); break;
+            case CAM_SPECIAL_EFFECT: res = s->set_special_effect(s, v); break;
+            case CAM_WHITEBAL:       res = s->set_whitebal(s, v); break;
+            case CAM_AWB_GAIN:       res = s->set_awb_gain(s, v); break;
+            case CAM_WB_MODE:        res = s->set_wb_mode(s, v); break;
+            case CAM_EXPOSURE_CTRL:  res = s->set_exposure_ctrl(s, v); break;
+            case CAM_AEC2:           res = s->set_aec2(s, v); break;
+            case CAM_AE_LEVEL:       res = s->set_ae_level(s, v); break;
+            case CAM_AEC_VALUE:      res = s->set_aec_value(s, v); break;
+            case CAM_GAIN_CTRL:      res = s->set_gain_ctrl(s, v); break;
+            case CAM_AGC_GAIN:       res = s->set_agc_gain(s, v); break;
+            case CAM_GAINCEILING:    res = s->set_gainceiling(s, (gainceiling_t)v); break;
+            case CAM_BPC:            res = s->set_bpc(s, v); break;
+            case CAM_WPC:            res = s->set_wpc(s, v); break;
+            case CAM_RAW_GMA:        res = s->set_raw_gma(s, v); break;
+            case CAM_LENC:           res = s->set_lenc(s, v); break;
+            case CAM_HMIRROR:        res = s->set_hmirror(s, v); break;
+            case CAM_VFLIP:          res = s->set_vflip(s, v); break;
+            case CAM_DCW:            res = s->set_dcw(s, v); break;
+            case CAM_COLORBAR:       res = s->set_colorbar(s, v); break;
+            default: break;
+        }
+        writes++;
+        if (res == 0) {
+            cameraState_.markApplied((CameraParam)i, target[i]);
+        } else {
+            // Состояние регистра неизвестно - при следующем применении запишем снова
+            DEBUG_PRINTF("Камера: не удалось записать %s\n", getCameraParamName((CameraParam)i));
+        }
+    }
+    broker.unlockSensor();
+    
+    cameraProfile_ = &profile;
+    return writes;
+#else
+    (void)profile;
+    return -1;
+#endif
+}
+
 void BaseRobot::startWiFiAP() {
     DEBUG_PRINTLN("Запуск WiFi в режиме точки доступа...");
     
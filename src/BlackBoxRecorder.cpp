@@ -0,0 +1,299 @@
+#include "BlackBoxRecorder.h"
+
+#ifdef FEATURE_BLACKBOX
+
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+static inline size_t align4(size_t len) {
+    return (len + 3) & ~(size_t)3;
+}
+
+static void putLe16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void putLe32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (v >> (8 * i)) & 0xFF;
+    }
+}
+
+static void putLe64(uint8_t* p, int64_t v) {
+    putLe32(p, (uint32_t)v);
+    putLe32(p + 4, (uint32_t)((uint64_t)v >> 32));
+}
+
+BlackBoxRecorder::BlackBoxRecorder() :
+    buffer_(nullptr),
+    capacity_(0),
+    lock_(nullptr),
+    head_(0),
+    tail_(0),
+    wrapEnd_(0),
+    wrapped_(false),
+    count_(0),
+    newestUs_(0),
+    frozen_(false),
+    framesRecorded_(0),
+    eventsRecorded_(0),
+    droppedRecords_(0)
+{
+}
+
+BlackBoxRecorder::~BlackBoxRecorder() {
+    if (buffer_) {
+        heap_caps_free(buffer_);
+    }
+    if (lock_) {
+        vSemaphoreDelete(lock_);
+    }
+}
+
+bool BlackBoxRecorder::init() {
+    if (buffer_) {
+        return true;
+    }
+    if (!psramFound()) {
+        DEBUG_PRINTLN("Самописец: нет PSRAM, запись отключена");
+        return false;
+    }
+
+    buffer_ = (uint8_t*)heap_caps_malloc(BLACKBOX_BUFFER_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buffer_) {
+        DEBUG_PRINTLN("ОШИБКА: Самописец: не удалось выделить буфер в PSRAM");
+        return false;
+    }
+    capacity_ = BLACKBOX_BUFFER_SIZE;
+    lock_ = xSemaphoreCreateMutex();
+
+    DEBUG_PRINTF("Самописец: %u КБ PSRAM, окно %u с\n",
+                 (unsigned)(capacity_ / 1024), (unsigned)(BLACKBOX_WINDOW_MS / 1000));
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// ЗАПИСЬ
+// ═══════════════════════════════════════════════════════════════
+
+void BlackBoxRecorder::recordFrame(const uint8_t* jpeg, size_t len, uint16_t width, uint16_t height,
+                                   int64_t timestampUs) {
+    uint8_t prefix[4];
+    putLe16(prefix, width);
+    putLe16(prefix + 2, height);
+    append(RECORD_FRAME, timestampUs, prefix, sizeof(prefix), jpeg, len);
+}
+
+void BlackBoxRecorder::recordCommand(int throttlePWM, int steeringPWM) {
+    uint8_t data[4];
+    putLe16(data, (uint16_t)(int16_t)throttlePWM);
+    putLe16(data + 2, (uint16_t)(int16_t)steeringPWM);
+    append(RECORD_COMMAND, esp_timer_get_time(), data, sizeof(data), nullptr, 0);
+}
+
+void BlackBoxRecorder::recordMotor(int leftSpeed, int rightSpeed) {
+    uint8_t data[4];
+    putLe16(data, (uint16_t)(int16_t)leftSpeed);
+    putLe16(data + 2, (uint16_t)(int16_t)rightSpeed);
+    append(RECORD_MOTOR, esp_timer_get_time(), data, sizeof(data), nullptr, 0);
+}
+
+void BlackBoxRecorder::append(RecordType type, int64_t timestampUs,
+                              const void* prefix, size_t prefixLen, const void* data, size_t dataLen) {
+    if (!buffer_) {
+        return;
+    }
+
+    const size_t payloadLen = prefixLen + dataLen;
+    const size_t stride = kRecordHeaderSize + align4(payloadLen);
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+
+    // Кадр больше половины кольца вытеснил бы почти всю историю
+    if (frozen_ || stride > capacity_ / 2) {
+        droppedRecords_++;
+        xSemaphoreGive(lock_);
+        return;
+    }
+
+    // Окно по времени: выбрасываем записи старше BLACKBOX_WINDOW_MS
+    const int64_t cutoffUs = timestampUs - (int64_t)BLACKBOX_WINDOW_MS * 1000;
+    while (count_ > 0 && recordTimestamp(head_) < cutoffUs) {
+        evictOldest();
+    }
+
+    makeRoom(stride);
+
+    uint8_t* rec = buffer_ + tail_;
+    rec[0] = type;
+    rec[1] = 0;
+    putLe16(rec + 2, 0);
+    putLe32(rec + 4, payloadLen);
+    putLe64(rec + 8, timestampUs);
+    uint8_t* payload = rec + kRecordHeaderSize;
+    memcpy(payload, prefix, prefixLen);
+    if (dataLen) {
+        memcpy(payload + prefixLen, data, dataLen);
+    }
+    memset(payload + payloadLen, 0, align4(payloadLen) - payloadLen);
+
+    tail_ += stride;
+    count_++;
+    newestUs_ = timestampUs;
+    if (type == RECORD_FRAME) {
+        framesRecorded_++;
+    } else {
+        eventsRecorded_++;
+    }
+
+    xSemaphoreGive(lock_);
+}
+
+// Освобождает непрерывный участок stride байт в позиции tail_,
+// вытесняя самые старые записи. Записи не разрезаются: если в конце
+// буфера места не хватает, запись переносится в начало (wrapEnd_).
+bool BlackBoxRecorder::makeRoom(size_t stride) {
+    for (;;) {
+        if (count_ == 0) {
+            head_ = 0;
+            tail_ = 0;
+            wrapped_ = false;
+        }
+
+        if (!wrapped_) {
+            if (capacity_ - tail_ >= stride) {
+                return true;
+            }
+            if (head_ >= stride) {
+                wrapEnd_ = tail_;
+                tail_ = 0;
+                wrapped_ = true;
+                continue;
+            }
+        } else if (head_ - tail_ >= stride) {
+            return true;
+        }
+
+        evictOldest();
+    }
+}
+
+void BlackBoxRecorder::evictOldest() {
+    head_ += recordStride(head_);
+    count_--;
+    if (wrapped_ && head_ >= wrapEnd_) {
+        head_ = 0;
+        wrapped_ = false;
+    }
+}
+
+int64_t BlackBoxRecorder::recordTimestamp(size_t offset) const {
+    int64_t ts;
+    memcpy(&ts, buffer_ + offset + 8, sizeof(ts));
+    return ts;
+}
+
+size_t BlackBoxRecorder::recordStride(size_t offset) const {
+    uint32_t payloadLen;
+    memcpy(&payloadLen, buffer_ + offset + 4, sizeof(payloadLen));
+    return kRecordHeaderSize + align4(payloadLen);
+}
+
+// ═══════════════════════════════════════════════════════════════
+// ВЫГРУЗКА
+// ═══════════════════════════════════════════════════════════════
+
+bool BlackBoxRecorder::beginDownload() {
+    if (!buffer_) {
+        return false;
+    }
+    // Под мьютексом: после возврата ни одна запись не находится в процессе
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    const bool wasFrozen = frozen_;
+    frozen_ = true;
+    xSemaphoreGive(lock_);
+    return !wasFrozen;
+}
+
+void BlackBoxRecorder::endDownload() {
+    if (!buffer_) {
+        return;
+    }
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    frozen_ = false;
+    xSemaphoreGive(lock_);
+}
+
+size_t BlackBoxRecorder::getDownloadSize() const {
+    const size_t used = wrapped_ ? (wrapEnd_ - head_) + tail_ : tail_ - head_;
+    return kFileHeaderSize + used;
+}
+
+void BlackBoxRecorder::buildFileHeader(uint8_t* header) const {
+    memset(header, 0, kFileHeaderSize);
+    memcpy(header, "MBBX", 4);
+    putLe16(header + 4, 1);
+    putLe16(header + 6, kFileHeaderSize);
+    putLe32(header + 8, count_);
+    putLe64(header + 16, count_ ? recordTimestamp(head_) : 0);
+    putLe64(header + 24, count_ ? newestUs_ : 0);
+}
+
+// Файл собирается на лету из трех участков: заголовок, [head_, конец данных),
+// [0, tail_) после переноса. Кольцо заморожено, поэтому участки неизменны
+size_t BlackBoxRecorder::readDownload(uint8_t* out, size_t maxLen, size_t index) const {
+    if (!buffer_ || !frozen_) {
+        return 0;
+    }
+
+    const size_t firstEnd = wrapped_ ? wrapEnd_ : tail_;
+    const size_t firstLen = firstEnd - head_;
+    const size_t secondLen = wrapped_ ? tail_ : 0;
+    size_t written = 0;
+
+    while (written < maxLen) {
+        size_t pos = index + written;
+        size_t n;
+        if (pos < kFileHeaderSize) {
+            uint8_t header[kFileHeaderSize];
+            buildFileHeader(header);
+            n = min(maxLen - written, kFileHeaderSize - pos);
+            memcpy(out + written, header + pos, n);
+        } else if ((pos -= kFileHeaderSize) < firstLen) {
+            n = min(maxLen - written, firstLen - pos);
+            memcpy(out + written, buffer_ + head_ + pos, n);
+        } else if ((pos -= firstLen) < secondLen) {
+            n = min(maxLen - written, secondLen - pos);
+            memcpy(out + written, buffer_ + pos, n);
+        } else {
+            break; // Конец файла
+        }
+        written += n;
+    }
+    return written;
+}
+
+String BlackBoxRecorder::getStatusJson() const {
+    if (lock_) {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+    }
+    String json = "{";
+    json += "\"enabled\":" + String(buffer_ ? "true" : "false") + ",";
+    json += "\"downloading\":" + String(frozen_ ? "true" : "false") + ",";
+    json += "\"capacity\":" + String((uint32_t)capacity_) + ",";
+    json += "\"used\":" + String((uint32_t)(buffer_ ? getDownloadSize() - kFileHeaderSize : 0)) + ",";
+    json += "\"records\":" + String(count_) + ",";
+    json += "\"windowMs\":" + String((uint32_t)BLACKBOX_WINDOW_MS) + ",";
+    json += "\"spanMs\":" + String((uint32_t)(count_ && buffer_ ? (newestUs_ - recordTimestamp(head_)) / 1000 : 0)) + ",";
+    json += "\"framesRecorded\":" + String(framesRecorded_) + ",";
+    json += "\"eventsRecorded\":" + String(eventsRecorded_) + ",";
+    json += "\"dropped\":" + String(droppedRecords_);
+    json += "}";
+    if (lock_) {
+        xSemaphoreGive(lock_);
+    }
+    return json;
+}
+
+#endif // FEATURE_BLACKBOX
@@ -34,9 +34,11 @@ bool BrainRobot::initSpecificComponents() {
     return true;
 }
 
-void BrainRobot::updateSpecificComponents() {
+void BrainRobot::scheduleSpecificComponents(ComponentScheduler& scheduler) {
     // Обновление выходов в зависимости от протокола
-    updateOutputs();
+    scheduler.add("outputs", PROTOCOL_OUTPUT_PERIOD_US, PROTOCOL_OUTPUT_DEADLINE_US, [this]() {
+        updateOutputs();
+    });
 }
 
 void BrainRobot::shutdownSpecificComponents() {
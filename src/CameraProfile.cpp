@@ -0,0 +1,93 @@
+#include "CameraProfile.h"
+#include <string.h>
+
+static const char* const kParamNames[CAM_PARAM_COUNT] = {
+    "brightness", "contrast", "saturation", "specialEffect",
+    "whitebal", "awbGain", "wbMode", "exposureCtrl", "aec2", "aeLevel",
+    "aecValue", "gainCtrl", "agcGain", "gainceiling", "bpc", "wpc",
+    "rawGma", "lenc", "hmirror", "vflip", "dcw", "colorbar"
+};
+
+// Порядок значений - как в enum CameraParam
+static const CameraProfile kProfiles[] = {
+    // Езда: автоэкспозиция и баланс белого, прежние настройки initCamera
+    { "driving",   { 0, 0, 0, 0,  1, 1, 0,  1, 0, 0, 300,  1, 0, 0,  0, 1, 1, 1,  0, 0, 1, 0 } },
+    // Линия: повышенный контраст, ограничение усиления против шума на полу.
+    // Не по умолчанию: меняет яркость кадра, пороги LINE_* проверять заново
+    { "line",      { 0, 2, -2, 0, 1, 1, 0,  1, 0, 0, 300,  1, 0, 2,  1, 1, 1, 1,  0, 0, 1, 0 } },
+    // Слабый свет: ночной режим DSP, больше экспозиции и потолок усиления 128x
+    { "low-light", { 1, 0, 0, 0,  1, 1, 0,  1, 1, 2, 300,  1, 0, 6,  1, 1, 1, 1,  0, 0, 1, 0 } },
+};
+
+static const int kProfileCount = sizeof(kProfiles) / sizeof(kProfiles[0]);
+
+int getCameraProfileCount() {
+    return kProfileCount;
+}
+
+const CameraProfile& getCameraProfile(int index) {
+    if (index < 0 || index >= kProfileCount) {
+        index = 0;
+    }
+    return kProfiles[index];
+}
+
+const CameraProfile* findCameraProfile(const char* name) {
+    if (name == nullptr) {
+        return nullptr;
+    }
+    for (int i = 0; i < kProfileCount; i++) {
+        if (strcmp(kProfiles[i].name, name) == 0) {
+            return &kProfiles[i];
+        }
+    }
+    return nullptr;
+}
+
+void resolveCameraProfile(const CameraProfile& profile, bool hmirror, bool vflip,
+                          int16_t target[CAM_PARAM_COUNT]) {
+    memcpy(target, profile.values, sizeof(profile.values));
+    target[CAM_HMIRROR] = hmirror ? 1 : 0;
+    target[CAM_VFLIP] = vflip ? 1 : 0;
+}
+
+const char* getCameraParamName(CameraParam param) {
+    return param < CAM_PARAM_COUNT ? kParamNames[param] : "?";
+}
+
+CameraProfileState::CameraProfileState() {
+    reset();
+}
+
+void CameraProfileState::reset() {
+    for (int i = 0; i < CAM_PARAM_COUNT; i++) {
+        applied_[i] = 0;
+    }
+    knownMask_ = 0;
+}
+
+void CameraProfileState::seed(const int16_t values[CAM_PARAM_COUNT]) {
+    for (int i = 0; i < CAM_PARAM_COUNT; i++) {
+        applied_[i] = values[i];
+    }
+    knownMask_ = (1UL << CAM_PARAM_COUNT) - 1;
+}
+
+uint32_t CameraProfileState::diff(const int16_t target[CAM_PARAM_COUNT]) const {
+    uint32_t mask = 0;
+    for (int i = 0; i < CAM_PARAM_COUNT; i++) {
+        // Неизвестный параметр пишется всегда, известный - только при отличии
+        if (!((knownMask_ >> i) & 1) || applied_[i] != target[i]) {
+            mask |= 1UL << i;
+        }
+    }
+    return mask;
+}
+
+void CameraProfileState::markApplied(CameraParam param, int16_t value) {
+    if (param >= CAM_PARAM_COUNT) {
+        return;
+    }
+    applied_[param] = value;
+    knownMask_ |= 1UL << param;
+}
@@ -3,86 +3,698 @@
 
 #include "esp_http_server.h"
 #include "esp_camera.h"
-#include "img_converters.h"
 #include "Arduino.h"
+#include "lwip/sockets.h"
+#include "esp_timer.h"
+#include "hardware_config.h"
+#include "FrameBroker.h"
+#include "LatencyHistogram.h"
 
 // Глобальный httpd сервер для камеры
 static httpd_handle_t camera_httpd = NULL;
 
 // Stream encoding
+// Каждый кадр уходит одной векторной записью: заголовок части + JPEG +
+// закрывающая граница. Граница сразу после JPEG завершает часть, и браузер
+// показывает кадр, не дожидаясь следующего. Первую границу отправляет
+// stream_handler вместе с заголовком ответа.
+// Заголовок части форматируется на каждый кадр (длина, время, номер),
+// граница - постоянная строка.
 #define PART_BOUNDARY "123456789000000000000987654321"
 static const char* _STREAM_CONTENT_TYPE = "multipart/x-mixed-replace;boundary=" PART_BOUNDARY;
-static const char* _STREAM_BOUNDARY = "\r\n--" PART_BOUNDARY "\r\n";
-static const char* _STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n";
+static const char _STREAM_BOUNDARY[] = "\r\n--" PART_BOUNDARY "\r\n";
+// X-Timestamp - время захвата сенсором (сек.мкс от старта, часы esp_timer, как /time),
+// X-Frame-Seq - порядковый номер кадра брокера (пропуски = не доставленные кадры)
+static const char* _STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\nX-Timestamp: %u.%06u\r\nX-Frame-Seq: %u\r\n";
+// Кадр с окна сенсора: X-ROI = x,y,ширина,высота в координатах SVGA (FrameRoi)
+static const char* _STREAM_PART_ROI = "X-ROI: %u,%u,%u,%u\r\n";
 
-static esp_err_t stream_handler(httpd_req_t *req) {
-    camera_fb_t * fb = NULL;
-    esp_err_t res = ESP_OK;
-    size_t _jpg_buf_len = 0;
-    uint8_t * _jpg_buf = NULL;
-    char part_buf[64];
-
-    res = httpd_resp_set_type(req, _STREAM_CONTENT_TYPE);
-    if(res != ESP_OK){
-        return res;
-    }
-
-    while(true){
-        fb = esp_camera_fb_get();
-        if (!fb) {
-            Serial.println("Camera capture failed");
-            res = ESP_FAIL;
-        } else {
-            if(fb->format != PIXFORMAT_JPEG){
-                bool jpeg_converted = frame2jpg(fb, 80, &_jpg_buf, &_jpg_buf_len);
-                esp_camera_fb_return(fb);
-                fb = NULL;
-                if(!jpeg_converted){
-                    Serial.println("JPEG compression failed");
-                    res = ESP_FAIL;
-                }
-            } else {
-                _jpg_buf_len = fb->len;
-                _jpg_buf = fb->buf;
+// Каждые N кадров зритель печатает статистику отправки
+#define STREAM_STATS_LOG_INTERVAL 100
+
+// ═══════════════════════════════════════════════════════════════
+// ЗРИТЕЛИ СТРИМА
+// ═══════════════════════════════════════════════════════════════
+// httpd обслуживает все соединения в одной задаче, поэтому бесконечный
+// цикл в обработчике блокирует остальных зрителей. Обработчик /stream
+// только отправляет заголовок ответа и передает сокет отдельной задаче
+// отправки, которая берет кадры из FrameBroker.
+// Сокет закрывает только задача отправки: httpd при закрытии сессии
+// вызывает stream_close_fn, которая лишь помечает зрителя.
+
+// Счетчики отправки кадров одному зрителю
+struct StreamSendStats {
+    uint32_t frames;         // Доставленные кадры
+    uint32_t dropped;        // Опубликованные брокером, но пропущенные зрителем
+    uint32_t duplicates;     // Не отправленные кадры неизменной сцены (dedup)
+    uint64_t bytesSaved;     // Сэкономленный трафик на пропуске дубликатов
+    uint32_t congested;      // WebSocket: кадры, пропущенные из-за заполненной очереди сокета
+    uint64_t bytes;
+    uint64_t sendTimeUs;     // Суммарное время отправки кадров
+    uint32_t lastSendUs;
+    uint32_t maxSendUs;
+    LatencyHistogram sendLatency;    // Запись кадра в сокет
+    LatencyHistogram frameAge;       // Возраст кадра (от захвата сенсором) к началу отправки
+};
+
+struct StreamClient {
+    bool active;
+    int fd;
+    int subscriberId;
+    TaskHandle_t task;
+    volatile bool closing;   // httpd закрыл сессию, сокет пора освобождать
+    bool websocket;          // Транспорт: WebSocket (/ws/stream) или multipart (/stream)
+    uint32_t fpsCap;         // Ограничение FPS из запроса (0 - без ограничения)
+    bool dedup;              // Пропускать кадры неизменной сцены (?dedup=1)
+    uint32_t connectedMs;
+    StreamSendStats stats;
+    // WebSocket: запись в сокет. Кадры пишет задача отправки, PONG/CLOSE -
+    // задача httpd; рамки разных писателей не должны перемежаться
+    SemaphoreHandle_t sendLock;
+};
+
+static StreamClient stream_clients[STREAM_MAX_CLIENTS];
+static SemaphoreHandle_t stream_clients_lock = NULL;
+// Счетчики stats пишет задача отправки, читает /stream/stats (async_tcp):
+// 64-битные поля и гистограммы меняются не атомарно
+static portMUX_TYPE stream_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static StreamClient* find_stream_client(int fd) {
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (stream_clients[i].active && stream_clients[i].fd == fd) {
+            return &stream_clients[i];
+        }
+    }
+    return NULL;
+}
+
+// Векторная отправка в блокирующий сокет с дозаписью остатка
+static bool stream_writev_all(int fd, struct iovec* iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t sent = lwip_writev(fd, iov, iovcnt);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
             }
+            return false; // Включая таймаут отправки: зритель не читает данные
+        }
+        // Пропускаем полностью отправленные буферы, сдвигаем частично отправленный
+        while (iovcnt > 0 && (size_t)sent >= iov->iov_len) {
+            sent -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (uint8_t*)iov->iov_base + sent;
+            iov->iov_len -= sent;
+        }
+    }
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// WEBSOCKET ТРАНСПОРТ (/ws/stream)
+// ═══════════════════════════════════════════════════════════════
+// Каждый кадр - одно бинарное сообщение: заголовок приложения + JPEG.
+// Заголовок (little-endian, WS_FRAME_HEADER_SIZE байт):
+//   [0]     версия (2)
+//   [1]     размер заголовка
+//   [2..3]  ширина
+//   [4..5]  высота
+//   [6..7]  резерв
+//   [8..11] порядковый номер кадра
+//   [12..19] время захвата сенсором, мкс от старта робота
+//   [20..27] окно сенсора x, y, ширина, высота (SVGA, ширина 0 - полный кадр), с версии 2
+// Клиент должен пропускать заголовок по его размеру: новые поля добавляются в конец.
+// Рамку WebSocket собирает задача отправки, поэтому кадр уходит той же
+// векторной записью, что и multipart. Управляющие сообщения (PING/CLOSE)
+// обрабатывает ws_stream_handler: ответ пишется под sendLock зрителя,
+// чтобы не попасть в середину кадра.
+
+#define WS_FRAME_HEADER_VERSION 2
+#define WS_FRAME_HEADER_SIZE 28
+
+static void put_le16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put_le32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (v >> (8 * i)) & 0xFF;
+    }
+}
+
+// Рамка бинарного сообщения сервера (без маски) + заголовок приложения
+static size_t ws_build_frame_header(uint8_t* buf, const FrameSlot* frame) {
+    const uint64_t payloadLen = WS_FRAME_HEADER_SIZE + frame->len;
+    size_t pos = 0;
+    buf[pos++] = 0x82; // FIN + бинарное сообщение
+    if (payloadLen < 126) {
+        buf[pos++] = payloadLen;
+    } else if (payloadLen <= 0xFFFF) {
+        buf[pos++] = 126;
+        buf[pos++] = payloadLen >> 8;
+        buf[pos++] = payloadLen & 0xFF;
+    } else {
+        buf[pos++] = 127;
+        for (int i = 7; i >= 0; i--) {
+            buf[pos++] = (payloadLen >> (8 * i)) & 0xFF;
+        }
+    }
+
+    uint8_t* app = buf + pos;
+    app[0] = WS_FRAME_HEADER_VERSION;
+    app[1] = WS_FRAME_HEADER_SIZE;
+    put_le16(app + 2, frame->width);
+    put_le16(app + 4, frame->height);
+    put_le16(app + 6, 0);
+    put_le32(app + 8, frame->seq);
+    put_le32(app + 12, (uint32_t)frame->timestampUs);
+    put_le32(app + 16, (uint32_t)(frame->timestampUs >> 32));
+    put_le16(app + 20, frame->roiX);
+    put_le16(app + 22, frame->roiY);
+    put_le16(app + 24, frame->roiWidth);
+    put_le16(app + 26, frame->roiHeight);
+    return pos + WS_FRAME_HEADER_SIZE;
+}
+
+// Очередь отправки сокета ниже порога lwIP (TCP_SNDLOWAT/TCP_SNDQUEUELOWAT)?
+// Если нет - клиент не успевает, кадр лучше пропустить, чем копить задержку
+static bool stream_socket_writable(int fd) {
+    fd_set writeSet;
+    FD_ZERO(&writeSet);
+    FD_SET(fd, &writeSet);
+    struct timeval timeout = { 0, 0 };
+    return select(fd + 1, NULL, &writeSet, NULL, &timeout) > 0;
+}
+
+static bool stream_send_frame(StreamClient* client, const FrameSlot* frame) {
+    char part_buf[192];
+    size_t hlen;
+    if (client->websocket) {
+        hlen = ws_build_frame_header((uint8_t*)part_buf, frame);
+    } else {
+        hlen = snprintf(part_buf, sizeof(part_buf), _STREAM_PART, (unsigned)frame->len,
+                        (unsigned)(frame->timestampUs / 1000000), (unsigned)(frame->timestampUs % 1000000),
+                        (unsigned)frame->seq);
+        if (frame->roiWidth) {
+            hlen += snprintf(part_buf + hlen, sizeof(part_buf) - hlen, _STREAM_PART_ROI,
+                             frame->roiX, frame->roiY, frame->roiWidth, frame->roiHeight);
+        }
+        part_buf[hlen++] = '\r';
+        part_buf[hlen++] = '\n';
+    }
+
+    struct iovec iov[3];
+    iov[0].iov_base = part_buf;
+    iov[0].iov_len = hlen;
+    iov[1].iov_base = frame->buf;
+    iov[1].iov_len = frame->len;
+    int iovcnt = 2;
+    if (!client->websocket) {
+        iov[2].iov_base = (void*)_STREAM_BOUNDARY;
+        iov[2].iov_len = sizeof(_STREAM_BOUNDARY) - 1;
+        hlen += iov[2].iov_len;   // Граница входит в байты статистики
+        iovcnt = 3;
+    }
+
+    int64_t start = esp_timer_get_time();
+    const uint32_t ageUs = (uint32_t)(start - frame->timestampUs);
+    if (client->websocket) {
+        xSemaphoreTake(client->sendLock, portMAX_DELAY);
+    }
+    bool ok = stream_writev_all(client->fd, iov, iovcnt);
+    if (client->websocket) {
+        xSemaphoreGive(client->sendLock);
+    }
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+
+    if (ok) {
+        FrameBroker::instance().reportFrameSent(elapsed, frame->len);
+
+        StreamSendStats& stats = client->stats;
+        portENTER_CRITICAL(&stream_stats_mux);
+        stats.frames++;
+        stats.bytes += hlen + frame->len;
+        stats.sendTimeUs += elapsed;
+        stats.lastSendUs = elapsed;
+        stats.sendLatency.record(elapsed);
+        stats.frameAge.record(ageUs);
+        if (elapsed > stats.maxSendUs) {
+            stats.maxSendUs = elapsed;
+        }
+        const uint32_t frames = stats.frames;
+        const uint64_t bytes = stats.bytes;
+        const uint64_t sendTimeUs = stats.sendTimeUs;
+        const uint32_t maxSendUs = stats.maxSendUs;
+        portEXIT_CRITICAL(&stream_stats_mux);
+
+        if (frames % STREAM_STATS_LOG_INTERVAL == 0) {
+            DEBUG_PRINTF("Стрим fd=%d: %u кадров, отправка avg=%u мкс max=%u мкс, %u КБ/с\n",
+                         client->fd, frames,
+                         (unsigned)(sendTimeUs / frames), maxSendUs,
+                         (unsigned)(sendTimeUs ? bytes * 1000 / sendTimeUs : 0));
+        }
+    }
+    return ok;
+}
+
+// Ждем, пока истечет интервал кадра зрителя (или сессия закроется).
+// Уведомления о новых кадрах в это время только будят задачу - кадр
+// возьмем один, самый свежий, по истечении интервала.
+static void stream_wait_pacing(StreamClient* client, int64_t lastSentUs) {
+    if (client->fpsCap == 0 || lastSentUs == 0) {
+        return;
+    }
+    const int64_t intervalUs = 1000000LL / client->fpsCap;
+    while (!client->closing) {
+        int64_t remainingUs = lastSentUs + intervalUs - esp_timer_get_time();
+        if (remainingUs <= 0) {
+            return;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(remainingUs / 1000) + 1);
+    }
+}
+
+static void stream_client_task(void* arg) {
+    StreamClient* client = static_cast<StreamClient*>(arg);
+    FrameBroker& broker = FrameBroker::instance();
+    uint32_t lastSeq = 0;
+    uint32_t lastSceneSeq = 0;
+    int64_t lastSentUs = 0;
+    bool failed = false;
+
+    client->subscriberId = broker.subscribe(xTaskGetCurrentTaskHandle());
+
+    while (!client->closing) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(STREAM_FRAME_WAIT_MS));
+        if (client->closing || failed) {
+            continue;
+        }
+
+        // Свой бюджет кадров у каждого зрителя: медленный не тормозит остальных
+        stream_wait_pacing(client, lastSentUs);
+        if (client->closing) {
+            continue;
+        }
+
+        // Всегда берем самый свежий кадр, промежуточные пропускаются
+        FrameSlot* frame = broker.acquireLatest(lastSeq);
+        if (!frame) {
+            continue;
         }
-        
-        if(res == ESP_OK){
-            size_t hlen = snprintf(part_buf, 64, _STREAM_PART, _jpg_buf_len);
-            res = httpd_resp_send_chunk(req, part_buf, hlen);
+        if (lastSeq != 0 && frame->seq > lastSeq + 1) {
+            portENTER_CRITICAL(&stream_stats_mux);
+            client->stats.dropped += frame->seq - lastSeq - 1;
+            portEXIT_CRITICAL(&stream_stats_mux);
         }
-        if(res == ESP_OK){
-            res = httpd_resp_send_chunk(req, (const char *)_jpg_buf, _jpg_buf_len);
+        lastSeq = frame->seq;
+
+        // Сцена не менялась с прошлого отправленного кадра - шлем только keep-alive
+        const int64_t now = esp_timer_get_time();
+        if (client->dedup && frame->sceneSeq == lastSceneSeq &&
+            now - lastSentUs < STREAM_DEDUP_KEEPALIVE_MS * 1000LL) {
+            portENTER_CRITICAL(&stream_stats_mux);
+            client->stats.duplicates++;
+            client->stats.bytesSaved += frame->len;
+            portEXIT_CRITICAL(&stream_stats_mux);
+            broker.release(frame);
+            continue;
         }
-        if(res == ESP_OK){
-            res = httpd_resp_send_chunk(req, _STREAM_BOUNDARY, strlen(_STREAM_BOUNDARY));
+        if (client->websocket && !stream_socket_writable(client->fd)) {
+            portENTER_CRITICAL(&stream_stats_mux);
+            client->stats.congested++;
+            portEXIT_CRITICAL(&stream_stats_mux);
+            broker.release(frame);
+            continue;
         }
-        
-        if(fb){
-            esp_camera_fb_return(fb);
-            fb = NULL;
-            _jpg_buf = NULL;
-        } else if(_jpg_buf){
-            free(_jpg_buf);
-            _jpg_buf = NULL;
+        lastSceneSeq = frame->sceneSeq;
+        lastSentUs = now;
+        bool ok = stream_send_frame(client, frame);
+        broker.release(frame);
+
+        if (!ok) {
+            // Просим httpd закрыть сессию; сокет освободим после stream_close_fn
+            failed = true;
+            httpd_sess_trigger_close(camera_httpd, client->fd);
         }
-        
-        if(res != ESP_OK){
+    }
+
+    broker.unsubscribe(client->subscriberId);
+    close(client->fd);
+
+    xSemaphoreTake(stream_clients_lock, portMAX_DELAY);
+    client->active = false;
+    xSemaphoreGive(stream_clients_lock);
+
+    vTaskDelete(NULL);
+}
+
+// Вызывается httpd вместо close() при завершении любой сессии
+static void stream_close_fn(httpd_handle_t hd, int sockfd) {
+    // Уведомление под блокировкой: задача не может завершиться, пока мы ее будим
+    xSemaphoreTake(stream_clients_lock, portMAX_DELAY);
+    StreamClient* client = find_stream_client(sockfd);
+    if (client) {
+        client->closing = true;
+        xTaskNotifyGive(client->task);
+    }
+    xSemaphoreGive(stream_clients_lock);
+
+    if (!client) {
+        close(sockfd);
+    }
+}
+
+// Параметры зрителя из строки запроса: /stream?fps=15&dedup=1
+static void stream_parse_params(httpd_req_t *req, uint32_t* fpsCap, bool* dedup) {
+    char query[64];
+    char value[8];
+    *fpsCap = 0;
+    *dedup = false;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK) {
+        return;
+    }
+    if (httpd_query_key_value(query, "fps", value, sizeof(value)) == ESP_OK) {
+        int fps = atoi(value);
+        if (fps > 0) {
+            *fpsCap = fps > STREAM_FPS_CAP_MAX ? STREAM_FPS_CAP_MAX : fps;
+        }
+    }
+    if (httpd_query_key_value(query, "dedup", value, sizeof(value)) == ESP_OK) {
+        *dedup = atoi(value) != 0;
+    }
+}
+
+// Занять место зрителя (NULL, если все места заняты)
+static StreamClient* stream_client_claim(httpd_req_t *req, bool websocket) {
+    uint32_t fpsCap;
+    bool dedup;
+    stream_parse_params(req, &fpsCap, &dedup);
+
+    StreamClient* client = NULL;
+    xSemaphoreTake(stream_clients_lock, portMAX_DELAY);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (!stream_clients[i].active) {
+            client = &stream_clients[i];
+            client->active = true;
+            client->fd = httpd_req_to_sockfd(req);
+            client->subscriberId = -1;
+            client->task = NULL;
+            client->closing = false;
+            client->websocket = websocket;
+            client->fpsCap = fpsCap;
+            client->dedup = dedup;
+            client->connectedMs = millis();
+            client->stats = StreamSendStats();
             break;
         }
     }
-    
+    xSemaphoreGive(stream_clients_lock);
+    return client;
+}
+
+static void stream_client_release(StreamClient* client) {
+    xSemaphoreTake(stream_clients_lock, portMAX_DELAY);
+    client->active = false;
+    xSemaphoreGive(stream_clients_lock);
+}
+
+// Передать сокет задаче отправки
+static bool stream_client_start(StreamClient* client) {
+    if (xTaskCreate(stream_client_task, "stream_tx", STREAM_TX_TASK_STACK, client,
+                    STREAM_TX_TASK_PRIORITY, &client->task) != pdPASS) {
+        stream_client_release(client);
+        return false;
+    }
+    DEBUG_PRINTF("Стрим fd=%d: новый зритель (%s), FPS %u, dedup %d\n", client->fd,
+                 client->websocket ? "ws" : "mjpeg", (unsigned)client->fpsCap, client->dedup);
+    return true;
+}
+
+static esp_err_t stream_handler(httpd_req_t *req) {
+    StreamClient* client = stream_client_claim(req, false);
+    if (!client) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_type(req, "text/plain");
+        return httpd_resp_send(req, "Too many stream clients", HTTPD_RESP_USE_STRLEN);
+    }
+
+    // Заголовок ответа отправляем сами: тело стрима пишет задача отправки.
+    // Тело начинается с первой границы, дальше каждый кадр закрывает свою часть
+    char header[256];
+    size_t hlen = snprintf(header, sizeof(header),
+                           "HTTP/1.1 200 OK\r\n"
+                           "Content-Type: %s\r\n"
+                           "Access-Control-Allow-Origin: *\r\n"
+                           "Cache-Control: no-cache\r\n"
+                           "Connection: close\r\n\r\n"
+                           "--" PART_BOUNDARY "\r\n",
+                           _STREAM_CONTENT_TYPE);
+
+    if (httpd_send(req, header, hlen) != (int)hlen) {
+        stream_client_release(client);
+        return ESP_FAIL;
+    }
+    return stream_client_start(client) ? ESP_OK : ESP_FAIL;
+}
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+// Ответ на управляющее сообщение под блокировкой записи зрителя
+static esp_err_t ws_send_control(httpd_req_t *req, httpd_ws_frame_t* pkt) {
+    xSemaphoreTake(stream_clients_lock, portMAX_DELAY);
+    StreamClient* client = find_stream_client(httpd_req_to_sockfd(req));
+    SemaphoreHandle_t sendLock = client ? client->sendLock : NULL;
+    xSemaphoreGive(stream_clients_lock);
+
+    // sendLock принадлежит слоту и живет все время работы сервера
+    if (sendLock) {
+        xSemaphoreTake(sendLock, portMAX_DELAY);
+    }
+    esp_err_t ret = httpd_ws_send_frame(req, pkt);
+    if (sendLock) {
+        xSemaphoreGive(sendLock);
+    }
+    return ret;
+}
+
+// /ws/stream: httpd выполняет рукопожатие и вызывает обработчик с HTTP_GET,
+// затем - на каждое входящее сообщение, включая PING/CLOSE
+// (handle_ws_control_frames): сокет пишет и задача отправки, поэтому
+// ответы httpd не должны уходить в обход sendLock.
+static esp_err_t ws_stream_handler(httpd_req_t *req) {
+    if (req->method == HTTP_GET) {
+        StreamClient* client = stream_client_claim(req, true);
+        if (!client) {
+            DEBUG_PRINTLN("WS стрим: нет свободных мест");
+            return ESP_FAIL; // httpd закроет сессию
+        }
+        return stream_client_start(client) ? ESP_OK : ESP_FAIL;
+    }
+
+    // Полезная нагрузка управляющего сообщения - не больше 125 байт
+    uint8_t buf[125];
+    httpd_ws_frame_t pkt;
+    memset(&pkt, 0, sizeof(pkt));
+    esp_err_t ret = httpd_ws_recv_frame(req, &pkt, 0);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (pkt.len > sizeof(buf)) {
+        return ESP_FAIL;
+    }
+    if (pkt.len > 0) {
+        pkt.payload = buf;
+        ret = httpd_ws_recv_frame(req, &pkt, sizeof(buf));
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    if (pkt.type == HTTPD_WS_TYPE_PING) {
+        // PONG с той же нагрузкой
+        pkt.type = HTTPD_WS_TYPE_PONG;
+        return ws_send_control(req, &pkt);
+    }
+    if (pkt.type == HTTPD_WS_TYPE_CLOSE) {
+        // Ответный CLOSE, сокет освободит задача отправки после stream_close_fn
+        pkt.type = HTTPD_WS_TYPE_CLOSE;
+        pkt.len = 0;
+        pkt.payload = NULL;
+        ws_send_control(req, &pkt);
+        httpd_sess_trigger_close(req->handle, httpd_req_to_sockfd(req));
+        return ESP_OK;
+    }
+    // Остальные сообщения от клиента не используются
+    return ESP_OK;
+}
+#endif
+
+// Синхронизация часов для измерения задержки: текущее время esp_timer, в тех же
+// единицах, что и X-Timestamp кадров. Клиент оценивает смещение часов по
+// запросу с минимальным RTT: offset = timeUs - (t_отправки + t_ответа) / 2
+static esp_err_t time_handler(httpd_req_t *req) {
+    char json[40];
+    int len = snprintf(json, sizeof(json), "{\"timeUs\":%lld}", (long long)esp_timer_get_time());
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    return httpd_resp_send(req, json, len);
+}
+
+// Снимок последнего кадра из кэша брокера, без нового захвата сенсором.
+// ETag - порядковый номер кадра: опрашивающий клиент с If-None-Match
+// получает 304 без тела, пока новый кадр не опубликован.
+static esp_err_t capture_handler(httpd_req_t *req) {
+    FrameBroker& broker = FrameBroker::instance();
+    FrameSlot* frame = broker.acquireLatest(0);
+    if (!frame) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_type(req, "text/plain");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        return httpd_resp_send(req, "No frame available", HTTPD_RESP_USE_STRLEN);
+    }
+
+    char etag[16];
+    snprintf(etag, sizeof(etag), "\"%u\"", (unsigned)frame->seq);
+
+    char ifNoneMatch[16];
+    bool notModified = httpd_req_get_hdr_value_str(req, "If-None-Match", ifNoneMatch,
+                                                   sizeof(ifNoneMatch)) == ESP_OK &&
+                       strcmp(ifNoneMatch, etag) == 0;
+
+    // Значение заголовка должно жить до отправки ответа
+    char roi[32];
+    if (frame->roiWidth) {
+        snprintf(roi, sizeof(roi), "%u,%u,%u,%u", frame->roiX, frame->roiY,
+                 frame->roiWidth, frame->roiHeight);
+        httpd_resp_set_hdr(req, "X-ROI", roi);
+    }
+
+    char timestamp[24];
+    snprintf(timestamp, sizeof(timestamp), "%u.%06u", (unsigned)(frame->timestampUs / 1000000),
+             (unsigned)(frame->timestampUs % 1000000));
+    httpd_resp_set_hdr(req, "X-Timestamp", timestamp);
+
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "Access-Control-Expose-Headers", "ETag, X-ROI, X-Timestamp");
+
+    esp_err_t res;
+    if (notModified) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        res = httpd_resp_send(req, NULL, 0);
+    } else {
+        httpd_resp_set_type(req, "image/jpeg");
+        httpd_resp_set_hdr(req, "Content-Disposition", "inline; filename=capture.jpg");
+        res = httpd_resp_send(req, (const char*)frame->buf, frame->len);
+    }
+
+    // Слот держим до конца отправки, чтобы брокер не перезаписал его
+    broker.release(frame);
     return res;
 }
 
+static String u64ToString(uint64_t value) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%llu", (unsigned long long)value);
+    return String(buf);
+}
+
+// Гистограммы копируются и обходятся только здесь - пока статистику
+// никто не читает, конвейер платит лишь за инкремент корзины
+String getCameraStreamStatsJson() {
+    String json = "{\"clients\":[";
+    if (stream_clients_lock) {
+        const uint32_t now = millis();
+        bool first = true;
+        xSemaphoreTake(stream_clients_lock, portMAX_DELAY);
+        for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+            if (!stream_clients[i].active) {
+                continue;
+            }
+            // Согласованный снимок счетчиков, JSON строится уже по копии
+            portENTER_CRITICAL(&stream_stats_mux);
+            const StreamClient client = stream_clients[i];
+            portEXIT_CRITICAL(&stream_stats_mux);
+            const uint32_t uptimeMs = now - client.connectedMs;
+            if (!first) {
+                json += ",";
+            }
+            first = false;
+            json += "{";
+            json += "\"fd\":" + String(client.fd) + ",";
+            json += "\"transport\":\"" + String(client.websocket ? "ws" : "mjpeg") + "\",";
+            json += "\"fpsCap\":" + String(client.fpsCap) + ",";
+            json += "\"delivered\":" + String(client.stats.frames) + ",";
+            json += "\"dropped\":" + String(client.stats.dropped) + ",";
+            json += "\"dedup\":" + String(client.dedup ? "true" : "false") + ",";
+            json += "\"duplicates\":" + String(client.stats.duplicates) + ",";
+            json += "\"bytesSaved\":" + u64ToString(client.stats.bytesSaved) + ",";
+            json += "\"congested\":" + String(client.stats.congested) + ",";
+            json += "\"bytes\":" + u64ToString(client.stats.bytes) + ",";
+            json += "\"bytesPerSec\":" + String(uptimeMs ? (uint32_t)(client.stats.bytes * 1000 / uptimeMs) : 0) + ",";
+            json += "\"fps\":" + String(uptimeMs ? client.stats.frames * 1000.0f / uptimeMs : 0.0f, 1) + ",";
+            json += "\"uptimeMs\":" + String(uptimeMs) + ",";
+            client.stats.sendLatency.appendJson(json, "sendMs");
+            json += ",";
+            client.stats.frameAge.appendJson(json, "frameAgeMs");
+            json += "}";
+        }
+        xSemaphoreGive(stream_clients_lock);
+    }
+    json += "],";
+
+    LatencyHistogram dequeue, encode;
+    FrameBroker::instance().getPipelineLatency(dequeue, encode);
+    json += "\"pipeline\":{";
+    dequeue.appendJson(json, "captureToDequeueMs");
+    json += ",";
+    encode.appendJson(json, "encodeMs");
+    json += "},";
+
+    const FrameRoi roi = FrameBroker::instance().getRoi();
+    json += "\"roi\":{\"active\":" + String(roi.active ? "true" : "false");
+    if (roi.active) {
+        json += ",\"x\":" + String(roi.x) + ",\"y\":" + String(roi.y);
+        json += ",\"width\":" + String(roi.width) + ",\"height\":" + String(roi.height);
+        json += ",\"outWidth\":" + String(roi.outWidth) + ",\"outHeight\":" + String(roi.outHeight);
+    }
+    json += "},";
+
+    json += "\"maxClients\":" + String(STREAM_MAX_CLIENTS) + ",";
+    json += "\"sensorFps\":" + String(FrameBroker::instance().getSensorFps(), 1) + ",";
+    json += "\"latestSeq\":" + String(FrameBroker::instance().getLatestSeq()) + ",";
+    json += "\"brokerDropped\":" + String(FrameBroker::instance().getDroppedFrames()) + ",";
+    json += "\"captureFailures\":" + String(FrameBroker::instance().getCaptureFailures());
+    json += "}";
+    return json;
+}
+
 // Публичная функция для запуска камера-сервера
 void startCameraStreamServer() {
     Serial.println("Запуск камера-сервера...");
-    
+
+    if (!stream_clients_lock) {
+        stream_clients_lock = xSemaphoreCreateMutex();
+        for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+            stream_clients[i].sendLock = xSemaphoreCreateMutex();
+        }
+    }
+
+    // Единственный источник кадров для всех зрителей
+    if (!FrameBroker::instance().start()) {
+        Serial.println("Ошибка запуска брокера кадров!");
+        return;
+    }
+
     // Конфигурация httpd сервера
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = 81; // Используем порт 81 для камеры (AsyncWebServer на 80)
-    
+    config.close_fn = stream_close_fn;
+
     // Регистрация URI обработчика для стрима
     httpd_uri_t stream_uri = {
         .uri       = "/stream",
@@ -90,12 +702,45 @@ void startCameraStreamServer() {
         .handler   = stream_handler,
         .user_ctx  = NULL
     };
-    
+
+    httpd_uri_t capture_uri = {
+        .uri       = "/capture",
+        .method    = HTTP_GET,
+        .handler   = capture_handler,
+        .user_ctx  = NULL
+    };
+
+    httpd_uri_t time_uri = {
+        .uri       = "/time",
+        .method    = HTTP_GET,
+        .handler   = time_handler,
+        .user_ctx  = NULL
+    };
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    httpd_uri_t ws_stream_uri = {
+        .uri          = "/ws/stream",
+        .method       = HTTP_GET,
+        .handler      = ws_stream_handler,
+        .user_ctx     = NULL,
+        .is_websocket = true,
+        .handle_ws_control_frames = true
+    };
+#endif
+
     // Запуск HTTP сервера
     if (httpd_start(&camera_httpd, &config) == ESP_OK) {
         httpd_register_uri_handler(camera_httpd, &stream_uri);
+        httpd_register_uri_handler(camera_httpd, &capture_uri);
+        httpd_register_uri_handler(camera_httpd, &time_uri);
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+        httpd_register_uri_handler(camera_httpd, &ws_stream_uri);
+        Serial.println("WebSocket стрим: ws://[IP]:81/ws/stream");
+#endif
         Serial.println("Камера-сервер запущен на порту 81");
-        Serial.println("Стрим доступен: http://[IP]:81/stream");
+        Serial.println("Стрим доступен: http://[IP]:81/stream (параметры: ?fps=15&dedup=1)");
+        Serial.println("Снимок доступен: http://[IP]:81/capture");
+        Serial.println("Часы для измерения задержки: http://[IP]:81/time");
     } else {
         Serial.println("Ошибка запуска камера-сервера!");
     }
@@ -105,6 +750,7 @@ void stopCameraStreamServer() {
     if (camera_httpd) {
         httpd_stop(camera_httpd);
         camera_httpd = NULL;
+        FrameBroker::instance().stop();
         Serial.println("Камера-сервер остановлен");
     }
 }
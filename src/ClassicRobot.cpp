@@ -13,12 +13,10 @@ ClassicRobot::ClassicRobot() :
 #endif
 #if defined(FEATURE_NEOPIXEL) || defined(FEATURE_BUZZER)
     currentEffectMode_(EffectMode::NORMAL),
-    lastEffectUpdate_(0),
+    effectTicks_(0),
     effectState_(false),
 #endif
-    currentControlMode_(ControlMode::DIFFERENTIAL),
-    targetThrottlePWM_(1500),
-    targetSteeringPWM_(1500)
+    currentControlMode_(ControlMode::DIFFERENTIAL)
 {
     DEBUG_PRINTLN("Создание ClassicRobot");
 }
@@ -63,19 +61,20 @@ bool ClassicRobot::initSpecificComponents() {
     return true;
 }
 
-void ClassicRobot::updateSpecificComponents() {
-    // Обновление моторов
-    updateMotors();
+void ClassicRobot::scheduleSpecificComponents(ComponentScheduler& scheduler) {
+    // Команды из почтового ящика - на каждую новую команду (postMotorCommand)
+    commandTaskId_ = scheduler.add("commands", 0, MOTOR_UPDATE_DEADLINE_US, [this]() {
+        updateMotors();
+    });
+    // Контроллер моторов (watchdog работает по таймеру, здесь только журнал)
+    scheduler.add("motors", motorController_);
     
-    // Обновление эффектов
+    // Эффекты - 30 Гц
 #if defined(FEATURE_NEOPIXEL) || defined(FEATURE_BUZZER)
-    updateEffects();
+    scheduler.add("effects", EFFECT_UPDATE_PERIOD_US, EFFECT_UPDATE_DEADLINE_US, [this]() {
+        updateEffects();
+    });
 #endif
-    
-    // Обновление контроллера моторов
-    if (motorController_) {
-        motorController_->update();
-    }
 }
 
 void ClassicRobot::shutdownSpecificComponents() {
@@ -140,6 +139,7 @@ bool ClassicRobot::initMotors() {
     if (wifiSettings_) {
         static_cast<MX1508MotorController*>(motorController_)->setWiFiSettings(wifiSettings_);
     }
+    static_cast<MX1508MotorController*>(motorController_)->setBlackBox(blackBox_);
     
     DEBUG_PRINTLN("Моторы инициализированы");
     return true;
@@ -188,45 +188,36 @@ void ClassicRobot::updateMotors() {
         return;
     }
     
-    // Применяем значения PWM только если они изменились или если сработал watchdog
-    static int lastAppliedThrottle = 1500;
-    static int lastAppliedSteering = 1500;
-    
-    // Если watchdog остановил моторы, сбрасываем целевые значения в нейтральное положение
-    // чтобы предотвратить повторное применение старых команд движения
-    if (motorController_->wasWatchdogTriggered()) {
-        targetThrottlePWM_ = 1500;
-        targetSteeringPWM_ = 1500;
-    }
-    
-    if (targetThrottlePWM_ != lastAppliedThrottle || targetSteeringPWM_ != lastAppliedSteering) {
-        motorController_->setMotorPWM(targetThrottlePWM_, targetSteeringPWM_);
-        lastAppliedThrottle = targetThrottlePWM_;
-        lastAppliedSteering = targetSteeringPWM_;
+    // Применяем только новую команду из почтового ящика. Новизна определяется
+    // по seq, а не по значениям: повтор той же команды после остановки по
+    // watchdog тоже применяется, а уже примененная не повторяется.
+    // Команда, полученная до срабатывания watchdog, но забранная после него,
+    // отбрасывается: новая команда сбрасывает флаг до записи в ящик
+    int throttlePWM, steeringPWM;
+    if (commandMailbox_.take(throttlePWM, steeringPWM) && !motorController_->wasWatchdogTriggered()) {
+        motorController_->setMotorPWM(throttlePWM, steeringPWM);
     }
 }
 
 void ClassicRobot::handleMotorCommand(int throttlePWM, int steeringPWM) {
-    // Обновляем целевые значения PWM (быстро, без блокировки)
-    targetThrottlePWM_ = constrain(throttlePWM, 1000, 2000);
-    targetSteeringPWM_ = constrain(steeringPWM, 1000, 2000);
-    
-    // ВАЖНО: Обновляем timestamp СРАЗУ при получении команды
-    // Это предотвращает срабатывание watchdog когда команды приходят с одинаковыми значениями
+    // ВАЖНО: Обновляем timestamp СРАЗУ при получении команды и ДО записи в ящик:
+    // цикл управления просыпается от post() и не должен увидеть старое время watchdog
     if (motorController_) {
         motorController_->updateCommandTime();
     }
+    
+    // Кладем команду в почтовый ящик (без блокировки), цикл управления проснется
+    postMotorCommand(throttlePWM, steeringPWM);
 }
 
 void ClassicRobot::updateEffects() {
 #if defined(FEATURE_NEOPIXEL) || defined(FEATURE_BUZZER)
-    unsigned long now = millis();
-    
-    // Обновление эффектов с определенной частотой
-    if (now - lastEffectUpdate_ < 100) {
-        return; // Пока рано обновлять
+    // Планировщик вызывает 30 раз в секунду: анимация движения обновляется
+    // каждый раз, мигающие эффекты переключаются раз в EFFECT_BLINK_TICKS
+    effectTicks_++;
+    if (currentEffectMode_ != EffectMode::NORMAL && effectTicks_ % EFFECT_BLINK_TICKS != 0) {
+        return;
     }
-    lastEffectUpdate_ = now;
     
     switch (currentEffectMode_) {
         case EffectMode::POLICE:
@@ -255,8 +246,7 @@ void ClassicRobot::handleCommand(AsyncWebServerRequest* request) {
         int throttle = request->getParam("throttle")->value().toInt();
         int steering = request->getParam("steering")->value().toInt();
         
-        targetThrottlePWM_ = constrain(throttle, 1000, 2000);
-        targetSteeringPWM_ = constrain(steering, 1000, 2000);
+        postMotorCommand(throttle, steering);
         
         request->send(200, "text/plain", "OK");
     } else if (request->hasParam("effect")) {
@@ -0,0 +1,103 @@
+#include "CommandTrace.h"
+
+CommandTrace::PostedSlot CommandTrace::posted_[CommandTrace::kPostedSlots];
+
+bool CommandTrace::active_ = false;
+uint32_t CommandTrace::activePostedUs_ = 0;
+uint32_t CommandTrace::activeTakenUs_ = 0;
+uint16_t CommandTrace::lastTakenSeq_ = CommandTrace::kNoSeq;
+
+portMUX_TYPE CommandTrace::mux_ = portMUX_INITIALIZER_UNLOCKED;
+LatencyHistogram CommandTrace::handle_;
+LatencyHistogram CommandTrace::mailbox_;
+LatencyHistogram CommandTrace::apply_;
+LatencyHistogram CommandTrace::total_;
+uint32_t CommandTrace::superseded_ = 0;
+
+void CommandTrace::handled(uint32_t arrivalUs) {
+    const uint32_t elapsedUs = now() - arrivalUs;
+    portENTER_CRITICAL(&mux_);
+    handle_.record(elapsedUs);
+    portEXIT_CRITICAL(&mux_);
+}
+
+void CommandTrace::posted(uint16_t seq) {
+    PostedSlot& slot = posted_[seq & (kPostedSlots - 1)];
+    slot.seq.store(kNoSeq, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.postedUs = now();
+    slot.seq.store(seq, std::memory_order_release);
+}
+
+void CommandTrace::taken(uint16_t seq) {
+    const uint32_t takenUs = now();
+
+    // Слот действителен, если seq не менялся во время чтения времени
+    const PostedSlot& slot = posted_[seq & (kPostedSlots - 1)];
+    const uint16_t before = slot.seq.load(std::memory_order_acquire);
+    const uint32_t postedUs = slot.postedUs;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint16_t after = slot.seq.load(std::memory_order_relaxed);
+
+    // Пропуск в seq - команды, перезаписанные до выборки (seq 12-битный)
+    const uint32_t gap = lastTakenSeq_ == kNoSeq ? 1 : ((seq - lastTakenSeq_) & 0xFFF);
+    lastTakenSeq_ = seq;
+
+    active_ = before == seq && after == seq;
+    activePostedUs_ = postedUs;
+    activeTakenUs_ = takenUs;
+
+    portENTER_CRITICAL(&mux_);
+    if (gap > 1) {
+        superseded_ += gap - 1;
+    }
+    if (active_) {
+        mailbox_.record(takenUs - postedUs);
+    }
+    portEXIT_CRITICAL(&mux_);
+}
+
+void CommandTrace::applied() {
+    if (!active_) {
+        return;
+    }
+    active_ = false;
+
+    const uint32_t appliedUs = now();
+    portENTER_CRITICAL(&mux_);
+    apply_.record(appliedUs - activeTakenUs_);
+    total_.record(appliedUs - activePostedUs_);
+    portEXIT_CRITICAL(&mux_);
+}
+
+String CommandTrace::getStatsJson() {
+    // Копии под блокировкой, строка собирается без нее
+    portENTER_CRITICAL(&mux_);
+    const LatencyHistogram handle = handle_;
+    const LatencyHistogram mailbox = mailbox_;
+    const LatencyHistogram apply = apply_;
+    const LatencyHistogram total = total_;
+    const uint32_t superseded = superseded_;
+    portEXIT_CRITICAL(&mux_);
+
+    String json = "{\"stages\":{";
+    handle.appendJson(json, "handle");
+    json += ",";
+    mailbox.appendJson(json, "mailbox");
+    json += ",";
+    apply.appendJson(json, "apply");
+    json += ",";
+    total.appendJson(json, "total");
+    json += "},\"superseded\":" + String(superseded) + "}";
+    return json;
+}
+
+void CommandTrace::reset() {
+    portENTER_CRITICAL(&mux_);
+    handle_.reset();
+    mailbox_.reset();
+    apply_.reset();
+    total_.reset();
+    superseded_ = 0;
+    portEXIT_CRITICAL(&mux_);
+}
@@ -0,0 +1,156 @@
+#include "ComponentScheduler.h"
+
+ComponentScheduler::ComponentScheduler(Clock clock) :
+    clock_(clock),
+    taskCount_(0),
+    waker_(nullptr),
+    wakerContext_(nullptr)
+{
+}
+
+void ComponentScheduler::attachWaker(Waker waker, void* context) {
+    wakerContext_ = context;
+    waker_ = waker;
+}
+
+int ComponentScheduler::add(const char* name, uint32_t periodUs, uint32_t deadlineUs, Callback callback) {
+    if (taskCount_ >= kMaxTasks || !callback) {
+        return -1;
+    }
+
+    Task& task = tasks_[taskCount_];
+    task.callback = callback;
+    task.nextDueUs = clock_();
+    task.triggeredUs.store(0);
+    task.stats.name = name;
+    task.stats.periodUs = periodUs;
+    task.stats.deadlineUs = deadlineUs;
+    task.stats.runs = 0;
+    task.stats.overruns = 0;
+    task.stats.skipped = 0;
+    task.stats.maxRunUs = 0;
+    task.stats.totalRunUs = 0;
+    task.stats.lateness.reset();
+    return taskCount_++;
+}
+
+int ComponentScheduler::add(const char* name, IComponent* component) {
+    if (!component) {
+        return -1;
+    }
+    return add(name, component->getUpdatePeriodUs(), component->getUpdateDeadlineUs(),
+               [component]() { component->update(); });
+}
+
+void ComponentScheduler::trigger(int id) {
+    if (id < 0 || id >= taskCount_) {
+        return;
+    }
+    Task& task = tasks_[id];
+    // Время первого trigger() до запуска: опоздание считается от него.
+    // Уже ожидающий запуск не трогаем; 0 означает "нет запроса"
+    const uint32_t nowUs = clock_();
+    uint32_t idle = 0;
+    task.triggeredUs.compare_exchange_strong(idle, nowUs ? nowUs : 1, std::memory_order_acq_rel);
+
+    if (waker_) {
+        waker_(wakerContext_);
+    }
+}
+
+uint32_t ComponentScheduler::runDue(uint32_t maxSleepUs) {
+    for (int i = 0; i < taskCount_; i++) {
+        Task& task = tasks_[i];
+        const uint32_t period = task.stats.periodUs;
+        uint32_t now = clock_();
+        uint32_t dueUs;
+
+        if (period == 0) {
+            // Забрать запрос одним обменом: trigger() после него - новый запуск
+            dueUs = task.triggeredUs.exchange(0, std::memory_order_acq_rel);
+            if (dueUs == 0) {
+                continue;
+            }
+            // trigger() мог прийти после чтения часов
+            now = clock_();
+        } else {
+            if ((int32_t)(now - task.nextDueUs) < 0) {
+                continue;
+            }
+            dueUs = task.nextDueUs;
+        }
+
+        const uint32_t latenessUs = (int32_t)(now - dueUs) > 0 ? now - dueUs : 0;
+        task.callback();
+        const uint32_t endUs = clock_();
+        const uint32_t runUs = endUs - now;
+
+        // Следующий срок - по сетке периода, а не от конца выполнения,
+        // иначе опоздания накапливаются. Если старт опоздал на целый период
+        // и больше, пропущенные сроки не догоняем
+        uint32_t skipped = 0;
+        if (period > 0) {
+            task.nextDueUs += period;
+            if ((int32_t)(now - task.nextDueUs) >= 0) {
+                skipped = (now - task.nextDueUs) / period + 1;
+                task.nextDueUs += skipped * period;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(statsLock_);
+        TaskStats& stats = task.stats;
+        stats.runs++;
+        stats.totalRunUs += runUs;
+        if (runUs > stats.maxRunUs) {
+            stats.maxRunUs = runUs;
+        }
+        if (stats.deadlineUs > 0 && runUs > stats.deadlineUs) {
+            stats.overruns++;
+        }
+        stats.skipped += skipped;
+        stats.lateness.record(latenessUs);
+    }
+
+    // Время до ближайшего срока
+    const uint32_t now = clock_();
+    uint32_t sleepUs = maxSleepUs;
+    for (int i = 0; i < taskCount_; i++) {
+        const Task& task = tasks_[i];
+        if (task.stats.periodUs == 0) {
+            if (task.triggeredUs.load(std::memory_order_acquire) != 0) {
+                return 0;
+            }
+            continue;
+        }
+        int32_t untilDue = (int32_t)(task.nextDueUs - now);
+        if (untilDue <= 0) {
+            return 0;
+        }
+        if ((uint32_t)untilDue < sleepUs) {
+            sleepUs = untilDue;
+        }
+    }
+    return sleepUs;
+}
+
+bool ComponentScheduler::getStats(int id, TaskStats& stats) const {
+    if (id < 0 || id >= taskCount_) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(statsLock_);
+    stats = tasks_[id].stats;
+    return true;
+}
+
+void ComponentScheduler::resetStats() {
+    std::lock_guard<std::mutex> lock(statsLock_);
+    for (int i = 0; i < taskCount_; i++) {
+        TaskStats& stats = tasks_[i].stats;
+        stats.runs = 0;
+        stats.overruns = 0;
+        stats.skipped = 0;
+        stats.maxRunUs = 0;
+        stats.totalRunUs = 0;
+        stats.lateness.reset();
+    }
+}
@@ -0,0 +1,77 @@
+#include "ControlSequencer.h"
+#include "ControlPacket.h"
+
+ControlSequencer::ControlSequencer(uint32_t maxAgeMs, uint32_t sessionTimeoutMs,
+                                   uint32_t baselineWindowMs) :
+    maxAgeMs_(maxAgeMs),
+    sessionTimeoutMs_(sessionTimeoutMs),
+    baselineWindowMs_(baselineWindowMs)
+{
+    reset();
+}
+
+void ControlSequencer::reset() {
+    active_ = false;
+    lastSeq_ = 0;
+    lastPacketMs_ = 0;
+    lastAgeMs_ = 0;
+    windowMinMs_ = 0;
+    prevWindowMinMs_ = 0;
+    windowStartMs_ = 0;
+    stats_ = Stats();
+}
+
+ControlSequencer::Verdict ControlSequencer::accept(uint32_t seq, uint32_t clientTimeMs, uint32_t nowMs) {
+    stats_.received++;
+    const int32_t deltaMs = (int32_t)(nowMs - clientTimeMs);
+
+    // Первый пакет или долгая пауза: клиент мог перезапуститься с новыми
+    // seq и часами, начинаем сессию заново
+    if (!active_ || nowMs - lastPacketMs_ > sessionTimeoutMs_) {
+        if (active_) {
+            stats_.resets++;
+        }
+        active_ = true;
+        lastSeq_ = seq - 1;
+        windowMinMs_ = deltaMs;
+        prevWindowMinMs_ = deltaMs;
+        windowStartMs_ = nowMs;
+    }
+    lastPacketMs_ = nowMs;
+
+    // Окна учитывают и отброшенные пакеты: при стойком росте задержки
+    // опорный минимум догоняет ее за два окна
+    if (nowMs - windowStartMs_ >= baselineWindowMs_) {
+        prevWindowMinMs_ = windowMinMs_;
+        windowMinMs_ = deltaMs;
+        windowStartMs_ = nowMs;
+    } else if (deltaMs < windowMinMs_) {
+        windowMinMs_ = deltaMs;
+    }
+    const int32_t baselineMs = windowMinMs_ < prevWindowMinMs_ ? windowMinMs_ : prevWindowMinMs_;
+    lastAgeMs_ = (uint32_t)(deltaMs - baselineMs);
+
+    if (seq == lastSeq_) {
+        stats_.duplicates++;
+        return DUPLICATE;
+    }
+    if (!controlSeqIsNewer(seq, lastSeq_)) {
+        // Пакет не потерян, а опоздал: он уже посчитан в пропусках
+        stats_.reordered++;
+        if (stats_.lost > 0) {
+            stats_.lost--;
+        }
+        return REORDERED;
+    }
+
+    stats_.lost += seq - lastSeq_ - 1;
+    // seq двигается и для устаревшего пакета: все более ранние еще старше
+    lastSeq_ = seq;
+
+    if (lastAgeMs_ > maxAgeMs_) {
+        stats_.stale++;
+        return STALE;
+    }
+    stats_.accepted++;
+    return ACCEPTED;
+}
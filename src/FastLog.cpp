@@ -0,0 +1,212 @@
+#include "FastLog.h"
+#include <esp_timer.h>
+
+// ═══════════════════════════════════════════════════════════════
+// КОЛЬЦО ЗАПИСЕЙ
+// ═══════════════════════════════════════════════════════════════
+// Номер слота хранится за вычетом индекса слота k, чтобы нулевая статическая
+// инициализация уже была корректной (журнал доступен до setup()):
+//   pos - k      - слот свободен для записи pos
+//   pos + 1 - k  - запись pos готова
+// Писатель занимает позицию CAS по head_, читатель (одна задача) идет по tail_.
+
+static_assert((FAST_LOG_CAPACITY & (FAST_LOG_CAPACITY - 1)) == 0,
+              "FAST_LOG_CAPACITY должен быть степенью двойки");
+
+struct FastLogSlot {
+    std::atomic<uint32_t> seq;
+    FastLogRecord record;
+};
+
+static FastLogSlot slots_[FAST_LOG_CAPACITY];
+static std::atomic<uint32_t> head_(0);
+static uint32_t tail_ = 0;
+
+std::atomic<uint32_t> FastLog::written_(0);
+std::atomic<uint32_t> FastLog::dropped_(0);
+
+void FastLog::push(const char* format, const uint32_t* args, uint32_t argCount) {
+    uint32_t pos = head_.load(std::memory_order_relaxed);
+    uint32_t index;
+    FastLogSlot* slot;
+    for (;;) {
+        index = pos & (FAST_LOG_CAPACITY - 1);
+        slot = &slots_[index];
+        int32_t diff = (int32_t)(slot->seq.load(std::memory_order_acquire) + index - pos);
+        if (diff == 0) {
+            if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Кольцо полно: читатель не успевает, запись теряется
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->record.format = format;
+    slot->record.timestampUs = (uint32_t)esp_timer_get_time();
+    slot->record.argCount = argCount;
+    memcpy(slot->record.args, args, argCount * sizeof(uint32_t));
+    slot->seq.store(pos + 1 - index, std::memory_order_release);
+    written_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool FastLog::pop(FastLogRecord& record) {
+    uint32_t index = tail_ & (FAST_LOG_CAPACITY - 1);
+    FastLogSlot* slot = &slots_[index];
+    if (slot->seq.load(std::memory_order_acquire) != tail_ + 1 - index) {
+        return false;
+    }
+    record = slot->record;
+    slot->seq.store(tail_ + FAST_LOG_CAPACITY - index, std::memory_order_release);
+    tail_++;
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// ТЕКСТ ЗАПИСИ
+// ═══════════════════════════════════════════════════════════════
+// Каждый спецификатор формата печатается отдельным snprintf с аргументом
+// нужного типа. Модификаторы длины (l, h, z) отбрасываются: все аргументы
+// уже 32-битные.
+
+size_t FastLog::format(const FastLogRecord& record, char* out, size_t outSize) {
+    if (outSize == 0) {
+        return 0;
+    }
+
+    size_t len = 0;
+    uint32_t argIndex = 0;
+    const char* p = record.format;
+
+    while (*p && len + 1 < outSize) {
+        if (*p != '%') {
+            out[len++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[len++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // Спецификатор: флаги, ширина, точность - копируем, длину отбрасываем
+        char spec[16];
+        size_t specLen = 0;
+        spec[specLen++] = *p++;
+        while (*p && strchr("-+ #0123456789.lhzjt", *p)) {
+            if (!strchr("lhzjt", *p) && specLen < sizeof(spec) - 2) {
+                spec[specLen++] = *p;
+            }
+            p++;
+        }
+        if (!*p) {
+            break;
+        }
+        char conv = *p++;
+        spec[specLen++] = conv;
+        spec[specLen] = '\0';
+
+        uint32_t word = argIndex < record.argCount ? record.args[argIndex] : 0;
+        argIndex++;
+
+        int n;
+        switch (conv) {
+            case 'd':
+            case 'i':
+                n = snprintf(out + len, outSize - len, spec, (int)word);
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G': {
+                float f;
+                memcpy(&f, &word, sizeof(f));
+                n = snprintf(out + len, outSize - len, spec, (double)f);
+                break;
+            }
+            case 's':
+                n = snprintf(out + len, outSize - len, spec,
+                             word ? (const char*)(uintptr_t)word : "(null)");
+                break;
+            case 'p':
+                n = snprintf(out + len, outSize - len, "0x%08x", (unsigned)word);
+                break;
+            default:    // u, x, X, o, c
+                n = snprintf(out + len, outSize - len, spec, (unsigned)word);
+                break;
+        }
+        if (n < 0) {
+            break;
+        }
+        len += (size_t)n < outSize - len ? (size_t)n : outSize - len - 1;
+    }
+
+    // Одна запись - одна строка: перевод строки из формата не нужен
+    while (len > 0 && (out[len - 1] == '\n' || out[len - 1] == '\r')) {
+        len--;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// ЗАДАЧА ВЫГРУЗКИ
+// ═══════════════════════════════════════════════════════════════
+
+bool FastLog::begin() {
+    BaseType_t res = xTaskCreatePinnedToCore(drainTask, "fastlog", FAST_LOG_TASK_STACK, nullptr,
+                                             FAST_LOG_TASK_PRIORITY, nullptr, 0);
+    if (res != pdPASS) {
+        Serial.println("ОШИБКА: Задача журнала не создана, FAST_LOG не выводится");
+        return false;
+    }
+    return true;
+}
+
+void FastLog::output(const FastLogRecord& record) {
+#ifdef FAST_LOG_BINARY_OUTPUT
+    // Кадр: 0xFF 0xA5 (в UTF-8 тексте 0xFF не встречается), число аргументов,
+    // адрес формата, время, аргументы - little-endian, как в памяти ESP32
+    uint8_t frame[3 + 8 + FAST_LOG_MAX_ARGS * 4];
+    frame[0] = 0xFF;
+    frame[1] = 0xA5;
+    frame[2] = (uint8_t)record.argCount;
+    uint32_t formatAddr = (uint32_t)(uintptr_t)record.format;
+    memcpy(frame + 3, &formatAddr, 4);
+    memcpy(frame + 7, &record.timestampUs, 4);
+    memcpy(frame + 11, record.args, record.argCount * 4);
+    Serial.write(frame, 11 + record.argCount * 4);
+#else
+    char line[160];
+    int prefix = snprintf(line, sizeof(line), "[%u.%03u] ",
+                          record.timestampUs / 1000000, (record.timestampUs / 1000) % 1000);
+    format(record, line + prefix, sizeof(line) - prefix);
+    Serial.println(line);
+#endif
+}
+
+void FastLog::drainTask(void* param) {
+    uint32_t reportedDropped = 0;
+    FastLogRecord record;
+
+    for (;;) {
+        while (pop(record)) {
+            output(record);
+        }
+
+        uint32_t dropped = getDropped();
+        if (dropped != reportedDropped) {
+            Serial.printf("[FastLog] потеряно записей: %u (кольцо %d)\n",
+                          dropped - reportedDropped, FAST_LOG_CAPACITY);
+            reportedDropped = dropped;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(FAST_LOG_DRAIN_INTERVAL_MS));
+    }
+}
@@ -0,0 +1,540 @@
+#include "FrameBroker.h"
+#include "BlackBoxRecorder.h"
+
+#ifdef FEATURE_CAMERA
+
+#include "esp_camera.h"
+#include "img_converters.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+FrameBroker& FrameBroker::instance() {
+    static FrameBroker broker;
+    return broker;
+}
+
+FrameBroker::FrameBroker() :
+    subscribersLock_(nullptr),
+    captureTask_(nullptr),
+    sensorLock_(xSemaphoreCreateMutex()),
+    mux_(portMUX_INITIALIZER_UNLOCKED),
+    grayEncoder_(STREAM_GRAY_JPEG_QUALITY),
+    roiPending_(false),
+    frameSize_(FRAMESIZE_QVGA),
+    roiSettleFrames_(0),
+    sceneJpgLen_(0),
+    sceneSeq_(0),
+    running_(false),
+    captureFailures_(0),
+    droppedFrames_(0),
+    sensorFps_(0.0f),
+    blackBox_(nullptr),
+    lastBlackBoxFrameMs_(0)
+{
+    memset(&roiRequested_, 0, sizeof(roiRequested_));
+    memset(&roiApplied_, 0, sizeof(roiApplied_));
+    memset(sceneGrid_, 0, sizeof(sceneGrid_));
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        subscribers_[i] = nullptr;
+    }
+}
+
+bool FrameBroker::start() {
+    if (captureTask_) {
+        return true;
+    }
+
+    if (!subscribersLock_) {
+        subscribersLock_ = xSemaphoreCreateMutex();
+    }
+
+    if (!allocateRing()) {
+        DEBUG_PRINTLN("ОШИБКА: Не удалось выделить память под кольцо кадров");
+        return false;
+    }
+
+    // Качество регулируется только для JPEG сенсора (у Liner кадр ЧБ)
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (!sensor || sensor->pixformat != PIXFORMAT_JPEG) {
+        quality_.setEnabled(false);
+    }
+    if (sensor) {
+        frameSize_ = sensor->status.framesize;
+    }
+
+    running_ = true;
+    // Захват на ядре приложения: WiFi/lwIP работают на ядре 0 и не
+    // задерживают выборку кадров из DMA драйвера камеры
+    BaseType_t created = xTaskCreatePinnedToCore(captureTaskEntry, "cam_capture",
+                                                 CAMERA_CAPTURE_TASK_STACK, this,
+                                                 CAMERA_CAPTURE_TASK_PRIORITY, &captureTask_,
+                                                 CAMERA_CAPTURE_TASK_CORE);
+    if (created != pdPASS) {
+        running_ = false;
+        captureTask_ = nullptr;
+        DEBUG_PRINTLN("ОШИБКА: Не удалось создать задачу захвата кадров");
+        return false;
+    }
+
+    DEBUG_PRINTLN("Брокер кадров запущен");
+    return true;
+}
+
+void FrameBroker::stop() {
+    if (!captureTask_) {
+        return;
+    }
+
+    running_ = false;
+    xTaskNotifyGive(captureTask_);
+
+    // Ждем, пока задача захвата вернет текущий кадр драйверу и завершится
+    for (int i = 0; i < 100 && captureTask_; i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    DEBUG_PRINTLN("Брокер кадров остановлен");
+}
+
+int FrameBroker::subscribe(TaskHandle_t task) {
+    int id = -1;
+    xSemaphoreTake(subscribersLock_, portMAX_DELAY);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (subscribers_[i] == nullptr) {
+            subscribers_[i] = task;
+            id = i;
+            break;
+        }
+    }
+    xSemaphoreGive(subscribersLock_);
+
+    // Будим задачу захвата: она простаивает, пока нет подписчиков
+    if (id >= 0 && captureTask_) {
+        xTaskNotifyGive(captureTask_);
+    }
+    return id;
+}
+
+void FrameBroker::unsubscribe(int id) {
+    if (id < 0 || id >= STREAM_MAX_CLIENTS) {
+        return;
+    }
+    // После выхода отписавшаяся задача может быть удалена: notifySubscribers
+    // будит задачи под той же блокировкой
+    xSemaphoreTake(subscribersLock_, portMAX_DELAY);
+    subscribers_[id] = nullptr;
+    xSemaphoreGive(subscribersLock_);
+}
+
+int FrameBroker::getSubscriberCount() const {
+    int count = 0;
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (subscribers_[i] != nullptr) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool FrameBroker::allocateRing() {
+    if (ring_.slotAt(0).buf) {
+        return true; // Кольцо выделяется один раз и живет до перезагрузки
+    }
+
+    const bool usePsram = psramFound();
+    const size_t capacity = usePsram ? FRAME_SLOT_CAPACITY_PSRAM : FRAME_SLOT_CAPACITY_DRAM;
+    const uint32_t caps = usePsram ? (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) : MALLOC_CAP_8BIT;
+
+    for (int i = 0; i < FrameRing::kSize; i++) {
+        uint8_t* buf = (uint8_t*)heap_caps_malloc(capacity, caps);
+        if (!buf) {
+            for (int j = 0; j < i; j++) {
+                heap_caps_free(ring_.slotAt(j).buf);
+                ring_.attachBuffer(j, nullptr, 0);
+            }
+            return false;
+        }
+        ring_.attachBuffer(i, buf, capacity);
+    }
+
+    DEBUG_PRINTF("Кольцо кадров: %d слотов по %u байт (%s)\n",
+                 FRAME_RING_SIZE, (unsigned)capacity, usePsram ? "PSRAM" : "DRAM");
+    return true;
+}
+
+void FrameBroker::publish(FrameSlot* slot, bool sceneChanged) {
+    slot->seq = ring_.getLatestSeq() + 1;
+    if (sceneChanged || sceneSeq_ == 0) {
+        sceneSeq_ = slot->seq;
+    }
+    slot->sceneSeq = sceneSeq_;
+
+    ring_.publish(slot);
+    notifySubscribers();
+}
+
+void FrameBroker::notifySubscribers() {
+    xSemaphoreTake(subscribersLock_, portMAX_DELAY);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (subscribers_[i]) {
+            xTaskNotifyGive(subscribers_[i]);
+        }
+    }
+    xSemaphoreGive(subscribersLock_);
+}
+
+void FrameBroker::reportFrameSent(uint32_t sendUs, uint32_t jpegBytes) {
+    portENTER_CRITICAL(&mux_);
+    quality_.onFrameSent(sendUs, jpegBytes);
+    portEXIT_CRITICAL(&mux_);
+}
+
+bool FrameBroker::setAdaptiveQuality(bool enabled) {
+    // Ступени меняют размер кадра: у ЧБ Liner размер буфера и разбор линии
+    // завязаны на фиксированный кадр, поэтому включение только для JPEG (как окно)
+    if (enabled) {
+        sensor_t* sensor = esp_camera_sensor_get();
+        if (!sensor || sensor->pixformat != PIXFORMAT_JPEG) {
+            return false;
+        }
+    }
+
+    portENTER_CRITICAL(&mux_);
+    quality_.setEnabled(enabled);
+    portEXIT_CRITICAL(&mux_);
+    return true;
+}
+
+void FrameBroker::setTargetLatencyMs(uint32_t targetMs) {
+    portENTER_CRITICAL(&mux_);
+    quality_.setTargetLatencyMs(targetMs);
+    portEXIT_CRITICAL(&mux_);
+}
+
+StreamQualityController FrameBroker::getQualitySnapshot() const {
+    portENTER_CRITICAL(&mux_);
+    StreamQualityController snapshot = quality_;
+    portEXIT_CRITICAL(&mux_);
+    return snapshot;
+}
+
+void FrameBroker::getPipelineLatency(LatencyHistogram& dequeue, LatencyHistogram& encode) const {
+    portENTER_CRITICAL(&mux_);
+    dequeue = dequeueLatency_;
+    encode = encodeLatency_;
+    portEXIT_CRITICAL(&mux_);
+}
+
+// Дешевая сигнатура кадра: сравнение идет с опорным кадром сцены, а не с
+// предыдущим, чтобы медленный дрейф не накапливался незамеченным.
+// ЧБ кадр - сетка выборки яркости; JPEG - размер (шум сенсора меняет байты,
+// но почти не меняет размер, а движение в кадре его меняет).
+bool FrameBroker::detectSceneChange(pixformat_t format, const uint8_t* pixels,
+                                    uint16_t width, uint16_t height, size_t jpgLen) {
+    if (format == PIXFORMAT_GRAYSCALE) {
+        uint8_t grid[kSignatureCols * kSignatureRows];
+        uint32_t diffSum = 0;
+        for (int row = 0; row < kSignatureRows; row++) {
+            const uint8_t* line = pixels + (size_t)((2 * row + 1) * height / (2 * kSignatureRows)) * width;
+            for (int col = 0; col < kSignatureCols; col++) {
+                const int i = row * kSignatureCols + col;
+                grid[i] = line[(2 * col + 1) * width / (2 * kSignatureCols)];
+                diffSum += abs((int)grid[i] - (int)sceneGrid_[i]);
+            }
+        }
+        const bool changed = sceneSeq_ == 0 ||
+                             diffSum > (uint32_t)STREAM_DEDUP_PIXEL_THRESHOLD * sizeof(grid);
+        if (changed) {
+            memcpy(sceneGrid_, grid, sizeof(grid));
+        }
+        return changed;
+    }
+
+    const size_t delta = jpgLen > sceneJpgLen_ ? jpgLen - sceneJpgLen_ : sceneJpgLen_ - jpgLen;
+    const bool changed = sceneSeq_ == 0 || delta * 100 > sceneJpgLen_ * STREAM_DEDUP_SIZE_TOLERANCE_PCT;
+    if (changed) {
+        sceneJpgLen_ = jpgLen;
+    }
+    return changed;
+}
+
+static framesize_t frameSizeForWidth(uint16_t width) {
+    switch (width) {
+        case 160: return FRAMESIZE_QQVGA;
+        case 240: return FRAMESIZE_HQVGA;
+        default:  return FRAMESIZE_QVGA;
+    }
+}
+
+void FrameBroker::updateQuality() {
+    portENTER_CRITICAL(&mux_);
+    bool changed = quality_.evaluate(millis());
+    StreamQualityController::OperatingPoint point = quality_.getOperatingPoint();
+    int level = quality_.getLevel();
+    portEXIT_CRITICAL(&mux_);
+
+    if (!changed) {
+        return;
+    }
+
+    // Меняем параметры сенсора между кадрами, из задачи захвата.
+    // При окне сенсора размер кадра задает окно, новый размер применится при его снятии
+    frameSize_ = frameSizeForWidth(point.width);
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (sensor) {
+        lockSensor();
+        if (!roiApplied_.active) {
+            sensor->set_framesize(sensor, frameSize_);
+        }
+        sensor->set_quality(sensor, point.quality);
+        unlockSensor();
+        DEBUG_PRINTF("Качество стрима: ступень %d, %ux%u q=%u\n",
+                     level, point.width, point.height, point.quality);
+    }
+}
+
+bool FrameBroker::setRoi(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+    // Окно через set_res_raw поддерживается только для JPEG: у ЧБ Liner
+    // размер буфера и разбор линии завязаны на полный кадр
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (!sensor || sensor->pixformat != PIXFORMAT_JPEG || !sensor->set_res_raw) {
+        return false;
+    }
+
+    // Регистры окна OV2640 задаются в единицах по 4 пикселя
+    FrameRoi roi;
+    roi.active = true;
+    roi.x = min<uint16_t>(x, CAMERA_ROI_SENSOR_WIDTH - 64) & ~3;
+    roi.y = min<uint16_t>(y, CAMERA_ROI_SENSOR_HEIGHT - 32) & ~3;
+    roi.width = constrain(width, 64, CAMERA_ROI_SENSOR_WIDTH - roi.x) & ~3;
+    roi.height = constrain(height, 32, CAMERA_ROI_SENSOR_HEIGHT - roi.y) & ~3;
+
+    // Выход 1:1 (полное разрешение сенсора), пока окно влезает в буфер кадра;
+    // иначе DSP уменьшает окно с сохранением пропорций
+    uint32_t outWidth = roi.width;
+    uint32_t outHeight = roi.height;
+    if (outWidth > CAMERA_ROI_MAX_OUTPUT_WIDTH) {
+        outHeight = outHeight * CAMERA_ROI_MAX_OUTPUT_WIDTH / outWidth;
+        outWidth = CAMERA_ROI_MAX_OUTPUT_WIDTH;
+    }
+    if (outHeight > CAMERA_ROI_MAX_OUTPUT_HEIGHT) {
+        outWidth = outWidth * CAMERA_ROI_MAX_OUTPUT_HEIGHT / outHeight;
+        outHeight = CAMERA_ROI_MAX_OUTPUT_HEIGHT;
+    }
+    // Кратно блокам JPEG (MCU 16x8 для YUV422)
+    roi.outWidth = max<uint32_t>(outWidth & ~15, 16);
+    roi.outHeight = max<uint32_t>(outHeight & ~7, 8);
+
+    portENTER_CRITICAL(&mux_);
+    roiRequested_ = roi;
+    roiPending_ = true;
+    portEXIT_CRITICAL(&mux_);
+    return true;
+}
+
+void FrameBroker::clearRoi() {
+    portENTER_CRITICAL(&mux_);
+    roiRequested_.active = false;
+    roiPending_ = true;
+    portEXIT_CRITICAL(&mux_);
+}
+
+FrameRoi FrameBroker::getRoi() const {
+    portENTER_CRITICAL(&mux_);
+    FrameRoi roi = roiRequested_;
+    portEXIT_CRITICAL(&mux_);
+    return roi;
+}
+
+// Применить запрошенное окно сенсора (из задачи захвата, между кадрами)
+bool FrameBroker::applyRoi() {
+    portENTER_CRITICAL(&mux_);
+    const bool pending = roiPending_;
+    const FrameRoi roi = roiRequested_;
+    roiPending_ = false;
+    portEXIT_CRITICAL(&mux_);
+
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (!pending || !sensor) {
+        return false;
+    }
+
+    lockSensor();
+    int res;
+    if (roi.active) {
+        // Для OV2640 startX - режим сенсора (1 = SVGA, 800x600), startY/endX/endY не используются
+        res = sensor->set_res_raw(sensor, 1, 0, 0, 0, roi.x, roi.y, roi.width, roi.height,
+                                  roi.outWidth, roi.outHeight, false, false);
+    } else {
+        res = sensor->set_framesize(sensor, frameSize_);
+    }
+
+    if (res != 0) {
+        sensor->set_framesize(sensor, frameSize_);
+    }
+    unlockSensor();
+
+    if (res != 0) {
+        DEBUG_PRINTF("ОШИБКА: Окно сенсора не применено (%d), возврат к полному кадру\n", res);
+        memset(&roiApplied_, 0, sizeof(roiApplied_));
+        portENTER_CRITICAL(&mux_);
+        if (!roiPending_) {
+            roiRequested_.active = false;
+        }
+        portEXIT_CRITICAL(&mux_);
+    } else {
+        roiApplied_ = roi;
+        if (roi.active) {
+            DEBUG_PRINTF("Окно сенсора: %u,%u %ux%u -> %ux%u\n", roi.x, roi.y,
+                         roi.width, roi.height, roi.outWidth, roi.outHeight);
+        } else {
+            DEBUG_PRINTLN("Окно сенсора снято, полный кадр");
+        }
+    }
+
+    // В очереди драйвера могут быть кадры со старыми настройками
+    roiSettleFrames_ = CAMERA_ROI_SETTLE_FRAMES;
+    return res == 0;
+}
+
+// Сколько простаивать без зрителей (0 - пора снять кадр для самописца)
+uint32_t FrameBroker::idleWaitMs() const {
+#ifdef FEATURE_BLACKBOX
+    if (blackBox_ && blackBox_->isRecording()) {
+        const uint32_t sinceMs = millis() - lastBlackBoxFrameMs_;
+        return sinceMs >= BLACKBOX_FRAME_INTERVAL_MS ? 0 : BLACKBOX_FRAME_INTERVAL_MS - sinceMs;
+    }
+#endif
+    return STREAM_FRAME_WAIT_MS;
+}
+
+void FrameBroker::captureTaskEntry(void* arg) {
+    static_cast<FrameBroker*>(arg)->captureLoop();
+}
+
+void FrameBroker::captureLoop() {
+    // Окно подсчета FPS сенсора
+    uint32_t fpsWindowStartMs = millis();
+    uint32_t fpsWindowFrames = 0;
+
+    while (running_) {
+        // Без подписчиков камеру не трогаем (Liner сам читает кадры для линии),
+        // кроме редких кадров самописца
+        const uint32_t idleMs = getSubscriberCount() == 0 ? idleWaitMs() : 0;
+        if (idleMs > 0) {
+            sensorFps_ = 0.0f;
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(idleMs));
+            fpsWindowStartMs = millis();
+            fpsWindowFrames = 0;
+            continue;
+        }
+
+        updateQuality();
+        applyRoi();
+
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (!fb) {
+            captureFailures_++;
+            Serial.println("Camera capture failed");
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        if (roiSettleFrames_ > 0) {
+            roiSettleFrames_--;
+            esp_camera_fb_return(fb);
+            continue;
+        }
+        const int64_t dequeuedUs = esp_timer_get_time();
+
+        fpsWindowFrames++;
+        const uint32_t fpsWindowMs = millis() - fpsWindowStartMs;
+        if (fpsWindowMs >= STREAM_QC_WINDOW_MS) {
+            sensorFps_ = fpsWindowFrames * 1000.0f / fpsWindowMs;
+            fpsWindowStartMs += fpsWindowMs;
+            fpsWindowFrames = 0;
+        }
+        const int64_t capturedUs = (int64_t)fb->timestamp.tv_sec * 1000000LL + fb->timestamp.tv_usec;
+
+        FrameSlot* slot = ring_.reserve();
+        if (!slot) {
+            // Все слоты заняты медленными зрителями - пропускаем кадр
+            esp_camera_fb_return(fb);
+            droppedFrames_++;
+            continue;
+        }
+
+        bool ok = false;
+        const uint8_t* jpgBuf = nullptr;
+        size_t jpgLen = 0;
+        uint8_t* converted = nullptr;
+
+        if (fb->format == PIXFORMAT_JPEG) {
+            jpgBuf = fb->buf;
+            jpgLen = fb->len;
+        } else if (fb->format == PIXFORMAT_GRAYSCALE) {
+            // ЧБ кадр (Liner) кодируем сразу в слот, без malloc и копирования
+            jpgLen = grayEncoder_.encode(fb->buf, fb->width, fb->height, slot->buf, slot->capacity);
+            if (jpgLen) {
+                jpgBuf = slot->buf;
+            } else {
+                DEBUG_PRINTLN("Кадр ЧБ JPEG не помещается в слот");
+            }
+        } else if (frame2jpg(fb, STREAM_GRAY_JPEG_QUALITY, &converted, &jpgLen)) {
+            jpgBuf = converted;
+        } else {
+            Serial.println("JPEG compression failed");
+        }
+
+        if (jpgBuf && jpgLen <= slot->capacity) {
+            if (jpgBuf != slot->buf) {
+                memcpy(slot->buf, jpgBuf, jpgLen);
+            }
+            slot->len = jpgLen;
+            // Драйвер указывает размер по framesize, при окне реальный размер задает DSP
+            const bool roi = roiApplied_.active && fb->format == PIXFORMAT_JPEG;
+            slot->width = roi ? roiApplied_.outWidth : fb->width;
+            slot->height = roi ? roiApplied_.outHeight : fb->height;
+            slot->roiX = roi ? roiApplied_.x : 0;
+            slot->roiY = roi ? roiApplied_.y : 0;
+            slot->roiWidth = roi ? roiApplied_.width : 0;
+            slot->roiHeight = roi ? roiApplied_.height : 0;
+            slot->timestampUs = capturedUs;
+            ok = true;
+        } else if (jpgBuf) {
+            DEBUG_PRINTF("Кадр %u байт не помещается в слот\n", (unsigned)jpgLen);
+        }
+
+        const int64_t encodedUs = esp_timer_get_time();
+
+        if (converted) {
+            free(converted);
+        }
+        const bool sceneChanged = ok && detectSceneChange(fb->format, fb->buf, fb->width,
+                                                          fb->height, slot->len);
+        esp_camera_fb_return(fb);
+
+        if (ok) {
+            portENTER_CRITICAL(&mux_);
+            dequeueLatency_.record((uint32_t)(dequeuedUs - capturedUs));
+            encodeLatency_.record((uint32_t)(encodedUs - dequeuedUs));
+            portEXIT_CRITICAL(&mux_);
+            publish(slot, sceneChanged);
+
+#ifdef FEATURE_BLACKBOX
+            // Слот остается последним кадром, пока задача захвата не займет следующий
+            if (blackBox_ && millis() - lastBlackBoxFrameMs_ >= BLACKBOX_FRAME_INTERVAL_MS) {
+                lastBlackBoxFrameMs_ = millis();
+                blackBox_->recordFrame(slot->buf, slot->len, slot->width, slot->height,
+                                       slot->timestampUs);
+            }
+#endif
+        } else {
+            ring_.discard(slot);
+            droppedFrames_++;
+        }
+    }
+
+    captureTask_ = nullptr;
+    vTaskDelete(NULL);
+}
+
+#endif // FEATURE_CAMERA
@@ -0,0 +1,89 @@
+#include "FrameRing.h"
+
+#ifdef FEATURE_CAMERA
+
+FrameRing::FrameRing() :
+    latest_(nullptr),
+    latestSeq_(0)
+{
+    for (int i = 0; i < kSize; i++) {
+        slots_[i].buf = nullptr;
+        slots_[i].len = 0;
+        slots_[i].capacity = 0;
+        slots_[i].seq = 0;
+        slots_[i].sceneSeq = 0;
+        slots_[i].timestampUs = 0;
+        slots_[i].width = 0;
+        slots_[i].height = 0;
+        slots_[i].roiX = 0;
+        slots_[i].roiY = 0;
+        slots_[i].roiWidth = 0;
+        slots_[i].roiHeight = 0;
+        slots_[i].refs = 0;
+    }
+}
+
+void FrameRing::attachBuffer(int index, uint8_t* buf, size_t capacity) {
+    slots_[index].buf = buf;
+    slots_[index].capacity = capacity;
+    slots_[index].len = 0;
+    slots_[index].seq = 0;
+    slots_[index].refs = 0;
+}
+
+FrameSlot* FrameRing::reserve() {
+    // Свободный слот: никто не держит и это не последний опубликованный кадр.
+    // latest_ меняет только писатель, поэтому сравнение с ним надежно
+    FrameSlot* current = latest_.load();
+    for (int i = 0; i < kSize; i++) {
+        if (&slots_[i] == current) {
+            continue;
+        }
+        int expected = 0;
+        if (slots_[i].refs.compare_exchange_strong(expected, kWriterBias)) {
+            return &slots_[i];
+        }
+    }
+    return nullptr;
+}
+
+void FrameRing::discard(FrameSlot* slot) {
+    slot->refs.fetch_sub(kWriterBias);
+}
+
+void FrameRing::publish(FrameSlot* slot) {
+    // Данные слота записаны до публикации указателя
+    slot->refs.fetch_sub(kWriterBias);
+    latest_.store(slot);
+    latestSeq_.store(slot->seq);
+}
+
+FrameSlot* FrameRing::acquireLatest(uint32_t lastSeq) {
+    for (;;) {
+        FrameSlot* slot = latest_.load();
+        if (!slot) {
+            return nullptr;
+        }
+        // Сначала берем ссылку, затем проверяем, что слот все еще последний:
+        // писатель занимает только слоты с refs == 0, отличные от latest_
+        const int prev = slot->refs.fetch_add(1);
+        if (prev < kWriterBias && latest_.load() == slot) {
+            if (slot->seq == lastSeq) {
+                slot->refs.fetch_sub(1);
+                return nullptr;
+            }
+            return slot;
+        }
+        // Слот успели сменить или перезаписать - пробуем новый последний
+        slot->refs.fetch_sub(1);
+    }
+}
+
+void FrameRing::release(FrameSlot* slot) {
+    if (!slot) {
+        return;
+    }
+    slot->refs.fetch_sub(1);
+}
+
+#endif // FEATURE_CAMERA
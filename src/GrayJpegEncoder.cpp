@@ -0,0 +1,368 @@
+#include "GrayJpegEncoder.h"
+#include <string.h>
+
+// ═══════════════════════════════════════════════════════════════
+// ТАБЛИЦЫ (ITU-T T.81 Annex K)
+// ═══════════════════════════════════════════════════════════════
+
+// Естественный индекс коэффициента для позиции зигзага
+static const uint8_t kZigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+// Базовая таблица квантования яркости (естественный порядок)
+static const uint8_t kLumaQuant[64] = {
+    16,  11,  10,  16,  24,  40,  51,  61,
+    12,  12,  14,  19,  26,  58,  60,  55,
+    14,  13,  16,  24,  40,  57,  69,  56,
+    14,  17,  22,  29,  51,  87,  80,  62,
+    18,  22,  37,  56,  68, 109, 103,  77,
+    24,  35,  55,  64,  81, 104, 113,  92,
+    49,  64,  78,  87, 103, 121, 120, 101,
+    72,  92,  95,  98, 112, 100, 103,  99
+};
+
+static const uint8_t kDcLumaBits[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+static const uint8_t kDcLumaVals[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+static const uint8_t kAcLumaBits[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+static const uint8_t kAcLumaVals[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+// Смещения размеров кадра в заголовке (маркер SOF0)
+static const size_t kSofHeightOffset = 94;
+static const size_t kSofWidthOffset = 96;
+
+// Канонические коды Хаффмана из описания таблицы (bits/vals)
+static void buildHuffmanCodes(const uint8_t* bits, const uint8_t* vals,
+                              uint16_t* codes, uint8_t* sizes) {
+    uint16_t code = 0;
+    int k = 0;
+    for (int len = 1; len <= 16; len++) {
+        for (int i = 0; i < bits[len - 1]; i++) {
+            codes[vals[k]] = code++;
+            sizes[vals[k]] = len;
+            k++;
+        }
+        code <<= 1;
+    }
+}
+
+GrayJpegEncoder::GrayJpegEncoder(uint8_t quality) {
+    memset(dcSize_, 0, sizeof(dcSize_));
+    memset(acSize_, 0, sizeof(acSize_));
+    buildHuffmanCodes(kDcLumaBits, kDcLumaVals, dcCode_, dcSize_);
+    buildHuffmanCodes(kAcLumaBits, kAcLumaVals, acCode_, acSize_);
+    quality_ = 0;
+    setQuality(quality);
+}
+
+void GrayJpegEncoder::setQuality(uint8_t quality) {
+    if (quality < 1) {
+        quality = 1;
+    } else if (quality > 100) {
+        quality = 100;
+    }
+    if (quality == quality_) {
+        return;
+    }
+    quality_ = quality;
+
+    // Масштабирование как в libjpeg (jpeg_quality_scaling)
+    const int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+    for (int i = 0; i < 64; i++) {
+        int q = (kLumaQuant[kZigzag[i]] * scale + 50) / 100;
+        if (q < 1) {
+            q = 1;
+        } else if (q > 255) {
+            q = 255;
+        }
+        quant_[i] = q;
+        // fdct возвращает коэффициенты, умноженные на 8. Деление заменяем
+        // умножением: floor(n / d) == (n * ceil(2^28 / d)) >> 28 при n * d < 2^28
+        const uint32_t divisor = q * 8;
+        divisors_[i] = divisor;
+        reciprocals_[i] = (uint32_t)(((1ULL << kReciprocalShift) + divisor - 1) / divisor);
+    }
+
+    buildHeader();
+}
+
+void GrayJpegEncoder::buildHeader() {
+    uint8_t* p = header_;
+
+    // SOI + APP0 (JFIF 1.01, без миниатюры)
+    static const uint8_t kSoiApp0[] = {
+        0xFF, 0xD8,
+        0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00, 0x01, 0x01,
+        0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00
+    };
+    memcpy(p, kSoiApp0, sizeof(kSoiApp0));
+    p += sizeof(kSoiApp0);
+
+    // DQT: одна 8-битная таблица
+    *p++ = 0xFF; *p++ = 0xDB; *p++ = 0x00; *p++ = 0x43; *p++ = 0x00;
+    memcpy(p, quant_, 64);
+    p += 64;
+
+    // SOF0: 8 бит, одна компонента, выборка 1x1, таблица квантования 0
+    *p++ = 0xFF; *p++ = 0xC0; *p++ = 0x00; *p++ = 0x0B; *p++ = 0x08;
+    *p++ = 0; *p++ = 0;   // Высота
+    *p++ = 0; *p++ = 0;   // Ширина
+    *p++ = 0x01; *p++ = 0x01; *p++ = 0x11; *p++ = 0x00;
+
+    // DHT: DC и AC таблицы яркости
+    const uint16_t dhtLen = 2 + (1 + 16 + sizeof(kDcLumaVals)) + (1 + 16 + sizeof(kAcLumaVals));
+    *p++ = 0xFF; *p++ = 0xC4; *p++ = dhtLen >> 8; *p++ = dhtLen & 0xFF;
+    *p++ = 0x00;
+    memcpy(p, kDcLumaBits, 16);
+    p += 16;
+    memcpy(p, kDcLumaVals, sizeof(kDcLumaVals));
+    p += sizeof(kDcLumaVals);
+    *p++ = 0x10;
+    memcpy(p, kAcLumaBits, 16);
+    p += 16;
+    memcpy(p, kAcLumaVals, sizeof(kAcLumaVals));
+    p += sizeof(kAcLumaVals);
+
+    // SOS: одна компонента, таблицы 0/0, полный спектр
+    static const uint8_t kSos[] = { 0xFF, 0xDA, 0x00, 0x08, 0x01, 0x01, 0x00, 0x00, 0x3F, 0x00 };
+    memcpy(p, kSos, sizeof(kSos));
+}
+
+// ═══════════════════════════════════════════════════════════════
+// ЦЕЛОЧИСЛЕННОЕ DCT (LL&M, как jfdctint.c в libjpeg)
+// ═══════════════════════════════════════════════════════════════
+// Результат масштабирован на 8 относительно нормированного DCT
+
+#define DCT_CONST_BITS 13
+#define DCT_PASS1_BITS 2
+#define DCT_DESCALE(x, n) (((x) + (1 << ((n) - 1))) >> (n))
+
+#define FIX_0_298631336 2446
+#define FIX_0_390180644 3196
+#define FIX_0_541196100 4433
+#define FIX_0_765366865 6270
+#define FIX_0_899976223 7373
+#define FIX_1_175875602 9633
+#define FIX_1_501321110 12299
+#define FIX_1_847759065 15137
+#define FIX_1_961570560 16069
+#define FIX_2_053119869 16819
+#define FIX_2_562915447 20995
+#define FIX_3_072711026 25172
+
+void GrayJpegEncoder::fdct(int32_t* block) {
+    // Проход 1: строки
+    int32_t* d = block;
+    for (int row = 0; row < 8; row++, d += 8) {
+        int32_t tmp0 = d[0] + d[7], tmp7 = d[0] - d[7];
+        int32_t tmp1 = d[1] + d[6], tmp6 = d[1] - d[6];
+        int32_t tmp2 = d[2] + d[5], tmp5 = d[2] - d[5];
+        int32_t tmp3 = d[3] + d[4], tmp4 = d[3] - d[4];
+
+        int32_t tmp10 = tmp0 + tmp3, tmp13 = tmp0 - tmp3;
+        int32_t tmp11 = tmp1 + tmp2, tmp12 = tmp1 - tmp2;
+
+        d[0] = (tmp10 + tmp11) << DCT_PASS1_BITS;
+        d[4] = (tmp10 - tmp11) << DCT_PASS1_BITS;
+
+        int32_t z1 = (tmp12 + tmp13) * FIX_0_541196100;
+        d[2] = DCT_DESCALE(z1 + tmp13 * FIX_0_765366865, DCT_CONST_BITS - DCT_PASS1_BITS);
+        d[6] = DCT_DESCALE(z1 - tmp12 * FIX_1_847759065, DCT_CONST_BITS - DCT_PASS1_BITS);
+
+        z1 = tmp4 + tmp7;
+        int32_t z2 = tmp5 + tmp6;
+        int32_t z3 = tmp4 + tmp6;
+        int32_t z4 = tmp5 + tmp7;
+        int32_t z5 = (z3 + z4) * FIX_1_175875602;
+
+        tmp4 *= FIX_0_298631336;
+        tmp5 *= FIX_2_053119869;
+        tmp6 *= FIX_3_072711026;
+        tmp7 *= FIX_1_501321110;
+        z1 *= -FIX_0_899976223;
+        z2 *= -FIX_2_562915447;
+        z3 = z3 * -FIX_1_961570560 + z5;
+        z4 = z4 * -FIX_0_390180644 + z5;
+
+        d[7] = DCT_DESCALE(tmp4 + z1 + z3, DCT_CONST_BITS - DCT_PASS1_BITS);
+        d[5] = DCT_DESCALE(tmp5 + z2 + z4, DCT_CONST_BITS - DCT_PASS1_BITS);
+        d[3] = DCT_DESCALE(tmp6 + z2 + z3, DCT_CONST_BITS - DCT_PASS1_BITS);
+        d[1] = DCT_DESCALE(tmp7 + z1 + z4, DCT_CONST_BITS - DCT_PASS1_BITS);
+    }
+
+    // Проход 2: столбцы
+    d = block;
+    for (int col = 0; col < 8; col++, d++) {
+        int32_t tmp0 = d[0] + d[56], tmp7 = d[0] - d[56];
+        int32_t tmp1 = d[8] + d[48], tmp6 = d[8] - d[48];
+        int32_t tmp2 = d[16] + d[40], tmp5 = d[16] - d[40];
+        int32_t tmp3 = d[24] + d[32], tmp4 = d[24] - d[32];
+
+        int32_t tmp10 = tmp0 + tmp3, tmp13 = tmp0 - tmp3;
+        int32_t tmp11 = tmp1 + tmp2, tmp12 = tmp1 - tmp2;
+
+        d[0] = DCT_DESCALE(tmp10 + tmp11, DCT_PASS1_BITS);
+        d[32] = DCT_DESCALE(tmp10 - tmp11, DCT_PASS1_BITS);
+
+        int32_t z1 = (tmp12 + tmp13) * FIX_0_541196100;
+        d[16] = DCT_DESCALE(z1 + tmp13 * FIX_0_765366865, DCT_CONST_BITS + DCT_PASS1_BITS);
+        d[48] = DCT_DESCALE(z1 - tmp12 * FIX_1_847759065, DCT_CONST_BITS + DCT_PASS1_BITS);
+
+        z1 = tmp4 + tmp7;
+        int32_t z2 = tmp5 + tmp6;
+        int32_t z3 = tmp4 + tmp6;
+        int32_t z4 = tmp5 + tmp7;
+        int32_t z5 = (z3 + z4) * FIX_1_175875602;
+
+        tmp4 *= FIX_0_298631336;
+        tmp5 *= FIX_2_053119869;
+        tmp6 *= FIX_3_072711026;
+        tmp7 *= FIX_1_501321110;
+        z1 *= -FIX_0_899976223;
+        z2 *= -FIX_2_562915447;
+        z3 = z3 * -FIX_1_961570560 + z5;
+        z4 = z4 * -FIX_0_390180644 + z5;
+
+        d[56] = DCT_DESCALE(tmp4 + z1 + z3, DCT_CONST_BITS + DCT_PASS1_BITS);
+        d[40] = DCT_DESCALE(tmp5 + z2 + z4, DCT_CONST_BITS + DCT_PASS1_BITS);
+        d[24] = DCT_DESCALE(tmp6 + z2 + z3, DCT_CONST_BITS + DCT_PASS1_BITS);
+        d[8] = DCT_DESCALE(tmp7 + z1 + z4, DCT_CONST_BITS + DCT_PASS1_BITS);
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════
+// ЭНТРОПИЙНОЕ КОДИРОВАНИЕ
+// ═══════════════════════════════════════════════════════════════
+
+void GrayJpegEncoder::putBits(BitWriter& writer, uint32_t code, int size) {
+    writer.buffer = (writer.buffer << size) | (code & ((1u << size) - 1));
+    writer.bits += size;
+    while (writer.bits >= 8) {
+        uint8_t byte = (uint8_t)(writer.buffer >> (writer.bits - 8));
+        writer.bits -= 8;
+        const size_t need = byte == 0xFF ? 2 : 1;
+        if (writer.pos + need > writer.capacity) {
+            writer.overflow = true;
+            return;
+        }
+        writer.out[writer.pos++] = byte;
+        if (byte == 0xFF) {
+            writer.out[writer.pos++] = 0x00; // Вставка нуля после 0xFF
+        }
+    }
+}
+
+void GrayJpegEncoder::flushBits(BitWriter& writer) {
+    // Дополняем последний байт единицами
+    if (writer.bits > 0) {
+        putBits(writer, 0x7F, 8 - writer.bits);
+    }
+}
+
+// Категория (число бит) значения коэффициента
+static inline int bitLength(int32_t value) {
+    const uint32_t v = value < 0 ? -value : value;
+    return v ? 32 - __builtin_clz(v) : 0;
+}
+
+void GrayJpegEncoder::encodeBlock(int32_t* block, int& lastDc, BitWriter& writer) const {
+    fdct(block);
+
+    // Квантование с округлением к ближайшему, в порядке зигзага
+    int32_t coefs[64];
+    for (int i = 0; i < 64; i++) {
+        const int32_t v = block[kZigzag[i]];
+        const uint32_t n = (uint32_t)(v >= 0 ? v : -v) + (divisors_[i] >> 1);
+        const int32_t q = (int32_t)(((uint64_t)n * reciprocals_[i]) >> kReciprocalShift);
+        coefs[i] = v >= 0 ? q : -q;
+    }
+
+    // DC: разность с предыдущим блоком
+    int32_t diff = coefs[0] - lastDc;
+    lastDc = coefs[0];
+    int size = bitLength(diff);
+    putBits(writer, dcCode_[size], dcSize_[size]);
+    if (size) {
+        putBits(writer, diff < 0 ? diff - 1 : diff, size);
+    }
+
+    // AC: серии нулей + значение
+    int run = 0;
+    for (int i = 1; i < 64; i++) {
+        const int32_t v = coefs[i];
+        if (v == 0) {
+            run++;
+            continue;
+        }
+        while (run > 15) {
+            putBits(writer, acCode_[0xF0], acSize_[0xF0]); // ZRL
+            run -= 16;
+        }
+        size = bitLength(v);
+        const int symbol = (run << 4) | size;
+        putBits(writer, acCode_[symbol], acSize_[symbol]);
+        putBits(writer, v < 0 ? v - 1 : v, size);
+        run = 0;
+    }
+    if (run > 0) {
+        putBits(writer, acCode_[0x00], acSize_[0x00]); // EOB
+    }
+}
+
+size_t GrayJpegEncoder::encode(const uint8_t* gray, uint16_t width, uint16_t height,
+                               uint8_t* out, size_t capacity) {
+    if (!gray || !out || width == 0 || height == 0 || capacity < kHeaderSize + 2) {
+        return 0;
+    }
+
+    memcpy(out, header_, kHeaderSize);
+    out[kSofHeightOffset] = height >> 8;
+    out[kSofHeightOffset + 1] = height & 0xFF;
+    out[kSofWidthOffset] = width >> 8;
+    out[kSofWidthOffset + 1] = width & 0xFF;
+
+    // Оставляем место под EOI
+    BitWriter writer = { out, kHeaderSize, capacity - 2, 0, 0, false };
+    int lastDc = 0;
+    int32_t block[64];
+
+    for (int by = 0; by < height && !writer.overflow; by += 8) {
+        for (int bx = 0; bx < width && !writer.overflow; bx += 8) {
+            // Блок со сдвигом уровня; края кадра, не кратного 8, повторяют последний пиксель
+            for (int y = 0; y < 8; y++) {
+                const int sy = by + y < height ? by + y : height - 1;
+                const uint8_t* row = gray + (size_t)sy * width;
+                for (int x = 0; x < 8; x++) {
+                    const int sx = bx + x < width ? bx + x : width - 1;
+                    block[y * 8 + x] = (int32_t)row[sx] - 128;
+                }
+            }
+            encodeBlock(block, lastDc, writer);
+        }
+    }
+
+    flushBits(writer);
+    if (writer.overflow) {
+        return 0;
+    }
+
+    out[writer.pos++] = 0xFF;
+    out[writer.pos++] = 0xD9; // EOI
+    return writer.pos;
+}
@@ -0,0 +1,66 @@
+#include "LatencyHistogram.h"
+#include <stdio.h>
+
+// Верхние границы корзин, мкс (последняя корзина - все, что больше)
+static const uint32_t kBucketLimitsUs[LatencyHistogram::kBucketCount - 1] = {
+    500, 1000, 2000, 3000, 5000, 7500, 10000, 15000,
+    20000, 30000, 50000, 75000, 100000, 250000, 500000
+};
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    for (int i = 0; i < kBucketCount; i++) {
+        buckets_[i] = 0;
+    }
+    count_ = 0;
+    sumUs_ = 0;
+    maxUs_ = 0;
+}
+
+void LatencyHistogram::record(uint32_t valueUs) {
+    int bucket = 0;
+    while (bucket < kBucketCount - 1 && valueUs > kBucketLimitsUs[bucket]) {
+        bucket++;
+    }
+    buckets_[bucket]++;
+    count_++;
+    sumUs_ += valueUs;
+    if (valueUs > maxUs_) {
+        maxUs_ = valueUs;
+    }
+}
+
+uint32_t LatencyHistogram::percentileUs(uint8_t percentile) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    // Номер отсчета (с 1), который должен попасть в перцентиль
+    uint32_t rank = (uint32_t)(((uint64_t)count_ * percentile + 99) / 100);
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint32_t seen = 0;
+    for (int i = 0; i < kBucketCount; i++) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            if (i == kBucketCount - 1) {
+                return maxUs_;
+            }
+            // Граница корзины не может быть больше наблюдавшегося максимума
+            return kBucketLimitsUs[i] < maxUs_ ? kBucketLimitsUs[i] : maxUs_;
+        }
+    }
+    return maxUs_;
+}
+
+int LatencyHistogram::formatJsonMs(char* out, size_t size, const char* name) const {
+    return snprintf(out, size,
+                    "\"%s\":{\"count\":%u,\"avg\":%.1f,\"p50\":%.1f,\"p95\":%.1f,\"p99\":%.1f,\"max\":%.1f}",
+                    name, (unsigned)count_, getAvgUs() / 1000.0f,
+                    percentileUs(50) / 1000.0f, percentileUs(95) / 1000.0f,
+                    percentileUs(99) / 1000.0f, maxUs_ / 1000.0f);
+}
@@ -4,6 +4,7 @@
 
 #include "MX1508MotorController.h"
 #include "hardware_config.h"
+#include "FastLog.h"
 #include <esp_camera.h>
 
 LinerRobot::LinerRobot() :
@@ -18,11 +19,13 @@ LinerRobot::LinerRobot() :
     lineDetected_(false),
     lineNotDetectedCount_(0),
     lineEndAnimationPlayed_(false),
+    lineFrame_(nullptr),
+    lineCaptureTask_(nullptr),
+    lineCaptureRunning_(false),
+    lineTaskId_(-1),
     pidError_(0.0f),
     pidLastError_(0.0f),
-    pidIntegral_(0.0f),
-    targetThrottlePWM_(1500),
-    targetSteeringPWM_(1500)
+    pidIntegral_(0.0f)
 {
     DEBUG_PRINTLN("Создание LinerRobot");
 }
@@ -72,40 +75,49 @@ bool LinerRobot::initSpecificComponents() {
     return true;
 }
 
-void LinerRobot::updateSpecificComponents() {
-    // ДИАГНОСТИКА: Выводим текущий режим периодически
-    static unsigned long lastModePrint = 0;
-    if (millis() - lastModePrint > MODE_DIAG_INTERVAL_MS) {
-        unsigned long now = millis();
-        DEBUG_PRINT("[MODE_DIAG] Текущий режим: ");
-        DEBUG_PRINTLN(currentMode_ == Mode::AUTONOMOUS ? "АВТОНОМНЫЙ (следование по линии)" : "РУЧНОЙ");
-        lastModePrint = now;
+void LinerRobot::scheduleSpecificComponents(ComponentScheduler& scheduler) {
+    // Ручные команды - на каждую новую команду (postMotorCommand)
+    // (в автономном режиме моторами управляет PID на каждом кадре)
+    commandTaskId_ = scheduler.add("commands", 0, MOTOR_UPDATE_DEADLINE_US, [this]() {
+        if (currentMode_ == Mode::MANUAL) {
+            updateMotors();
+        }
+    });
+    // Контроллер моторов (watchdog работает по таймеру, здесь только журнал)
+    scheduler.add("motors", motorController_);
+    
+#ifdef FEATURE_LINE_FOLLOWING
+    // Следование по линии - на каждый кадр камеры
+    lineTaskId_ = scheduler.add("line", 0, LINE_FOLLOW_DEADLINE_US, [this]() {
+        updateLineFollowing();
+    });
+    if (!startLineCapture()) {
+        DEBUG_PRINTLN("ОШИБКА: Не удалось создать задачу захвата кадров линии");
     }
+#endif
     
-    // Обновление кнопки
 #ifdef FEATURE_BUTTON
-    updateButton();
+    scheduler.add("button", BUTTON_POLL_PERIOD_US, 0, [this]() {
+        updateButton();
+    });
 #endif
     
-    // Обновление в зависимости от режима
-    if (currentMode_ == Mode::AUTONOMOUS) {
-        updateLineFollowing();
-    } else {
-        updateMotors();
-    }
-    
-    // Обновление индикации
 #ifdef FEATURE_NEOPIXEL
-    updateStatusLED();
+    scheduler.add("leds", LED_UPDATE_PERIOD_US, LED_UPDATE_DEADLINE_US, [this]() {
+        updateStatusLED();
+    });
 #endif
     
-    // Обновление контроллера моторов
-    if (motorController_) {
-        motorController_->update();
-    }
+    // ДИАГНОСТИКА: Выводим текущий режим периодически
+    scheduler.add("diag", MODE_DIAG_INTERVAL_MS * 1000UL, 0, [this]() {
+        DEBUG_PRINT("[MODE_DIAG] Текущий режим: ");
+        DEBUG_PRINTLN(currentMode_ == Mode::AUTONOMOUS ? "АВТОНОМНЫЙ (следование по линии)" : "РУЧНОЙ");
+    });
 }
 
 void LinerRobot::shutdownSpecificComponents() {
+    stopLineCapture();
+    
 #ifdef FEATURE_NEOPIXEL
     if (pixels_) {
         pixels_->clear();
@@ -152,6 +164,7 @@ bool LinerRobot::initMotors() {
     if (wifiSettings_) {
         static_cast<MX1508MotorController*>(motorController_)->setWiFiSettings(wifiSettings_);
     }
+    static_cast<MX1508MotorController*>(motorController_)->setBlackBox(blackBox_);
     
     DEBUG_PRINTLN("Моторы инициализированы");
     return true;
@@ -303,22 +316,93 @@ void LinerRobot::onButtonPressed() {
 
 void LinerRobot::updateLineFollowing() {
 #ifdef FEATURE_LINE_FOLLOWING
+    camera_fb_t* fb = lineFrame_.exchange(nullptr);
+    if (!fb) {
+        return;
+    }
+    // Кадр мог прийти до переключения в ручной режим
+    if (currentMode_ != Mode::AUTONOMOUS) {
+        esp_camera_fb_return(fb);
+        return;
+    }
+    
     // Определение позиции линии
-    float linePosition = detectLinePosition();
+    float linePosition = detectLinePosition(fb);
     
     // Применение PID управления
     applyPIDControl(linePosition);
 #endif
 }
 
-float LinerRobot::detectLinePosition() {
-    // Захват кадра с камеры
-    camera_fb_t* fb = esp_camera_fb_get();
-    if (!fb) {
-        DEBUG_PRINTLN("ОШИБКА: Не удалось получить кадр с камеры");
-        return 0.0f;
+bool LinerRobot::startLineCapture() {
+    lineCaptureRunning_ = true;
+    TaskHandle_t task = nullptr;
+    BaseType_t created = xTaskCreatePinnedToCore(lineCaptureTaskEntry, "line_capture",
+                                                 LINE_CAPTURE_TASK_STACK, this,
+                                                 LINE_CAPTURE_TASK_PRIORITY, &task,
+                                                 CAMERA_CAPTURE_TASK_CORE);
+    if (created != pdPASS) {
+        lineCaptureRunning_ = false;
+        return false;
+    }
+    lineCaptureTask_ = task;
+    return true;
+}
+
+void LinerRobot::stopLineCapture() {
+    if (!lineCaptureTask_) {
+        return;
+    }
+    
+    lineCaptureRunning_ = false;
+    xTaskNotifyGive(lineCaptureTask_);
+    
+    // Ждем, пока задача дождется текущего кадра и завершится
+    for (int i = 0; i < 100 && lineCaptureTask_; i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    
+    camera_fb_t* fb = lineFrame_.exchange(nullptr);
+    if (fb) {
+        esp_camera_fb_return(fb);
+    }
+}
+
+void LinerRobot::lineCaptureTaskEntry(void* arg) {
+    static_cast<LinerRobot*>(arg)->lineCaptureLoop();
+}
+
+void LinerRobot::lineCaptureLoop() {
+    while (lineCaptureRunning_) {
+        // В ручном режиме кадры для линии не нужны (проверка раз в 100 мс)
+        if (currentMode_ != Mode::AUTONOMOUS) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+            continue;
+        }
+        
+        // Блокируется до следующего кадра - здесь, а не в цикле робота
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (!fb) {
+            DEBUG_PRINTLN("ОШИБКА: Не удалось получить кадр с камеры");
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        
+        // Необработанный предыдущий кадр заменяется новым
+        camera_fb_t* stale = lineFrame_.exchange(fb);
+        if (stale) {
+            esp_camera_fb_return(stale);
+        }
+        scheduler_.trigger(lineTaskId_);
     }
     
+    lineCaptureTask_ = nullptr;
+    vTaskDelete(NULL);
+}
+
+float LinerRobot::detectLinePosition(camera_fb_t* fb) {
+    // Кадр от задачи захвата линии, возвращается драйверу здесь же
+    
     // Проверка формата кадра
     if (fb->format != PIXFORMAT_GRAYSCALE) {
         DEBUG_PRINTLN("ПРЕДУПРЕЖДЕНИЕ: Камера не в режиме GRAYSCALE!");
@@ -438,16 +522,18 @@ void LinerRobot::applyPIDControl(float linePosition) {
     // Преобразуем steering в steering PWM (1500 = прямо)
     int steeringPWM = map(steering, -100, 100, 1000, 2000);
     
-    DEBUG_PRINTF("Line: %.2f, Control: %.2f, Throttle PWM: %d, Steering PWM: %d\n", 
-                 linePosition, control, throttlePWM, steeringPWM);
+    FAST_LOG("Line: %.2f, Control: %.2f, Throttle PWM: %d, Steering PWM: %d",
+             linePosition, control, throttlePWM, steeringPWM);
     
-    // Используем setMotorPWM() - это автоматически применит все настройки:
+    // Тот же микшер, что и в ручном режиме - автоматически применяются все настройки:
     // - Инверсию левого мотора
     // - Инверсию правого мотора
     // - Своп моторов
     // Гарантируется одинаковое поведение в ручном и автономном режимах!
+    // Ограничитель плавности не применяется: коэффициенты PID подобраны
+    // для мгновенного выхода, запаздывание ограничителя раскачало бы контур
     if (motorController_) {
-        motorController_->setMotorPWM(throttlePWM, steeringPWM);
+        motorController_->setMotorPWMImmediate(throttlePWM, steeringPWM);
     }
 }
 
@@ -456,35 +542,27 @@ void LinerRobot::updateMotors() {
         return;
     }
     
-    // Применяем значения PWM только если они изменились или если сработал watchdog
-    static int lastAppliedThrottle = 1500;
-    static int lastAppliedSteering = 1500;
-    
-    // Если watchdog остановил моторы, сбрасываем целевые значения в нейтральное положение
-    // чтобы предотвратить повторное применение старых команд движения
-    if (motorController_->wasWatchdogTriggered()) {
-        targetThrottlePWM_ = 1500;
-        targetSteeringPWM_ = 1500;
-    }
-    
-    if (targetThrottlePWM_ != lastAppliedThrottle || targetSteeringPWM_ != lastAppliedSteering) {
-        motorController_->setMotorPWM(targetThrottlePWM_, targetSteeringPWM_);
-        lastAppliedThrottle = targetThrottlePWM_;
-        lastAppliedSteering = targetSteeringPWM_;
+    // Применяем только новую команду из почтового ящика. Новизна определяется
+    // по seq, а не по значениям: повтор той же команды после остановки по
+    // watchdog тоже применяется, а уже примененная не повторяется.
+    // Команда, полученная до срабатывания watchdog, но забранная после него,
+    // отбрасывается: новая команда сбрасывает флаг до записи в ящик
+    int throttlePWM, steeringPWM;
+    if (commandMailbox_.take(throttlePWM, steeringPWM) && !motorController_->wasWatchdogTriggered()) {
+        motorController_->setMotorPWM(throttlePWM, steeringPWM);
     }
 }
 
 void LinerRobot::handleMotorCommand(int throttlePWM, int steeringPWM) {
     // В ручном режиме обновляем целевые значения PWM
     if (currentMode_ == Mode::MANUAL) {
-        targetThrottlePWM_ = constrain(throttlePWM, 1000, 2000);
-        targetSteeringPWM_ = constrain(steeringPWM, 1000, 2000);
-        
-        // ВАЖНО: Обновляем timestamp СРАЗУ при получении команды
-        // Это предотвращает срабатывание watchdog когда команды приходят с одинаковыми значениями
+        // ВАЖНО: Обновляем timestamp СРАЗУ при получении команды и ДО записи в ящик:
+        // цикл управления просыпается от post() и не должен увидеть старое время watchdog
         if (motorController_) {
             motorController_->updateCommandTime();
         }
+        
+        postMotorCommand(throttlePWM, steeringPWM);
     }
     // В автономном режиме игнорируем команды управления
 }
@@ -807,8 +885,7 @@ void LinerRobot::handleCommand(AsyncWebServerRequest* request) {
         int throttle = request->getParam("throttle")->value().toInt();
         int steering = request->getParam("steering")->value().toInt();
         
-        targetThrottlePWM_ = constrain(throttle, 1000, 2000);
-        targetSteeringPWM_ = constrain(steering, 1000, 2000);
+        postMotorCommand(throttle, steering);
         
         request->send(200, "text/plain", "OK");
     } else if (request->hasParam("effect")) {
@@ -1,5 +1,9 @@
 #include "MX1508MotorController.h"
 #include "WiFiSettings.h"
+#include "BlackBoxRecorder.h"
+#include "FastLog.h"
+#include "CommandTrace.h"
+#include "DriveMixer.h"
 #include <Arduino.h>
 
 #ifdef FEATURE_MOTORS
@@ -8,9 +12,19 @@ MX1508MotorController::MX1508MotorController() :
     initialized_(false),
     currentLeftSpeed_(0),
     currentRightSpeed_(0),
-    lastCommandTime_(0),
     watchdogTriggered_(false),
-    wifiSettings_(nullptr)
+    wifiSettings_(nullptr),
+    blackBox_(nullptr),
+    mixerConfig_(0),
+    slewTimer_(nullptr),
+    slewActive_(false),
+    brakeMode_(static_cast<MotorBrakeMode>(MOTOR_BRAKE_MODE_DEFAULT)),
+    brakeStrength_(MOTOR_BRAKE_STRENGTH_DEFAULT),
+    failsafeTimer_(nullptr),
+    outputLock_(nullptr),
+    watchdog_(MOTOR_COMMAND_TIMEOUT_MS * 1000UL),
+    statsMux_(portMUX_INITIALIZER_UNLOCKED),
+    reportedTrips_(0)
 {
 }
 
@@ -25,6 +39,28 @@ bool MX1508MotorController::init() {
     
     DEBUG_PRINTLN("Инициализация MX1508 Motor Controller...");
     
+    // Watchdog команд: без таймера моторы нельзя оставлять без присмотра
+    outputLock_ = xSemaphoreCreateMutex();
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = failsafeTimerCallback;
+    timerArgs.arg = this;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "motor_failsafe";
+    if (!outputLock_ || esp_timer_create(&timerArgs, &failsafeTimer_) != ESP_OK) {
+        DEBUG_PRINTLN("ОШИБКА: Не удалось создать таймер watchdog моторов");
+        return false;
+    }
+    
+    // Тик ограничителя скорости нарастания
+    timerArgs.callback = slewTimerCallback;
+    timerArgs.name = "motor_slew";
+    if (esp_timer_create(&timerArgs, &slewTimer_) != ESP_OK) {
+        DEBUG_PRINTLN("ОШИБКА: Не удалось создать таймер плавности моторов");
+        return false;
+    }
+    leftSlew_.setRates(MOTOR_SLEW_ACCEL_DEFAULT, MOTOR_SLEW_DECEL_DEFAULT, MOTOR_SLEW_REVERSE_DEFAULT, MOTOR_SLEW_TICK_US);
+    rightSlew_.setRates(MOTOR_SLEW_ACCEL_DEFAULT, MOTOR_SLEW_DECEL_DEFAULT, MOTOR_SLEW_REVERSE_DEFAULT, MOTOR_SLEW_TICK_US);
+    
     // Настройка пинов моторов
     pinMode(MOTOR_LEFT_FWD_PIN, OUTPUT);
     pinMode(MOTOR_LEFT_REV_PIN, OUTPUT);
@@ -55,6 +91,8 @@ bool MX1508MotorController::init() {
     ledcWrite(MOTOR_PWM_CHANNEL_RF, 0);
     ledcWrite(MOTOR_PWM_CHANNEL_RR, 0);
     
+    esp_timer_start_periodic(slewTimer_, MOTOR_SLEW_TICK_US);
+    
     initialized_ = true;
     DEBUG_PRINTLN("MX1508 Motor Controller инициализирован");
     return true;
@@ -65,15 +103,16 @@ void MX1508MotorController::update() {
         return;
     }
     
-    // Проверка таймаута команд (watchdog)
-    if (lastCommandTime_ > 0 && (millis() - lastCommandTime_ > MOTOR_COMMAND_TIMEOUT_MS)) {
-        // Автоостановка моторов если нет команд
-        if (currentLeftSpeed_ != 0 || currentRightSpeed_ != 0) {
-            DEBUG_PRINTLN("Motor watchdog: остановка моторов");
-            watchdogTriggered_ = true;  // Устанавливаем флаг срабатывания watchdog
-            stop();
-            // Не сбрасываем флаг здесь - он будет сброшен при следующей команде
-        }
+    // Остановку по таймауту выполняет таймер, здесь только сообщение о ней
+    // (вывод в UART из задачи esp_timer задержал бы остальные таймеры)
+    portENTER_CRITICAL(&statsMux_);
+    const uint32_t trips = watchdog_.getTripCount();
+    const uint32_t latencyUs = watchdog_.getLastTripLatencyUs();
+    portEXIT_CRITICAL(&statsMux_);
+    
+    if (trips != reportedTrips_) {
+        DEBUG_PRINTF("Motor watchdog: остановка моторов (через %u мкс после таймаута)\n", latencyUs);
+        reportedTrips_ = trips;
     }
 }
 
@@ -82,76 +121,133 @@ void MX1508MotorController::shutdown() {
         stop();
         initialized_ = false;
     }
+    if (slewTimer_) {
+        esp_timer_stop(slewTimer_);
+        esp_timer_delete(slewTimer_);
+        slewTimer_ = nullptr;
+    }
+    if (failsafeTimer_) {
+        esp_timer_stop(failsafeTimer_);
+        esp_timer_delete(failsafeTimer_);
+        failsafeTimer_ = nullptr;
+    }
+    if (outputLock_) {
+        vSemaphoreDelete(outputLock_);
+        outputLock_ = nullptr;
+    }
 }
 
 void MX1508MotorController::setSpeed(int leftSpeed, int rightSpeed) {
     if (!initialized_) {
         return;
     }
-    
+    applyTarget(leftSpeed, rightSpeed, true);
+}
+
+void MX1508MotorController::applyTarget(int leftSpeed, int rightSpeed, bool limited) {
     // Ограничение скорости
     leftSpeed = constrainSpeed(leftSpeed);
     rightSpeed = constrainSpeed(rightSpeed);
     
-    applyMotorSpeed(leftSpeed, rightSpeed);
+    // Новая цель; первый шаг к ней - сразу, не дожидаясь тика (без
+    // ограничения - сразу на цель). Запись безусловная: тормоз на участке
+    // реверса зависит и от цели
+    xSemaphoreTake(outputLock_, portMAX_DELAY);
+    if (limited) {
+        leftSlew_.setTarget(leftSpeed);
+        rightSlew_.setTarget(rightSpeed);
+    } else {
+        leftSlew_.jumpTo(leftSpeed);
+        rightSlew_.jumpTo(rightSpeed);
+    }
+    stepOutputs(true);
+    xSemaphoreGive(outputLock_);
+    CommandTrace::applied();
+
+#ifdef FEATURE_BLACKBOX
+    if (blackBox_) {
+        blackBox_->recordMotor(leftSpeed, rightSpeed);
+    }
+#endif
+    // NOTE: таймер watchdog перезапускается в updateCommandTime(), вызываемом из handleMotorCommand
+    // Не перезапускаем здесь, чтобы watchdog отслеживал получение команд, а не их применение
+}
+
+void MX1508MotorController::mixPWM(int throttlePWM, int steeringPWM, int& leftSpeed, int& rightSpeed) const {
+    // Преобразование PWM (1000-2000, центр 1500) в скорости моторов (-100..+100):
+    // таблица кривой оси, дифференциальный микс, swap/invert из настроек
+    // (свернуты в mixerConfig_ при их изменении)
+    const uint8_t config = mixerConfig_.load(std::memory_order_relaxed);
+    DriveMixer::mix(throttlePWM, steeringPWM, config, leftSpeed, rightSpeed);
     
-    currentLeftSpeed_ = leftSpeed;
-    currentRightSpeed_ = rightSpeed;
-    // NOTE: lastCommandTime_ обновляется в updateCommandTime(), вызываемом из handleMotorCommand
-    // Не обновляем здесь, чтобы watchdog отслеживал получение команд, а не их применение
+    FAST_LOG("Mix: t=%d s=%d -> L=%d R=%d (config 0x%x)",
+             throttlePWM, steeringPWM, leftSpeed, rightSpeed, config);
 }
 
 void MX1508MotorController::setMotorPWM(int throttlePWM, int steeringPWM) {
     if (!initialized_) {
         return;
     }
-    
-    // Преобразование PWM (1000-2000) в скорость (-100 до +100)
-    // 1500 = центр (0 скорость)
-    int throttle = map(throttlePWM, 1000, 2000, -100, 100);
-    int steering = map(steeringPWM, 1000, 2000, -100, 100);
-    
-    // Дифференциальное управление
-    int leftSpeed = throttle + steering;
-    int rightSpeed = throttle - steering;
-    
-    DEBUG_PRINTF("BEFORE settings: L=%d R=%d", leftSpeed, rightSpeed);
-    
-    // Применяем настройки моторов из WiFiSettings
+    int leftSpeed, rightSpeed;
+    mixPWM(throttlePWM, steeringPWM, leftSpeed, rightSpeed);
+    applyTarget(leftSpeed, rightSpeed, true);
+}
+
+void MX1508MotorController::setMotorPWMImmediate(int throttlePWM, int steeringPWM) {
+    if (!initialized_) {
+        return;
+    }
+    // Тот же микшер, что у ручных команд, но без ограничителя плавности
+    int leftSpeed, rightSpeed;
+    mixPWM(throttlePWM, steeringPWM, leftSpeed, rightSpeed);
+    applyTarget(leftSpeed, rightSpeed, false);
+}
+
+void MX1508MotorController::setWiFiSettings(WiFiSettings* settings) {
+    wifiSettings_ = settings;
+    onSettingsChanged();
+}
+
+void MX1508MotorController::onSettingsChanged() {
+    // ВАЖНО: Инверсия применяется к логическим левому/правому моторам ДО swap,
+    // поэтому инвертированные настройки идут вместе с моторами
+    uint8_t config = 0;
     if (wifiSettings_) {
-        DEBUG_PRINTF("Motor settings: swap=%d invertL=%d invertR=%d", 
-                     wifiSettings_->getMotorSwapLeftRight(),
-                     wifiSettings_->getMotorInvertLeft(),
-                     wifiSettings_->getMotorInvertRight());
-        
-        // ВАЖНО: Сначала применяем инверсию, ПОТОМ swap
-        // Инверсия применяется к логическим левому/правому моторам
-        if (wifiSettings_->getMotorInvertLeft()) {
-            leftSpeed = -leftSpeed;
-            DEBUG_PRINTLN("Applied LEFT invert");
-        }
-        
-        if (wifiSettings_->getMotorInvertRight()) {
-            rightSpeed = -rightSpeed;
-            DEBUG_PRINTLN("Applied RIGHT invert");
-        }
+        config = DriveMixer::makeConfig(wifiSettings_->getMotorSwapLeftRight(),
+                                        wifiSettings_->getMotorInvertLeft(),
+                                        wifiSettings_->getMotorInvertRight());
+    }
+    mixerConfig_.store(config, std::memory_order_relaxed);
+    
+    // Плавность: скорости в %/с -> шаг за тик
+    if (wifiSettings_ && outputLock_) {
+        xSemaphoreTake(outputLock_, portMAX_DELAY);
+        leftSlew_.setRates(wifiSettings_->getMotorAccelRate(), wifiSettings_->getMotorDecelRate(),
+                           wifiSettings_->getMotorReverseRate(), MOTOR_SLEW_TICK_US);
+        rightSlew_.setRates(wifiSettings_->getMotorAccelRate(), wifiSettings_->getMotorDecelRate(),
+                            wifiSettings_->getMotorReverseRate(), MOTOR_SLEW_TICK_US);
         
-        // Меняем местами левый и правый ПОСЛЕ инверсии
-        // Теперь инвертированные настройки идут вместе с моторами
-        if (wifiSettings_->getMotorSwapLeftRight()) {
-            int temp = leftSpeed;
-            leftSpeed = rightSpeed;
-            rightSpeed = temp;
-            DEBUG_PRINTLN("Applied SWAP");
+        // Торможение; остановленные моторы переходят в новый режим сразу
+        brakeMode_ = wifiSettings_->getMotorBrakeMode();
+        brakeStrength_ = constrain(wifiSettings_->getMotorBrakeStrength(), 0, 100);
+        if (initialized_) {
+            applyMotorSpeed(currentLeftSpeed_, currentRightSpeed_);
         }
-    } else {
-        DEBUG_PRINTLN("WARNING: wifiSettings_ is NULL!");
+        xSemaphoreGive(outputLock_);
     }
     
-    // Детальные логи для диагностики
-    DEBUG_PRINTF("AFTER settings: L=%d R=%d", leftSpeed, rightSpeed);
-    
-    setSpeed(leftSpeed, rightSpeed);
+    DEBUG_PRINTF("Микшер моторов: swap=%d invertL=%d invertR=%d\n",
+                 (config & DriveMixer::kSwap) != 0,
+                 wifiSettings_ ? wifiSettings_->getMotorInvertLeft() : 0,
+                 wifiSettings_ ? wifiSettings_->getMotorInvertRight() : 0);
+    if (wifiSettings_) {
+        DEBUG_PRINTF("Плавность моторов: разгон %d, сброс %d, реверс %d %%/с\n",
+                     wifiSettings_->getMotorAccelRate(), wifiSettings_->getMotorDecelRate(),
+                     wifiSettings_->getMotorReverseRate());
+        DEBUG_PRINTF("Торможение моторов: режим %d, сила %d%%\n",
+                     static_cast<int>(wifiSettings_->getMotorBrakeMode()),
+                     wifiSettings_->getMotorBrakeStrength());
+    }
 }
 
 void MX1508MotorController::stop() {
@@ -162,18 +258,102 @@ void MX1508MotorController::stop() {
     // Note: We deliberately do NOT clear watchdogTriggered_ flag here.
     // If watchdog triggered before this stop(), the flag should remain set
     // so that the next motor command will be forced to apply.
-    // The flag is only cleared when a new motor command is received via setSpeed().
+    // The flag is only cleared when a new motor command is received via updateCommandTime().
     
-    ledcWrite(MOTOR_PWM_CHANNEL_LF, 0);
-    ledcWrite(MOTOR_PWM_CHANNEL_LR, 0);
-    ledcWrite(MOTOR_PWM_CHANNEL_RF, 0);
-    ledcWrite(MOTOR_PWM_CHANNEL_RR, 0);
+    // Disarm the watchdog so it does not fire for an already stopped robot.
+    // It will only fire again after new commands arrive and another timeout occurs.
+    esp_timer_stop(failsafeTimer_);
     
+    xSemaphoreTake(outputLock_, portMAX_DELAY);
+    writeStop();
+    xSemaphoreGive(outputLock_);
+
+#ifdef FEATURE_BLACKBOX
+    if (blackBox_) {
+        blackBox_->recordMotor(0, 0);
+    }
+#endif
+}
+
+void MX1508MotorController::writeStop() {
+    // Остановка мгновенная: ограничитель сбрасывается вместе с целью
+    leftSlew_.reset();
+    rightSlew_.reset();
+    slewActive_ = false;
     currentLeftSpeed_ = 0;
     currentRightSpeed_ = 0;
-    // Reset lastCommandTime_ to prevent watchdog from firing repeatedly.
-    // Watchdog will only fire again after new commands arrive and another timeout occurs.
-    lastCommandTime_ = 0;
+    
+    // Выбег или тормоз - по режиму из настроек
+    applyMotorSpeed(0, 0);
+}
+
+bool MX1508MotorController::stepOutputs(bool force) {
+    // Вызывается под outputLock_
+    const bool leftChanged = leftSlew_.step();
+    const bool rightChanged = rightSlew_.step();
+    slewActive_ = !leftSlew_.isSettled() || !rightSlew_.isSettled();
+    if (!leftChanged && !rightChanged && !force) {
+        return false;
+    }
+    currentLeftSpeed_ = leftSlew_.getOutput();
+    currentRightSpeed_ = rightSlew_.getOutput();
+    applyMotorSpeed(currentLeftSpeed_, currentRightSpeed_);
+    return true;
+}
+
+void MX1508MotorController::slewTimerCallback(void* arg) {
+    static_cast<MX1508MotorController*>(arg)->onSlewTimer();
+}
+
+void MX1508MotorController::onSlewTimer() {
+    // Задача esp_timer: выход уже на цели - мьютекс не трогаем
+    if (!slewActive_) {
+        return;
+    }
+    xSemaphoreTake(outputLock_, portMAX_DELAY);
+    stepOutputs(false);
+    xSemaphoreGive(outputLock_);
+}
+
+void MX1508MotorController::failsafeTimerCallback(void* arg) {
+    static_cast<MX1508MotorController*>(arg)->onFailsafeTimer();
+}
+
+void MX1508MotorController::onFailsafeTimer() {
+    // Задача esp_timer: без вывода в UART и долгих ожиданий
+    uint32_t deadlineUs;
+    
+    // Команда пришла, пока таймер уже срабатывал: срок перенесен
+    if (!watchdog_.checkExpired((uint32_t)esp_timer_get_time(), deadlineUs)) {
+        return;
+    }
+    
+    xSemaphoreTake(outputLock_, portMAX_DELAY);
+    const bool moving = currentLeftSpeed_ != 0 || currentRightSpeed_ != 0 || slewActive_;
+    if (moving) {
+        writeStop();
+        // Не сбрасываем флаг здесь - он будет сброшен при следующей команде
+        watchdogTriggered_ = true;
+    }
+    xSemaphoreGive(outputLock_);
+    
+    if (!moving) {
+        return;
+    }
+    
+    // Задержка от срока до записи нулей в LEDC
+    const uint32_t stopUs = (uint32_t)esp_timer_get_time();
+    portENTER_CRITICAL(&statsMux_);
+    const uint32_t latencyUs = watchdog_.recordTrip(deadlineUs, stopUs);
+    portEXIT_CRITICAL(&statsMux_);
+    
+    FAST_LOG("Motor watchdog: stop, latency %u us", latencyUs);
+    
+#ifdef FEATURE_BLACKBOX
+    if (blackBox_) {
+        blackBox_->recordMotor(0, 0);
+    }
+#endif
 }
 
 void MX1508MotorController::getCurrentSpeed(int& leftSpeed, int& rightSpeed) const {
@@ -181,46 +361,53 @@ void MX1508MotorController::getCurrentSpeed(int& leftSpeed, int& rightSpeed) con
     rightSpeed = currentRightSpeed_;
 }
 
+// Состояние мотора для журнала (строка во flash - FAST_LOG хранит только адрес)
+static const char* motorStateName(int speed, int brake) {
+    if (brake > 0) {
+        return "BRAKE";
+    }
+    if (brake == 0) {
+        return "STOP";
+    }
+    return speed > 0 ? "FWD" : "REV";
+}
+
 void MX1508MotorController::applyMotorSpeed(int leftSpeed, int rightSpeed) {
-    // Расчет максимального значения PWM с учетом ограничения мощности
-    const int maxPWM = (1 << MOTOR_PWM_RESOLUTION) - 1; // 8191 для 13-бит
-    const int limitedMaxPWM = (maxPWM * MOTOR_MAX_POWER_PERCENT) / 100;
-    
-    int leftPWM = 0;
-    int rightPWM = 0;
-    
-    // Левый мотор
-    if (leftSpeed > 0) {
-        leftPWM = map(leftSpeed, 0, 100, 0, limitedMaxPWM);
-        ledcWrite(MOTOR_PWM_CHANNEL_LF, leftPWM);
-        ledcWrite(MOTOR_PWM_CHANNEL_LR, 0);
-    } else if (leftSpeed < 0) {
-        leftPWM = map(-leftSpeed, 0, 100, 0, limitedMaxPWM);
-        ledcWrite(MOTOR_PWM_CHANNEL_LF, 0);
-        ledcWrite(MOTOR_PWM_CHANNEL_LR, leftPWM);
-    } else {
-        ledcWrite(MOTOR_PWM_CHANNEL_LF, 0);
-        ledcWrite(MOTOR_PWM_CHANNEL_LR, 0);
-    }
-    
-    // Правый мотор
-    if (rightSpeed > 0) {
-        rightPWM = map(rightSpeed, 0, 100, 0, limitedMaxPWM);
-        ledcWrite(MOTOR_PWM_CHANNEL_RF, rightPWM);
-        ledcWrite(MOTOR_PWM_CHANNEL_RR, 0);
-    } else if (rightSpeed < 0) {
-        rightPWM = map(-rightSpeed, 0, 100, 0, limitedMaxPWM);
-        ledcWrite(MOTOR_PWM_CHANNEL_RF, 0);
-        ledcWrite(MOTOR_PWM_CHANNEL_RR, rightPWM);
-    } else {
-        ledcWrite(MOTOR_PWM_CHANNEL_RF, 0);
-        ledcWrite(MOTOR_PWM_CHANNEL_RR, 0);
+    // Вызывается под outputLock_. Тормоз на участке реверса зависит от цели ограничителя
+    const int leftBrake = brakeDuty(leftSpeed, leftSlew_.getTarget());
+    const int rightBrake = brakeDuty(rightSpeed, rightSlew_.getTarget());
+    
+    const int leftPWM = writeMotor(MOTOR_PWM_CHANNEL_LF, MOTOR_PWM_CHANNEL_LR, leftSpeed, leftBrake);
+    const int rightPWM = writeMotor(MOTOR_PWM_CHANNEL_RF, MOTOR_PWM_CHANNEL_RR, rightSpeed, rightBrake);
+    
+    FAST_LOG("Motor PWM: L=%d (%s) R=%d (%s) [max=%d]",
+             leftPWM, motorStateName(leftSpeed, leftBrake),
+             rightPWM, motorStateName(rightSpeed, rightBrake),
+             kDriveMaxDuty);
+}
+
+static_assert(static_cast<uint8_t>(MotorBrakeMode::COAST) == DriveMixer::kBrakeCoast &&
+              static_cast<uint8_t>(MotorBrakeMode::BRAKE) == DriveMixer::kBrakeFull &&
+              static_cast<uint8_t>(MotorBrakeMode::PROPORTIONAL) == DriveMixer::kBrakeProportional,
+              "Режимы тормоза DriveMixer должны совпадать с MotorBrakeMode");
+
+int MX1508MotorController::brakeDuty(int speed, int target) const {
+    return DriveMixer::brakeDuty(speed, target, static_cast<uint8_t>(brakeMode_), brakeStrength_);
+}
+
+int MX1508MotorController::writeMotor(uint8_t fwdChannel, uint8_t revChannel, int speed, int brake) {
+    // MX1508: IN1 = IN2 - тормоз (HIGH) или выбег (LOW), ШИМ на одном входе - ход.
+    // Скважность из таблицы (ограничение мощности MOTOR_MAX_POWER_PERCENT уже учтено)
+    if (brake >= 0) {
+        ledcWrite(fwdChannel, brake);
+        ledcWrite(revChannel, brake);
+        return brake;
     }
     
-    DEBUG_PRINTF("Motor PWM: L=%d (%s) R=%d (%s) [max=%d]\n", 
-                 leftPWM, leftSpeed > 0 ? "FWD" : (leftSpeed < 0 ? "REV" : "STOP"),
-                 rightPWM, rightSpeed > 0 ? "FWD" : (rightSpeed < 0 ? "REV" : "STOP"),
-                 limitedMaxPWM);
+    const int duty = DriveMixer::duty(speed);
+    ledcWrite(fwdChannel, speed > 0 ? duty : 0);
+    ledcWrite(revChannel, speed < 0 ? duty : 0);
+    return duty;
 }
 
 int MX1508MotorController::constrainSpeed(int speed) const {
@@ -232,8 +419,34 @@ bool MX1508MotorController::wasWatchdogTriggered() const {
 }
 
 void MX1508MotorController::updateCommandTime() {
-    lastCommandTime_ = millis();
     watchdogTriggered_ = false;  // Сбрасываем флаг при получении новой команды
+    if (!failsafeTimer_) {
+        return;
+    }
+    
+    // Перезапуск одноразового таймера. Срок запоминается до запуска: таймер
+    // сверяет с ним время и не останавливает моторы, если команда пришла
+    // одновременно со срабатыванием
+    const uint32_t timeoutUs = watchdog_.rearm((uint32_t)esp_timer_get_time());
+    esp_timer_stop(failsafeTimer_);
+    esp_timer_start_once(failsafeTimer_, timeoutUs);
+}
+
+String MX1508MotorController::getFailsafeStatsJson() const {
+    portENTER_CRITICAL(&statsMux_);
+    const LatencyHistogram latency = watchdog_.getTripLatency();
+    const uint32_t trips = watchdog_.getTripCount();
+    portEXIT_CRITICAL(&statsMux_);
+    
+    String json = "{";
+    json += "\"timeoutMs\":" + String(MOTOR_COMMAND_TIMEOUT_MS) + ",";
+    json += "\"armed\":" + String(failsafeTimer_ && esp_timer_is_active(failsafeTimer_) ? "true" : "false") + ",";
+    json += "\"trips\":" + String(trips) + ",";
+    json += "\"tripLatencyAvgUs\":" + String(latency.getAvgUs()) + ",";
+    json += "\"tripLatencyP99Us\":" + String(latency.percentileUs(99)) + ",";
+    json += "\"tripLatencyMaxUs\":" + String(latency.getMaxUs());
+    json += "}";
+    return json;
 }
 
 #endif // FEATURE_MOTORS
@@ -0,0 +1,175 @@
+#include "StreamQualityController.h"
+#include "hardware_config.h"
+
+#ifdef FEATURE_CAMERA
+
+// Лестница качества: от лучшего к самому легкому кадру
+// Разрешение не поднимается выше стартового QVGA (размер буфера кадра камеры)
+static const StreamQualityController::OperatingPoint kQualityLadder[] = {
+    { 320, 240, 10 },   // QVGA, стартовая конфигурация BaseRobot::initCamera
+    { 320, 240, 14 },
+    { 320, 240, 20 },
+    { 320, 240, 30 },
+    { 240, 176, 20 },   // HQVGA
+    { 160, 120, 20 },   // QQVGA
+    { 160, 120, 35 },
+};
+static const int kLevelCount = sizeof(kQualityLadder) / sizeof(kQualityLadder[0]);
+static_assert(kLevelCount <= 8, "levelFrameBytes_ меньше лестницы качества");
+
+// Гистерезис: облегчаем кадр быстро, возвращаем качество медленно
+static const uint32_t kDegradePercent = 125;   // Задержка > 125% цели - перегрузка
+static const uint32_t kUpgradePercent = 60;    // Задержка < 60% цели - есть запас
+static const int kDegradeWindows = 2;
+static const int kUpgradeWindows = 5;
+
+// Канал занят отправкой больше 75% окна - кадры идут почти без пауз, и FPS
+// ограничивает уже канал, а не камера или лимит зрителя
+static const uint32_t kBusyPercent = 75;
+
+StreamQualityController::StreamQualityController() :
+    enabled_(true),
+    targetLatencyMs_(STREAM_QC_TARGET_LATENCY_MS),
+    level_(0),
+    applyPending_(false),
+    windowStartMs_(0),
+    windowFrames_(0),
+    windowSendUs_(0),
+    windowBytes_(0),
+    overCount_(0),
+    underCount_(0),
+    avgSendUs_(0),
+    avgFrameBytes_(0),
+    fps_(0.0f)
+{
+    for (int i = 0; i < kMaxLevels; i++) {
+        levelFrameBytes_[i] = 0;
+    }
+}
+
+void StreamQualityController::setEnabled(bool enabled) {
+    enabled_ = enabled;
+    overCount_ = 0;
+    underCount_ = 0;
+    // Без регулировки сенсор должен вернуться к исходной ступени
+    if (!enabled && level_ != 0) {
+        level_ = 0;
+        applyPending_ = true;
+    }
+}
+
+void StreamQualityController::setTargetLatencyMs(uint32_t targetMs) {
+    if (targetMs < 10) {
+        targetMs = 10;
+    }
+    targetLatencyMs_ = targetMs;
+    overCount_ = 0;
+    underCount_ = 0;
+}
+
+void StreamQualityController::onFrameSent(uint32_t sendUs, uint32_t jpegBytes) {
+    windowFrames_++;
+    windowSendUs_ += sendUs;
+    windowBytes_ += jpegBytes;
+}
+
+int StreamQualityController::getLevelCount() {
+    return kLevelCount;
+}
+
+const StreamQualityController::OperatingPoint& StreamQualityController::getOperatingPoint() const {
+    return kQualityLadder[level_];
+}
+
+uint32_t StreamQualityController::estimateFrameBytes(int level) const {
+    if (levelFrameBytes_[level]) {
+        return levelFrameBytes_[level];
+    }
+    // Размер JPEG примерно пропорционален числу пикселей и обратно
+    // пропорционален jpeg_quality
+    const OperatingPoint& from = kQualityLadder[level_];
+    const OperatingPoint& to = kQualityLadder[level];
+    return (uint32_t)((uint64_t)avgFrameBytes_ * to.width * to.height * from.quality /
+                      ((uint64_t)from.width * from.height * to.quality));
+}
+
+void StreamQualityController::resetWindow(uint32_t nowMs) {
+    windowStartMs_ = nowMs;
+    windowFrames_ = 0;
+    windowSendUs_ = 0;
+    windowBytes_ = 0;
+}
+
+bool StreamQualityController::evaluate(uint32_t nowMs) {
+    if (applyPending_) {
+        applyPending_ = false;
+        resetWindow(nowMs);
+        return true;
+    }
+
+    uint32_t elapsed = nowMs - windowStartMs_;
+    if (elapsed < STREAM_QC_WINDOW_MS) {
+        return false;
+    }
+
+    if (windowFrames_ == 0) {
+        // Нет зрителей - нечего измерять, ступень сохраняем
+        fps_ = 0.0f;
+        resetWindow(nowMs);
+        return false;
+    }
+
+    avgSendUs_ = (uint32_t)(windowSendUs_ / windowFrames_);
+    avgFrameBytes_ = (uint32_t)(windowBytes_ / windowFrames_);
+    fps_ = windowFrames_ * 1000.0f / elapsed;
+    // Доля окна, занятая отправкой (суммарно по зрителям)
+    const uint64_t busyPercent = windowSendUs_ / 10 / elapsed;
+    resetWindow(nowMs);
+
+    if (!enabled_) {
+        return false;
+    }
+    levelFrameBytes_[level_] = avgFrameBytes_;
+
+    const uint64_t targetUs = targetLatencyMs_ * 1000ULL;
+    const bool slow = avgSendUs_ * 100ULL > targetUs * kDegradePercent;
+    const bool saturated = busyPercent > kBusyPercent && fps_ < STREAM_QC_MIN_FPS;
+
+    // Время отправки растет с размером кадра: прогноз для ступени выше
+    // по ее размеру JPEG, чтобы не подниматься туда, откуда сразу уйдем
+    // по задержке или по FPS
+    bool roomToUpgrade = false;
+    if (level_ > 0 && avgFrameBytes_ > 0) {
+        const uint64_t projectedUs = (uint64_t)avgSendUs_ * estimateFrameBytes(level_ - 1) / avgFrameBytes_;
+        roomToUpgrade = avgSendUs_ * 100ULL < targetUs * kUpgradePercent && projectedUs < targetUs &&
+                        projectedUs * STREAM_QC_MIN_FPS < 1000000ULL;
+    }
+
+    int newLevel = level_;
+
+    if (slow || saturated) {
+        underCount_ = 0;
+        if (++overCount_ >= kDegradeWindows && level_ < kLevelCount - 1) {
+            newLevel = level_ + 1;
+        }
+    } else if (roomToUpgrade) {
+        overCount_ = 0;
+        if (++underCount_ >= kUpgradeWindows) {
+            newLevel = level_ - 1;
+        }
+    } else {
+        overCount_ = 0;
+        underCount_ = 0;
+    }
+
+    if (newLevel == level_) {
+        return false;
+    }
+
+    level_ = newLevel;
+    overCount_ = 0;
+    underCount_ = 0;
+    return true;
+}
+
+#endif // FEATURE_CAMERA
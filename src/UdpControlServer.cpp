@@ -0,0 +1,138 @@
+#include "UdpControlServer.h"
+
+#ifdef FEATURE_UDP_CONTROL
+
+#include "ControlPacket.h"
+
+UdpControlServer::Source::Source() :
+    used(false),
+    ip(0),
+    port(0),
+    lastSeenMs(0),
+    sequencer(CONTROL_UDP_MAX_AGE_MS, CONTROL_UDP_SESSION_TIMEOUT_MS, CONTROL_UDP_BASELINE_WINDOW_MS)
+{
+}
+
+UdpControlServer::UdpControlServer() :
+    port_(0),
+    malformed_(0),
+    mux_(portMUX_INITIALIZER_UNLOCKED)
+{
+}
+
+bool UdpControlServer::begin(uint16_t port, CommandHandler handler) {
+    handler_ = handler;
+    if (!udp_.listen(port)) {
+        DEBUG_PRINTF("ОШИБКА: UDP канал управления не открыт на порту %u\n", port);
+        return false;
+    }
+    port_ = port;
+    udp_.onPacket([this](AsyncUDPPacket& packet) {
+        handlePacket(packet);
+    });
+    DEBUG_PRINTF("UDP канал управления: порт %u\n", port);
+    return true;
+}
+
+void UdpControlServer::end() {
+    udp_.close();
+    port_ = 0;
+}
+
+UdpControlServer::Source* UdpControlServer::findSource(uint32_t ip, uint16_t port, uint32_t nowMs) {
+    Source* oldest = &sources_[0];
+    for (int i = 0; i < CONTROL_UDP_MAX_SOURCES; i++) {
+        Source& source = sources_[i];
+        if (source.used && source.ip == ip && source.port == port) {
+            return &source;
+        }
+        // Свободный слот или самый давно молчавший источник
+        if (oldest->used && (!source.used || (int32_t)(source.lastSeenMs - oldest->lastSeenMs) < 0)) {
+            oldest = &source;
+        }
+    }
+    oldest->used = true;
+    oldest->ip = ip;
+    oldest->port = port;
+    oldest->lastSeenMs = nowMs;
+    oldest->sequencer.reset();
+    return oldest;
+}
+
+// Задача async_udp
+void UdpControlServer::handlePacket(AsyncUDPPacket& packet) {
+    ControlPacket command;
+    if (!decodeControlPacket(packet.data(), packet.length(), command) ||
+        command.type != CONTROL_PACKET_COMMAND) {
+        portENTER_CRITICAL(&mux_);
+        malformed_++;
+        portEXIT_CRITICAL(&mux_);
+        return;
+    }
+
+    const uint32_t nowMs = millis();
+    portENTER_CRITICAL(&mux_);
+    Source* source = findSource((uint32_t)packet.remoteIP(), packet.remotePort(), nowMs);
+    source->lastSeenMs = nowMs;
+    ControlSequencer::Verdict verdict = source->sequencer.accept(command.seq, command.clientTimeMs, nowMs);
+    portEXIT_CRITICAL(&mux_);
+
+    // Остановка принимается всегда: устаревший стоп безопасен
+    if (command.flags & CONTROL_FLAG_STOP) {
+        handler_(1500, 1500);
+    } else if (verdict == ControlSequencer::ACCEPTED) {
+        handler_(command.throttle, command.steering);
+    }
+
+    // Подтверждение только по запросу и только для принятых пакетов:
+    // клиент видит по ACK, что команда дошла свежей
+    if ((command.flags & CONTROL_FLAG_ACK) && verdict == ControlSequencer::ACCEPTED) {
+        uint8_t ack[CONTROL_PACKET_SIZE];
+        command.type = CONTROL_PACKET_ACK;
+        packet.write(ack, encodeControlPacket(command, ack));
+    }
+}
+
+String UdpControlServer::getStatsJson() {
+    // Копия под mux_, JSON собирается без него (выделение памяти)
+    Source sources[CONTROL_UDP_MAX_SOURCES];
+    portENTER_CRITICAL(&mux_);
+    for (int i = 0; i < CONTROL_UDP_MAX_SOURCES; i++) {
+        sources[i] = sources_[i];
+    }
+    const uint32_t malformed = malformed_;
+    portEXIT_CRITICAL(&mux_);
+
+    const uint32_t nowMs = millis();
+    String json = "{";
+    json += "\"port\":" + String(port_) + ",";
+    json += "\"malformed\":" + String(malformed) + ",";
+    json += "\"sources\":[";
+    bool first = true;
+    for (int i = 0; i < CONTROL_UDP_MAX_SOURCES; i++) {
+        const Source& source = sources[i];
+        if (!source.used) {
+            continue;
+        }
+        const ControlSequencer::Stats& stats = source.sequencer.getStats();
+        if (!first) json += ",";
+        first = false;
+        json += "{";
+        json += "\"address\":\"" + IPAddress(source.ip).toString() + ":" + String(source.port) + "\",";
+        json += "\"idleMs\":" + String(nowMs - source.lastSeenMs) + ",";
+        json += "\"lastSeq\":" + String(source.sequencer.getLastSeq()) + ",";
+        json += "\"lastAgeMs\":" + String(source.sequencer.getLastAgeMs()) + ",";
+        json += "\"received\":" + String(stats.received) + ",";
+        json += "\"accepted\":" + String(stats.accepted) + ",";
+        json += "\"lost\":" + String(stats.lost) + ",";
+        json += "\"reordered\":" + String(stats.reordered) + ",";
+        json += "\"duplicates\":" + String(stats.duplicates) + ",";
+        json += "\"stale\":" + String(stats.stale) + ",";
+        json += "\"resets\":" + String(stats.resets);
+        json += "}";
+    }
+    json += "]}";
+    return json;
+}
+
+#endif // FEATURE_UDP_CONTROL
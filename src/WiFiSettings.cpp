@@ -2,6 +2,21 @@
 #include "hardware_config.h"
 #include <WiFi.h>
 
+// Плавность моторов по умолчанию (без моторов в сборке - без ограничения)
+#ifdef FEATURE_MOTORS
+  #define DEFAULT_MOTOR_ACCEL_RATE MOTOR_SLEW_ACCEL_DEFAULT
+  #define DEFAULT_MOTOR_DECEL_RATE MOTOR_SLEW_DECEL_DEFAULT
+  #define DEFAULT_MOTOR_REVERSE_RATE MOTOR_SLEW_REVERSE_DEFAULT
+  #define DEFAULT_MOTOR_BRAKE_MODE MOTOR_BRAKE_MODE_DEFAULT
+  #define DEFAULT_MOTOR_BRAKE_STRENGTH MOTOR_BRAKE_STRENGTH_DEFAULT
+#else
+  #define DEFAULT_MOTOR_ACCEL_RATE 0
+  #define DEFAULT_MOTOR_DECEL_RATE 0
+  #define DEFAULT_MOTOR_REVERSE_RATE 0
+  #define DEFAULT_MOTOR_BRAKE_MODE 0
+  #define DEFAULT_MOTOR_BRAKE_STRENGTH 0
+#endif
+
 WiFiSettings::WiFiSettings() : 
     ssid(""),
     password(""),
@@ -10,10 +25,16 @@ WiFiSettings::WiFiSettings() :
     motorSwapLeftRight(false),
     motorInvertLeft(false),
     motorInvertRight(false),
+    motorAccelRate(DEFAULT_MOTOR_ACCEL_RATE),
+    motorDecelRate(DEFAULT_MOTOR_DECEL_RATE),
+    motorReverseRate(DEFAULT_MOTOR_REVERSE_RATE),
+    motorBrakeMode(static_cast<MotorBrakeMode>(DEFAULT_MOTOR_BRAKE_MODE)),
+    motorBrakeStrength(DEFAULT_MOTOR_BRAKE_STRENGTH),
     invertThrottleStick(false),
     invertSteeringStick(false),
     cameraHMirror(false),
     cameraVFlip(false),
+    cameraProfileName(""),
     effectMode(0)
 {
 }
@@ -50,6 +71,13 @@ void WiFiSettings::loadDefaults() {
     motorInvertLeft = false;
     motorInvertRight = false;
     
+    // Плавность разгона/торможения моторов
+    motorAccelRate = DEFAULT_MOTOR_ACCEL_RATE;
+    motorDecelRate = DEFAULT_MOTOR_DECEL_RATE;
+    motorReverseRate = DEFAULT_MOTOR_REVERSE_RATE;
+    motorBrakeMode = static_cast<MotorBrakeMode>(DEFAULT_MOTOR_BRAKE_MODE);
+    motorBrakeStrength = DEFAULT_MOTOR_BRAKE_STRENGTH;
+    
     // По умолчанию стики не инвертированы (нормальное управление)
     invertThrottleStick = false;
     invertSteeringStick = false;
@@ -57,6 +85,7 @@ void WiFiSettings::loadDefaults() {
     // По умолчанию камера без зеркалирования и переворота
     cameraHMirror = false;
     cameraVFlip = false;
+    cameraProfileName = "";
     
     // По умолчанию эффект normal (0)
     effectMode = 0;
@@ -91,6 +120,11 @@ void WiFiSettings::loadFromMemory() {
         motorSwapLeftRight = preferences.getBool("motorSwap", false);
         motorInvertLeft = preferences.getBool("motorInvL", false);
         motorInvertRight = preferences.getBool("motorInvR", false);
+        motorAccelRate = preferences.getInt("motorAccel", DEFAULT_MOTOR_ACCEL_RATE);
+        motorDecelRate = preferences.getInt("motorDecel", DEFAULT_MOTOR_DECEL_RATE);
+        motorReverseRate = preferences.getInt("motorReverse", DEFAULT_MOTOR_REVERSE_RATE);
+        motorBrakeMode = static_cast<MotorBrakeMode>(preferences.getUChar("motorBrake", DEFAULT_MOTOR_BRAKE_MODE));
+        motorBrakeStrength = preferences.getInt("motorBrakePwr", DEFAULT_MOTOR_BRAKE_STRENGTH);
         
         // Загружаем настройки инверсии стиков
         invertThrottleStick = preferences.getBool("invThrottle", false);
@@ -99,6 +133,7 @@ void WiFiSettings::loadFromMemory() {
         // Загружаем настройки камеры
         cameraHMirror = preferences.getBool("camHMirror", false);
         cameraVFlip = preferences.getBool("camVFlip", false);
+        cameraProfileName = preferences.getString("camProfile", "");
         
         // Загружаем настройки эффектов
         effectMode = preferences.getInt("effectMode", 0);
@@ -111,10 +146,15 @@ void WiFiSettings::loadFromMemory() {
         DEBUG_PRINT("    Motor swap L/R: "); DEBUG_PRINTLN(motorSwapLeftRight ? "YES" : "NO");
         DEBUG_PRINT("    Motor invert L: "); DEBUG_PRINTLN(motorInvertLeft ? "YES" : "NO");
         DEBUG_PRINT("    Motor invert R: "); DEBUG_PRINTLN(motorInvertRight ? "YES" : "NO");
+        DEBUG_PRINTF("    Motor slew: accel %d, decel %d, reverse %d %%/s\n",
+                     motorAccelRate, motorDecelRate, motorReverseRate);
+        DEBUG_PRINTF("    Motor brake: mode %d, strength %d%%\n",
+                     static_cast<int>(motorBrakeMode), motorBrakeStrength);
         DEBUG_PRINT("    Invert Throttle: "); DEBUG_PRINTLN(invertThrottleStick ? "YES" : "NO");
         DEBUG_PRINT("    Invert Steering: "); DEBUG_PRINTLN(invertSteeringStick ? "YES" : "NO");
         DEBUG_PRINT("    Camera HMirror: "); DEBUG_PRINTLN(cameraHMirror ? "YES" : "NO");
         DEBUG_PRINT("    Camera VFlip: "); DEBUG_PRINTLN(cameraVFlip ? "YES" : "NO");
+        DEBUG_PRINT("    Camera Profile: '"); DEBUG_PRINT(cameraProfileName); DEBUG_PRINTLN("'");
         DEBUG_PRINT("    Effect Mode: "); DEBUG_PRINTLN(effectMode);
         
         // ВАЖНО: Если SSID пустой - это значит старые битые настройки, сбрасываем!
@@ -154,6 +194,26 @@ void WiFiSettings::setMotorInvertRight(bool value) {
     motorInvertRight = value;
 }
 
+void WiFiSettings::setMotorAccelRate(int value) {
+    motorAccelRate = value;
+}
+
+void WiFiSettings::setMotorDecelRate(int value) {
+    motorDecelRate = value;
+}
+
+void WiFiSettings::setMotorReverseRate(int value) {
+    motorReverseRate = value;
+}
+
+void WiFiSettings::setMotorBrakeMode(MotorBrakeMode value) {
+    motorBrakeMode = value;
+}
+
+void WiFiSettings::setMotorBrakeStrength(int value) {
+    motorBrakeStrength = value;
+}
+
 void WiFiSettings::setInvertThrottleStick(bool value) {
     invertThrottleStick = value;
 }
@@ -170,6 +230,10 @@ void WiFiSettings::setCameraVFlip(bool value) {
     cameraVFlip = value;
 }
 
+void WiFiSettings::setCameraProfileName(const String& value) {
+    cameraProfileName = value;
+}
+
 void WiFiSettings::setEffectMode(int value) {
     effectMode = value;
 }
@@ -183,10 +247,15 @@ bool WiFiSettings::save() {
     DEBUG_PRINT("  Motor swap L/R: "); DEBUG_PRINTLN(motorSwapLeftRight ? "YES" : "NO");
     DEBUG_PRINT("  Motor invert L: "); DEBUG_PRINTLN(motorInvertLeft ? "YES" : "NO");
     DEBUG_PRINT("  Motor invert R: "); DEBUG_PRINTLN(motorInvertRight ? "YES" : "NO");
+    DEBUG_PRINTF("  Motor slew: accel %d, decel %d, reverse %d %%/s\n",
+                 motorAccelRate, motorDecelRate, motorReverseRate);
+    DEBUG_PRINTF("  Motor brake: mode %d, strength %d%%\n",
+                 static_cast<int>(motorBrakeMode), motorBrakeStrength);
     DEBUG_PRINT("  Invert Throttle: "); DEBUG_PRINTLN(invertThrottleStick ? "YES" : "NO");
     DEBUG_PRINT("  Invert Steering: "); DEBUG_PRINTLN(invertSteeringStick ? "YES" : "NO");
     DEBUG_PRINT("  Camera HMirror: "); DEBUG_PRINTLN(cameraHMirror ? "YES" : "NO");
     DEBUG_PRINT("  Camera VFlip: "); DEBUG_PRINTLN(cameraVFlip ? "YES" : "NO");
+    DEBUG_PRINT("  Camera Profile: '"); DEBUG_PRINT(cameraProfileName); DEBUG_PRINTLN("'");
     DEBUG_PRINT("  Effect Mode: "); DEBUG_PRINTLN(effectMode);
     
     // Сохраняем все настройки и проверяем результат каждой операции
@@ -200,6 +269,11 @@ bool WiFiSettings::save() {
     size_t w6 = preferences.putBool("motorSwap", motorSwapLeftRight);
     size_t w7 = preferences.putBool("motorInvL", motorInvertLeft);
     size_t w8 = preferences.putBool("motorInvR", motorInvertRight);
+    preferences.putInt("motorAccel", motorAccelRate);
+    preferences.putInt("motorDecel", motorDecelRate);
+    preferences.putInt("motorReverse", motorReverseRate);
+    preferences.putUChar("motorBrake", static_cast<uint8_t>(motorBrakeMode));
+    preferences.putInt("motorBrakePwr", motorBrakeStrength);
     
     // Сохраняем настройки инверсии стиков
     size_t w9 = preferences.putBool("invThrottle", invertThrottleStick);
@@ -208,6 +282,8 @@ bool WiFiSettings::save() {
     // Сохраняем настройки камеры
     size_t w11 = preferences.putBool("camHMirror", cameraHMirror);
     size_t w12 = preferences.putBool("camVFlip", cameraVFlip);
+    // Пустая строка - допустимое значение (профиль по умолчанию), putString вернет 0
+    preferences.putString("camProfile", cameraProfileName);
     
     // Сохраняем настройки эффектов
     size_t w13 = preferences.putInt("effectMode", effectMode);
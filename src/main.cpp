@@ -4,6 +4,7 @@
 #include "IRobot.h"
 #include "FirmwareUpdate.h"
 #include "WiFiSettings.h"
+#include "FastLog.h"
 #include <Preferences.h>
 #include <ESPAsyncWebServer.h>
 #ifdef USE_EMBEDDED_RESOURCES
@@ -51,6 +52,11 @@ void setup() {
     Serial.println(ROBOT_NAME);
     Serial.println("═══════════════════════════════════════");
     
+#ifdef DEBUG
+    // Выгрузка FAST_LOG из кольца в UART (горячие пути не ждут Serial)
+    FastLog::begin();
+#endif
+    
 #ifdef FEATURE_NEOPIXEL
     // Защита GPIO2 (strapping pin для NeoPixel)
     pinMode(NEOPIXEL_PIN, OUTPUT);
@@ -238,9 +244,9 @@ void setup() {
 
 void loop() {
     if (robot) {
+        // Робот сам спит до ближайшей задачи планировщика
         robot->loop();
+    } else {
+        delay(10);
     }
-    
-    // Небольшая задержка для стабильности
-    delay(10);
 }
@@ -0,0 +1,175 @@
+// Профили сенсора камеры (CameraProfile): маска записи регистров по
+// известному состоянию сенсора, зеркало/переворот из настроек.
+// pio test -e native
+#include <unity.h>
+#include "CameraProfile.h"
+
+// Значения, которые писал initCamera до профилей (прежние настройки всех роботов)
+static const int16_t kBaselineInit[CAM_PARAM_COUNT] = {
+    0, 0, 0, 0,  1, 1, 0,  1, 0, 0, 300,  1, 0, 0,  0, 1, 1, 1,  0, 0, 1, 0
+};
+
+static CameraProfileState* state;
+
+void setUp(void) {
+    state = new CameraProfileState();
+}
+
+void tearDown(void) {
+    delete state;
+    state = nullptr;
+}
+
+static uint32_t bit(CameraParam param) {
+    return 1UL << param;
+}
+
+static const uint32_t kAllParams = (1UL << CAM_PARAM_COUNT) - 1;
+
+// Как BaseRobot::applyCameraProfile при успешной записи каждого регистра
+static int applyAll(const int16_t target[CAM_PARAM_COUNT]) {
+    const uint32_t mask = state->diff(target);
+    int writes = 0;
+    for (int i = 0; i < CAM_PARAM_COUNT; i++) {
+        if ((mask >> i) & 1) {
+            state->markApplied((CameraParam)i, target[i]);
+            writes++;
+        }
+    }
+    return writes;
+}
+
+static const CameraProfile& profile(const char* name) {
+    const CameraProfile* found = findCameraProfile(name);
+    TEST_ASSERT_NOT_NULL(found);
+    return *found;
+}
+
+void test_unknown_state_writes_everything(void) {
+    int16_t target[CAM_PARAM_COUNT];
+    resolveCameraProfile(profile("driving"), false, false, target);
+    TEST_ASSERT_EQUAL_HEX32(kAllParams, state->diff(target));
+    for (int i = 0; i < CAM_PARAM_COUNT; i++) {
+        TEST_ASSERT_FALSE(state->isKnown((CameraParam)i));
+    }
+}
+
+void test_driving_matches_baseline_init(void) {
+    // Профиль по умолчанию не меняет кадр относительно прежнего initCamera
+    int16_t target[CAM_PARAM_COUNT];
+    resolveCameraProfile(profile("driving"), false, false, target);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(kBaselineInit, target, CAM_PARAM_COUNT);
+}
+
+void test_seeded_state_writes_only_differences(void) {
+    state->seed(kBaselineInit);
+    int16_t target[CAM_PARAM_COUNT];
+
+    resolveCameraProfile(profile("driving"), false, false, target);
+    TEST_ASSERT_EQUAL_HEX32(0, state->diff(target));
+
+    resolveCameraProfile(profile("line"), false, false, target);
+    TEST_ASSERT_EQUAL_HEX32(bit(CAM_CONTRAST) | bit(CAM_SATURATION) |
+                            bit(CAM_GAINCEILING) | bit(CAM_BPC),
+                            state->diff(target));
+}
+
+void test_profile_switches_are_incremental(void) {
+    state->seed(kBaselineInit);
+    int16_t target[CAM_PARAM_COUNT];
+
+    resolveCameraProfile(profile("line"), false, false, target);
+    TEST_ASSERT_EQUAL(4, applyAll(target));
+    TEST_ASSERT_EQUAL(2, state->get(CAM_CONTRAST));
+    // Повторное применение того же профиля ничего не пишет
+    TEST_ASSERT_EQUAL(0, applyAll(target));
+
+    resolveCameraProfile(profile("low-light"), false, false, target);
+    TEST_ASSERT_EQUAL_HEX32(bit(CAM_BRIGHTNESS) | bit(CAM_CONTRAST) | bit(CAM_SATURATION) |
+                            bit(CAM_AEC2) | bit(CAM_AE_LEVEL) | bit(CAM_GAINCEILING),
+                            state->diff(target));
+    applyAll(target);
+
+    resolveCameraProfile(profile("driving"), false, false, target);
+    applyAll(target);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(kBaselineInit, target, CAM_PARAM_COUNT);
+    for (int i = 0; i < CAM_PARAM_COUNT; i++) {
+        TEST_ASSERT_EQUAL(kBaselineInit[i], state->get((CameraParam)i));
+    }
+}
+
+void test_failed_write_is_retried(void) {
+    state->seed(kBaselineInit);
+    int16_t target[CAM_PARAM_COUNT];
+    resolveCameraProfile(profile("line"), false, false, target);
+
+    // Контраст записать не удалось: markApplied не вызван
+    const uint32_t mask = state->diff(target);
+    for (int i = 0; i < CAM_PARAM_COUNT; i++) {
+        if (((mask >> i) & 1) && i != CAM_CONTRAST) {
+            state->markApplied((CameraParam)i, target[i]);
+        }
+    }
+    TEST_ASSERT_EQUAL_HEX32(bit(CAM_CONTRAST), state->diff(target));
+}
+
+void test_mirror_and_flip_come_from_settings(void) {
+    state->seed(kBaselineInit);
+    int16_t target[CAM_PARAM_COUNT];
+
+    // Значения профиля для зеркала/переворота не используются
+    resolveCameraProfile(profile("driving"), true, false, target);
+    TEST_ASSERT_EQUAL(1, target[CAM_HMIRROR]);
+    TEST_ASSERT_EQUAL(0, target[CAM_VFLIP]);
+    TEST_ASSERT_EQUAL_HEX32(bit(CAM_HMIRROR), state->diff(target));
+    applyAll(target);
+
+    // Смена профиля сохраняет зеркало из настроек
+    resolveCameraProfile(profile("line"), true, false, target);
+    TEST_ASSERT_EQUAL(0, state->diff(target) & (bit(CAM_HMIRROR) | bit(CAM_VFLIP)));
+
+    // /api/camera/apply: профиль тот же, поменялся только переворот
+    resolveCameraProfile(profile("driving"), true, true, target);
+    TEST_ASSERT_EQUAL_HEX32(bit(CAM_VFLIP), state->diff(target));
+}
+
+void test_reset_forgets_state(void) {
+    state->seed(kBaselineInit);
+    state->reset();
+    TEST_ASSERT_EQUAL_HEX32(kAllParams, state->diff(kBaselineInit));
+
+    state->markApplied(CAM_DCW, 1);
+    TEST_ASSERT_TRUE(state->isKnown(CAM_DCW));
+    TEST_ASSERT_EQUAL_HEX32(kAllParams & ~bit(CAM_DCW), state->diff(kBaselineInit));
+
+    // Параметр вне перечня игнорируется
+    state->markApplied(CAM_PARAM_COUNT, 1);
+    TEST_ASSERT_EQUAL_HEX32(kAllParams & ~bit(CAM_DCW), state->diff(kBaselineInit));
+}
+
+void test_profile_lookup(void) {
+    TEST_ASSERT_NULL(findCameraProfile(nullptr));
+    TEST_ASSERT_NULL(findCameraProfile("sunset"));
+    TEST_ASSERT_GREATER_THAN(0, getCameraProfileCount());
+    for (int i = 0; i < getCameraProfileCount(); i++) {
+        TEST_ASSERT_TRUE(findCameraProfile(getCameraProfile(i).name) == &getCameraProfile(i));
+    }
+    // Индекс вне диапазона - первый профиль
+    TEST_ASSERT_TRUE(&getCameraProfile(-1) == &getCameraProfile(0));
+    TEST_ASSERT_TRUE(&getCameraProfile(getCameraProfileCount()) == &getCameraProfile(0));
+    TEST_ASSERT_EQUAL_STRING("hmirror", getCameraParamName(CAM_HMIRROR));
+    TEST_ASSERT_EQUAL_STRING("colorbar", getCameraParamName(CAM_COLORBAR));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_unknown_state_writes_everything);
+    RUN_TEST(test_driving_matches_baseline_init);
+    RUN_TEST(test_seeded_state_writes_only_differences);
+    RUN_TEST(test_profile_switches_are_incremental);
+    RUN_TEST(test_failed_write_is_retried);
+    RUN_TEST(test_mirror_and_flip_come_from_settings);
+    RUN_TEST(test_reset_forgets_state);
+    RUN_TEST(test_profile_lookup);
+    return UNITY_END();
+}
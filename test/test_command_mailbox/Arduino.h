@@ -0,0 +1,28 @@
+#ifndef TEST_ARDUINO_STUB_H
+#define TEST_ARDUINO_STUB_H
+
+// Заглушка Arduino.h/FreeRTOS для CommandMailbox на ПК: constrain и
+// уведомление задачи-читателя (счетчик, как у xTaskNotifyGive)
+
+#include <stdint.h>
+#include <atomic>
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef std::atomic<uint32_t>* TaskHandle_t;
+typedef uint32_t TickType_t;
+#define pdTRUE 1
+
+inline void xTaskNotifyGive(TaskHandle_t task) {
+    task->fetch_add(1);
+}
+
+// Единственный читатель в тесте ждет на одном счетчике
+extern std::atomic<uint32_t> testWaiterNotifications;
+
+inline uint32_t ulTaskNotifyTake(int clearOnExit, TickType_t timeout) {
+    (void)timeout;
+    return clearOnExit ? testWaiterNotifications.exchange(0) : testWaiterNotifications.load();
+}
+
+#endif // TEST_ARDUINO_STUB_H
@@ -0,0 +1,181 @@
+// Почтовый ящик команды (CommandMailbox): несколько сетевых задач пишут,
+// цикл управления читает. Arduino.h и CommandTrace - заглушки теста.
+// pio test -e native
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Заглушка трассировки: запоминает seq записей и выборок
+#define COMMAND_TRACE_H
+static const int kSeqCount = 4096;                  // seq в ящике 12-битный
+static std::atomic<uint32_t> postedPerSeq[kSeqCount];
+static std::atomic<int> lastTakenSeq;
+
+struct CommandTrace {
+    static void posted(uint16_t seq) { postedPerSeq[seq].fetch_add(1); }
+    static void taken(uint16_t seq) { lastTakenSeq = seq; }
+};
+
+#include "CommandMailbox.h"
+
+std::atomic<uint32_t> testWaiterNotifications;
+
+static CommandMailbox* mailbox;
+
+void setUp(void) {
+    mailbox = new CommandMailbox();
+    for (auto& count : postedPerSeq) {
+        count = 0;
+    }
+    lastTakenSeq = 0;
+    testWaiterNotifications = 0;
+}
+
+void tearDown(void) {
+    delete mailbox;
+    mailbox = nullptr;
+}
+
+// Пара писателя: руль однозначно выводится из газа, смешанная пара видна сразу
+static int steeringFor(int throttle) {
+    return 1000 + ((throttle - 1000) * 7 + 13) % 1001;
+}
+
+void test_empty_mailbox_has_no_command(void) {
+    int throttle = 0;
+    int steering = 0;
+    TEST_ASSERT_FALSE(mailbox->take(throttle, steering));
+    mailbox->peek(throttle, steering);
+    TEST_ASSERT_EQUAL(1500, throttle);
+    TEST_ASSERT_EQUAL(1500, steering);
+}
+
+void test_take_returns_each_write_once(void) {
+    int throttle = 0;
+    int steering = 0;
+    mailbox->post(1600, 1400);
+    TEST_ASSERT_TRUE(mailbox->take(throttle, steering));
+    TEST_ASSERT_EQUAL(1600, throttle);
+    TEST_ASSERT_EQUAL(1400, steering);
+    TEST_ASSERT_FALSE(mailbox->take(throttle, steering));
+
+    // Та же команда повторно - новая запись (seq отличает)
+    mailbox->post(1600, 1400);
+    TEST_ASSERT_TRUE(mailbox->take(throttle, steering));
+}
+
+void test_values_are_limited_to_pwm_range(void) {
+    int throttle = 0;
+    int steering = 0;
+    mailbox->post(500, 2500);
+    TEST_ASSERT_TRUE(mailbox->take(throttle, steering));
+    TEST_ASSERT_EQUAL(1000, throttle);
+    TEST_ASSERT_EQUAL(2000, steering);
+}
+
+void test_last_write_wins(void) {
+    int throttle = 0;
+    int steering = 0;
+    mailbox->post(1100, 1200);
+    mailbox->post(1300, 1400);
+    mailbox->post(1900, 1000);
+    TEST_ASSERT_TRUE(mailbox->take(throttle, steering));
+    TEST_ASSERT_EQUAL(1900, throttle);
+    TEST_ASSERT_EQUAL(1000, steering);
+    TEST_ASSERT_FALSE(mailbox->take(throttle, steering));
+}
+
+void test_seq_wraps_around(void) {
+    int throttle = 0;
+    int steering = 0;
+    for (int i = 0; i < kSeqCount * 3; i++) {
+        mailbox->post(1000 + i % 1001, 1500);
+        TEST_ASSERT_TRUE(mailbox->take(throttle, steering));
+        TEST_ASSERT_EQUAL(1000 + i % 1001, throttle);
+    }
+}
+
+void test_each_write_notifies_waiter(void) {
+    mailbox->attachWaiter(&testWaiterNotifications);
+    mailbox->post(1600, 1500);
+    mailbox->post(1700, 1500);
+    TEST_ASSERT_EQUAL_UINT32(2, testWaiterNotifications.load());
+    TEST_ASSERT_TRUE(mailbox->wait(0));
+    TEST_ASSERT_FALSE(mailbox->wait(0));
+}
+
+// Писатели в отдельных потоках (async_tcp, async_udp, ...) и один читатель:
+// ни одной смешанной пары, seq выборок идет только вперед, ни одна запись
+// не потеряна и не получила чужой seq
+void test_concurrent_writers_single_reader(void) {
+    const int kWriters = 4;
+    const uint32_t kRounds = 25;
+    const uint32_t kPostsPerWriter = kSeqCount / kWriters * kRounds;
+    std::atomic<int> writersDone(0);
+    mailbox->attachWaiter(&testWaiterNotifications);
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kWriters; w++) {
+        writers.emplace_back([w, &writersDone]() {
+            for (uint32_t i = 0; i < kPostsPerWriter; i++) {
+                const int throttle = 1000 + (w * 250 + i % 250) % 1001;
+                mailbox->post(throttle, steeringFor(throttle));
+                if (i % 16 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            writersDone++;
+        });
+    }
+
+    uint32_t takes = 0;
+    uint32_t torn = 0;
+    uint32_t backwards = 0;
+    int prevSeq = 0;
+    bool drained = false;
+    while (!drained) {
+        drained = writersDone.load() == kWriters;
+        int throttle = 0;
+        int steering = 0;
+        if (!mailbox->take(throttle, steering)) {
+            continue;
+        }
+        takes++;
+        if (steering != steeringFor(throttle)) {
+            torn++;
+        }
+        // Шаг seq по кругу: вперед и меньше половины круга
+        const int step = (lastTakenSeq.load() - prevSeq) & (kSeqCount - 1);
+        if (step == 0 || step >= kSeqCount / 2) {
+            backwards++;
+        }
+        prevSeq = lastTakenSeq.load();
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(0, backwards);
+    TEST_ASSERT_GREATER_THAN(0, takes);
+
+    // Каждая успешная запись увеличивает seq ровно на 1: за kRounds кругов
+    // каждый seq выдан ровно kRounds раз
+    for (int seq = 0; seq < kSeqCount; seq++) {
+        TEST_ASSERT_EQUAL_UINT32(kRounds, postedPerSeq[seq].load());
+    }
+    TEST_ASSERT_EQUAL_UINT32(kWriters * kPostsPerWriter, testWaiterNotifications.load());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_mailbox_has_no_command);
+    RUN_TEST(test_take_returns_each_write_once);
+    RUN_TEST(test_values_are_limited_to_pwm_range);
+    RUN_TEST(test_last_write_wins);
+    RUN_TEST(test_seq_wraps_around);
+    RUN_TEST(test_each_write_notifies_waiter);
+    RUN_TEST(test_concurrent_writers_single_reader);
+    return UNITY_END();
+}
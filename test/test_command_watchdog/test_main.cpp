@@ -0,0 +1,197 @@
+// Watchdog команд движения (CommandWatchdog) на модели одноразового
+// esp_timer: обработчик выполняется с задержкой диспетчеризации после
+// срабатывания, команда может прийти между ними. pio test -e native
+#include <unity.h>
+#include "CommandWatchdog.h"
+
+static const uint32_t kTimeoutUs = 500000;
+
+// Модель таймера и моторов MX1508MotorController
+struct SimFailsafe {
+    CommandWatchdog watchdog;
+    uint32_t nowUs;
+    uint32_t dispatchUs;        // От срабатывания таймера до выполнения обработчика
+    bool armed;
+    uint32_t fireAtUs;
+    bool handlerPending;
+    uint32_t handlerAtUs;
+    bool moving;
+    uint32_t stoppedAtUs;
+    int handlerRuns;
+
+    SimFailsafe(uint32_t startUs, uint32_t dispatch) :
+        watchdog(kTimeoutUs), nowUs(startUs), dispatchUs(dispatch), armed(false), fireAtUs(0),
+        handlerPending(false), handlerAtUs(0), moving(false), stoppedAtUs(0), handlerRuns(0) {}
+
+    static bool reached(uint32_t atUs, uint32_t limitUs) {
+        return (int32_t)(limitUs - atUs) >= 0;
+    }
+
+    // Как onFailsafeTimer
+    void runHandler(uint32_t atUs) {
+        handlerRuns++;
+        uint32_t deadlineUs;
+        if (!watchdog.checkExpired(atUs, deadlineUs)) {
+            return;
+        }
+        if (moving) {
+            moving = false;
+            stoppedAtUs = atUs;
+            watchdog.recordTrip(deadlineUs, atUs);
+        }
+    }
+
+    // События таймера по порядку до момента untilUs
+    void advanceTo(uint32_t untilUs) {
+        for (;;) {
+            if (armed && reached(fireAtUs, untilUs) &&
+                (!handlerPending || reached(fireAtUs, handlerAtUs))) {
+                // Срабатывание: обработчик поставлен в задачу esp_timer
+                armed = false;
+                handlerPending = true;
+                handlerAtUs = fireAtUs + dispatchUs;
+            } else if (handlerPending && reached(handlerAtUs, untilUs)) {
+                handlerPending = false;
+                runHandler(handlerAtUs);
+            } else {
+                break;
+            }
+        }
+        nowUs = untilUs;
+    }
+
+    // Как updateCommandTime + setSpeed. Уже поставленный обработчик
+    // esp_timer_stop не отменяет
+    void command(uint32_t atUs) {
+        advanceTo(atUs);
+        const uint32_t delayUs = watchdog.rearm(atUs);
+        armed = true;
+        fireAtUs = atUs + delayUs;
+        moving = true;
+    }
+};
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_regular_commands_never_trip(void) {
+    SimFailsafe sim(1000, 200);
+    for (uint32_t t = 1000; t < 5000000; t += 100000) {
+        sim.command(t);
+    }
+    // Даже пауза почти в таймаут не останавливает
+    sim.command(sim.nowUs + kTimeoutUs - 1);
+    TEST_ASSERT_TRUE(sim.moving);
+    TEST_ASSERT_EQUAL_UINT32(0, sim.watchdog.getTripCount());
+    TEST_ASSERT_EQUAL(0, sim.handlerRuns);
+}
+
+void test_trip_latency_is_dispatch_delay(void) {
+    SimFailsafe sim(1000, 180);
+    sim.command(1000);
+    sim.command(101000);
+
+    // Остановка не зависит от цикла робота: только таймаут и диспетчеризация
+    sim.advanceTo(101000 + kTimeoutUs + 179);
+    TEST_ASSERT_TRUE(sim.moving);
+    sim.advanceTo(101000 + kTimeoutUs + 180);
+    TEST_ASSERT_FALSE(sim.moving);
+    TEST_ASSERT_EQUAL_UINT32(101000 + kTimeoutUs + 180, sim.stoppedAtUs);
+    TEST_ASSERT_EQUAL_UINT32(1, sim.watchdog.getTripCount());
+    TEST_ASSERT_EQUAL_UINT32(180, sim.watchdog.getLastTripLatencyUs());
+    TEST_ASSERT_EQUAL_UINT32(180, sim.watchdog.getTripLatency().getMaxUs());
+
+    // Таймер одноразовый: без новых команд повторной остановки нет
+    sim.advanceTo(sim.nowUs + 10 * kTimeoutUs);
+    TEST_ASSERT_EQUAL_UINT32(1, sim.watchdog.getTripCount());
+    TEST_ASSERT_EQUAL(1, sim.handlerRuns);
+}
+
+void test_command_between_fire_and_handler_moves_deadline(void) {
+    SimFailsafe sim(1000, 400);
+    sim.command(1000);
+    // Таймер сработал в 501000, обработчик выполнится в 501400, команда - в 501200
+    const uint32_t lateCommandUs = 1000 + kTimeoutUs + 200;
+    sim.command(lateCommandUs);
+    sim.advanceTo(1000 + kTimeoutUs + 400);
+    TEST_ASSERT_EQUAL(1, sim.handlerRuns);
+    TEST_ASSERT_TRUE(sim.moving);
+    TEST_ASSERT_EQUAL_UINT32(0, sim.watchdog.getTripCount());
+
+    // Остановка по новому сроку
+    sim.advanceTo(lateCommandUs + kTimeoutUs + 400);
+    TEST_ASSERT_FALSE(sim.moving);
+    TEST_ASSERT_EQUAL_UINT32(lateCommandUs + kTimeoutUs + 400, sim.stoppedAtUs);
+    TEST_ASSERT_EQUAL_UINT32(400, sim.watchdog.getLastTripLatencyUs());
+}
+
+void test_deadline_boundary(void) {
+    CommandWatchdog watchdog(kTimeoutUs);
+    TEST_ASSERT_EQUAL_UINT32(kTimeoutUs, watchdog.rearm(7000));
+    TEST_ASSERT_EQUAL_UINT32(7000 + kTimeoutUs, watchdog.getDeadlineUs());
+
+    uint32_t deadlineUs = 0;
+    TEST_ASSERT_FALSE(watchdog.checkExpired(7000 + kTimeoutUs - 1, deadlineUs));
+    TEST_ASSERT_EQUAL_UINT32(7000 + kTimeoutUs, deadlineUs);
+    TEST_ASSERT_TRUE(watchdog.checkExpired(7000 + kTimeoutUs, deadlineUs));
+    TEST_ASSERT_EQUAL_UINT32(0, watchdog.recordTrip(deadlineUs, 7000 + kTimeoutUs));
+}
+
+void test_clock_wraparound(void) {
+    // Младшие 32 бита esp_timer переполняются каждые ~71.6 минуты
+    const uint32_t startUs = 0xFFFFFFFFu - 250000;
+    SimFailsafe sim(startUs, 300);
+    for (uint32_t i = 0; i < 20; i++) {
+        sim.command(startUs + i * 100000);
+    }
+    TEST_ASSERT_TRUE(sim.moving);
+    TEST_ASSERT_EQUAL(0, sim.handlerRuns);
+
+    const uint32_t lastUs = startUs + 19 * 100000;
+    sim.advanceTo(lastUs + kTimeoutUs + 299);
+    TEST_ASSERT_TRUE(sim.moving);
+    sim.advanceTo(lastUs + kTimeoutUs + 300);
+    TEST_ASSERT_FALSE(sim.moving);
+    TEST_ASSERT_EQUAL_UINT32(300, sim.watchdog.getLastTripLatencyUs());
+
+    // Срок сразу за переходом через 0
+    CommandWatchdog watchdog(kTimeoutUs);
+    watchdog.rearm(0xFFFFFFFFu - 100);
+    uint32_t deadlineUs = 0;
+    TEST_ASSERT_FALSE(watchdog.checkExpired(0xFFFFFFFFu, deadlineUs));
+    TEST_ASSERT_FALSE(watchdog.checkExpired(kTimeoutUs - 102, deadlineUs));
+    TEST_ASSERT_TRUE(watchdog.checkExpired(kTimeoutUs - 101, deadlineUs));
+}
+
+void test_trip_statistics(void) {
+    const uint32_t dispatch[] = { 100, 250, 2400, 150 };
+    CommandWatchdog watchdog(kTimeoutUs);
+    uint32_t nowUs = 0;
+    for (uint32_t delayUs : dispatch) {
+        watchdog.rearm(nowUs);
+        nowUs += kTimeoutUs + delayUs;
+        uint32_t deadlineUs = 0;
+        TEST_ASSERT_TRUE(watchdog.checkExpired(nowUs, deadlineUs));
+        TEST_ASSERT_EQUAL_UINT32(delayUs, watchdog.recordTrip(deadlineUs, nowUs));
+        nowUs += 1000000;
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, watchdog.getTripCount());
+    TEST_ASSERT_EQUAL_UINT32(4, watchdog.getTripLatency().getCount());
+    TEST_ASSERT_EQUAL_UINT32(2400, watchdog.getTripLatency().getMaxUs());
+    TEST_ASSERT_EQUAL_UINT32(150, watchdog.getLastTripLatencyUs());
+    TEST_ASSERT_EQUAL_UINT32(kTimeoutUs, watchdog.getTimeoutUs());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_regular_commands_never_trip);
+    RUN_TEST(test_trip_latency_is_dispatch_delay);
+    RUN_TEST(test_command_between_fire_and_handler_moves_deadline);
+    RUN_TEST(test_deadline_boundary);
+    RUN_TEST(test_clock_wraparound);
+    RUN_TEST(test_trip_statistics);
+    return UNITY_END();
+}
@@ -0,0 +1,249 @@
+// Планировщик компонентов (ComponentScheduler) на виртуальных часах:
+// задачи "выполняются", сдвигая часы. pio test -e native
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include "ComponentScheduler.h"
+
+static uint32_t virtualNowUs;
+
+static uint32_t virtualClock() {
+    return virtualNowUs;
+}
+
+static int wakeups;
+
+static void countWake(void* context) {
+    (*static_cast<int*>(context))++;
+}
+
+static ComponentScheduler* scheduler;
+
+void setUp(void) {
+    virtualNowUs = 1000;
+    wakeups = 0;
+    scheduler = new ComponentScheduler(virtualClock);
+    scheduler->attachWaker(countWake, &wakeups);
+}
+
+void tearDown(void) {
+    delete scheduler;
+    scheduler = nullptr;
+}
+
+// Цикл робота: выполнить готовые задачи и "поспать" сколько сказано
+static void runFor(uint32_t durationUs, uint32_t maxSleepUs = 10000) {
+    const uint32_t endUs = virtualNowUs + durationUs;
+    while ((int32_t)(virtualNowUs - endUs) < 0) {
+        const uint32_t sleepUs = scheduler->runDue(maxSleepUs);
+        virtualNowUs += sleepUs;
+    }
+}
+
+static ComponentScheduler::TaskStats statsOf(int id) {
+    ComponentScheduler::TaskStats stats;
+    TEST_ASSERT_TRUE(scheduler->getStats(id, stats));
+    return stats;
+}
+
+void test_periodic_tasks_run_at_their_period(void) {
+    int fast = 0;
+    int slow = 0;
+    scheduler->add("fast", 1000, 0, [&]() { fast++; });
+    scheduler->add("slow", 20000, 0, [&]() { slow++; });
+
+    runFor(100000);
+    // Первый запуск сразу при добавлении, дальше по периоду
+    TEST_ASSERT_EQUAL(100, fast);
+    TEST_ASSERT_EQUAL(5, slow);
+    // Без опозданий и пропусков
+    TEST_ASSERT_EQUAL_UINT32(0, statsOf(0).lateness.getMaxUs());
+    TEST_ASSERT_EQUAL_UINT32(0, statsOf(0).skipped);
+}
+
+void test_sleep_is_time_to_next_due(void) {
+    scheduler->add("a", 5000, 0, []() {});
+    scheduler->add("b", 3000, 0, []() {});
+
+    TEST_ASSERT_EQUAL_UINT32(3000, scheduler->runDue(10000));
+    virtualNowUs += 1000;
+    TEST_ASSERT_EQUAL_UINT32(2000, scheduler->runDue(10000));
+    // Ограничение сверху
+    TEST_ASSERT_EQUAL_UINT32(500, scheduler->runDue(500));
+}
+
+void test_schedule_stays_on_period_grid(void) {
+    // Задача длиной 300 мкс с периодом 1000: старты не дрейфуют
+    scheduler->add("work", 1000, 0, []() { virtualNowUs += 300; });
+    runFor(50000);
+    const ComponentScheduler::TaskStats stats = statsOf(0);
+    TEST_ASSERT_EQUAL_UINT32(50, stats.runs);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.lateness.getMaxUs());
+    TEST_ASSERT_EQUAL_UINT32(300, stats.maxRunUs);
+    TEST_ASSERT_EQUAL_UINT64(50 * 300, stats.totalRunUs);
+}
+
+void test_long_task_delays_others_and_skips_periods(void) {
+    int fast = 0;
+    scheduler->add("fast", 1000, 0, [&]() { fast++; });
+    // Раз в 10 мс задача на 3.5 мс
+    scheduler->add("heavy", 10000, 2000, []() { virtualNowUs += 3500; });
+
+    runFor(100000);
+    const ComponentScheduler::TaskStats fastStats = statsOf(0);
+    const ComponentScheduler::TaskStats heavyStats = statsOf(1);
+    TEST_ASSERT_EQUAL_UINT32(10, heavyStats.runs);
+    TEST_ASSERT_EQUAL_UINT32(10, heavyStats.overruns);
+    // После каждого тяжелого запуска быстрая задача опаздывает на 2.5 мс
+    // и пропускает два срока, но сетку не теряет
+    TEST_ASSERT_EQUAL_UINT32(20, fastStats.skipped);
+    TEST_ASSERT_EQUAL_UINT32(2500, fastStats.lateness.getMaxUs());
+    TEST_ASSERT_EQUAL(80, fast);
+}
+
+void test_triggered_task_runs_once_per_trigger_burst(void) {
+    int runs = 0;
+    const int id = scheduler->add("frame", 0, 0, [&]() { runs++; });
+
+    // Без trigger() не запускается и не мешает спать
+    TEST_ASSERT_EQUAL_UINT32(10000, scheduler->runDue(10000));
+    TEST_ASSERT_EQUAL(0, runs);
+
+    // Несколько trigger() до запуска - один запуск, каждый будит цикл
+    scheduler->trigger(id);
+    virtualNowUs += 400;
+    scheduler->trigger(id);
+    TEST_ASSERT_EQUAL(2, wakeups);
+    virtualNowUs += 100;
+    TEST_ASSERT_EQUAL_UINT32(10000, scheduler->runDue(10000));
+    TEST_ASSERT_EQUAL(1, runs);
+    // Опоздание считается от первого trigger()
+    TEST_ASSERT_EQUAL_UINT32(500, statsOf(id).lateness.getMaxUs());
+
+    scheduler->runDue(10000);
+    TEST_ASSERT_EQUAL(1, runs);
+
+    // Недопустимый id игнорируется
+    scheduler->trigger(-1);
+    scheduler->trigger(5);
+    TEST_ASSERT_EQUAL(2, wakeups);
+}
+
+void test_trigger_during_run_requests_another_pass(void) {
+    int runs = 0;
+    int id = -1;
+    // Задача сама вызывает trigger(), как новый кадр во время разбора
+    id = scheduler->add("self", 0, 0, [&]() {
+        if (++runs == 1) {
+            scheduler->trigger(id);
+        }
+    });
+    scheduler->trigger(id);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler->runDue(10000));
+    TEST_ASSERT_EQUAL_UINT32(10000, scheduler->runDue(10000));
+    TEST_ASSERT_EQUAL(2, runs);
+}
+
+void test_clock_wraparound(void) {
+    virtualNowUs = 0xFFFFF000u;
+    int runs = 0;
+    scheduler->add("wrap", 1000, 0, [&]() { runs++; });
+    // Цикл просыпается чаще периода: сроки за переходом через 0 не
+    // должны казаться уже наступившими
+    runFor(20000, 50);
+    TEST_ASSERT_EQUAL(20, runs);
+    TEST_ASSERT_EQUAL_UINT32(0, statsOf(0).skipped);
+    TEST_ASSERT_EQUAL_UINT32(0, statsOf(0).lateness.getMaxUs());
+}
+
+class FakeComponent : public IComponent {
+public:
+    int updates = 0;
+    bool init() override { return true; }
+    void update() override { updates++; }
+    uint32_t getUpdatePeriodUs() const override { return 2000; }
+    uint32_t getUpdateDeadlineUs() const override { return 100; }
+    void shutdown() override {}
+    bool isInitialized() const override { return true; }
+};
+
+void test_component_period_and_limits(void) {
+    FakeComponent component;
+    const int id = scheduler->add("component", &component);
+    TEST_ASSERT_EQUAL(0, id);
+    TEST_ASSERT_EQUAL(-1, scheduler->add("null", nullptr));
+    TEST_ASSERT_EQUAL(-1, scheduler->add("empty", 1000, 0, ComponentScheduler::Callback()));
+
+    runFor(10000);
+    TEST_ASSERT_EQUAL(5, component.updates);
+    TEST_ASSERT_EQUAL_UINT32(2000, statsOf(id).periodUs);
+    TEST_ASSERT_EQUAL_UINT32(100, statsOf(id).deadlineUs);
+
+    for (int i = scheduler->getTaskCount(); i < ComponentScheduler::kMaxTasks; i++) {
+        TEST_ASSERT_EQUAL(i, scheduler->add("filler", 1000, 0, []() {}));
+    }
+    TEST_ASSERT_EQUAL(-1, scheduler->add("extra", 1000, 0, []() {}));
+
+    ComponentScheduler::TaskStats stats;
+    TEST_ASSERT_FALSE(scheduler->getStats(ComponentScheduler::kMaxTasks, stats));
+}
+
+void test_reset_stats(void) {
+    scheduler->add("work", 1000, 100, []() { virtualNowUs += 200; });
+    runFor(10000);
+    TEST_ASSERT_GREATER_THAN(0, statsOf(0).overruns);
+
+    scheduler->resetStats();
+    const ComponentScheduler::TaskStats stats = statsOf(0);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.runs);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.overruns);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.maxRunUs);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.lateness.getCount());
+    // Имя и период сохраняются
+    TEST_ASSERT_EQUAL_STRING("work", stats.name);
+    TEST_ASSERT_EQUAL_UINT32(1000, stats.periodUs);
+}
+
+// trigger() из другого потока (задача захвата) не теряется
+void test_trigger_from_other_thread(void) {
+    std::atomic<int> runs(0);
+    const int id = scheduler->add("frame", 0, 0, [&]() { runs++; });
+    std::atomic<bool> done(false);
+    std::atomic<int> triggers(0);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < 20000; i++) {
+            scheduler->trigger(id);
+            triggers++;
+            if (i % 8 == 0) {
+                std::this_thread::yield();
+            }
+        }
+        done = true;
+    });
+    while (!done.load()) {
+        scheduler->runDue(0);
+    }
+    producer.join();
+    scheduler->runDue(0);
+
+    // Запуски объединяются, но последний trigger() всегда обслужен
+    TEST_ASSERT_GREATER_THAN(0, runs.load());
+    TEST_ASSERT_LESS_OR_EQUAL(triggers.load(), runs.load());
+    TEST_ASSERT_EQUAL_UINT32(10000, scheduler->runDue(10000));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_periodic_tasks_run_at_their_period);
+    RUN_TEST(test_sleep_is_time_to_next_due);
+    RUN_TEST(test_schedule_stays_on_period_grid);
+    RUN_TEST(test_long_task_delays_others_and_skips_periods);
+    RUN_TEST(test_triggered_task_runs_once_per_trigger_burst);
+    RUN_TEST(test_trigger_during_run_requests_another_pass);
+    RUN_TEST(test_clock_wraparound);
+    RUN_TEST(test_component_period_and_limits);
+    RUN_TEST(test_reset_stats);
+    RUN_TEST(test_trigger_from_other_thread);
+    return UNITY_END();
+}
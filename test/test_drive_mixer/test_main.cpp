@@ -0,0 +1,218 @@
+// Микшер привода (DriveMixer): таблицы против прежнего расчета через map()
+// на всей сетке газ x руль 1000..2000 для всех сочетаний swap/инверсии,
+// и время обоих расчетов на той же сетке. pio test -e native
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include "DriveMixer.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// map() Arduino-ESP32
+static long arduinoMap(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+static int constrainSpeed(int speed) {
+    return speed < -100 ? -100 : (speed > 100 ? 100 : speed);
+}
+
+// Прежний MX1508MotorController::setMotorPWM: сначала инверсия, потом swap
+static void oldMix(int throttlePWM, int steeringPWM, bool swap, bool invertLeft, bool invertRight,
+                   int& leftSpeed, int& rightSpeed) {
+    const int throttle = arduinoMap(throttlePWM, 1000, 2000, -100, 100);
+    const int steering = arduinoMap(steeringPWM, 1000, 2000, -100, 100);
+    int left = throttle + steering;
+    int right = throttle - steering;
+    if (invertLeft) {
+        left = -left;
+    }
+    if (invertRight) {
+        right = -right;
+    }
+    if (swap) {
+        const int temp = left;
+        left = right;
+        right = temp;
+    }
+    leftSpeed = constrainSpeed(left);
+    rightSpeed = constrainSpeed(right);
+}
+
+// Прежний applyMotorSpeed
+static int oldDuty(int speed) {
+    const int maxPWM = (1 << MOTOR_PWM_RESOLUTION) - 1;
+    const int limitedMaxPWM = (maxPWM * MOTOR_MAX_POWER_PERCENT) / 100;
+    if (speed > 0) {
+        return arduinoMap(speed, 0, 100, 0, limitedMaxPWM);
+    }
+    if (speed < 0) {
+        return arduinoMap(-speed, 0, 100, 0, limitedMaxPWM);
+    }
+    return 0;
+}
+
+// Сравнение на прямоугольнике PWM с шагом, первое расхождение - в сообщении
+static void checkGrid(int pwmMin, int pwmMax, int step) {
+    uint32_t mismatches = 0;
+    char first[128] = "";
+    for (int config = 0; config < 8; config++) {
+        const bool swap = config & 1;
+        const bool invertLeft = config & 2;
+        const bool invertRight = config & 4;
+        const uint8_t mixerConfig = DriveMixer::makeConfig(swap, invertLeft, invertRight);
+        for (int throttle = pwmMin; throttle <= pwmMax; throttle += step) {
+            for (int steering = pwmMin; steering <= pwmMax; steering += step) {
+                int oldLeft, oldRight, newLeft, newRight;
+                oldMix(throttle, steering, swap, invertLeft, invertRight, oldLeft, oldRight);
+                DriveMixer::mix(throttle, steering, mixerConfig, newLeft, newRight);
+                if (oldLeft != newLeft || oldRight != newRight) {
+                    if (mismatches == 0) {
+                        snprintf(first, sizeof(first),
+                                 "t=%d s=%d swap=%d invL=%d invR=%d: old %d/%d new %d/%d",
+                                 throttle, steering, swap, invertLeft, invertRight,
+                                 oldLeft, oldRight, newLeft, newRight);
+                    }
+                    mismatches++;
+                }
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, mismatches, first);
+}
+
+#if MOTOR_DEADBAND_PERCENT == 0 && MOTOR_EXPO_PERCENT == 0
+// Без мертвой зоны и экспоненты - точное совпадение
+void test_mix_matches_old_map_full_grid(void) {
+    checkGrid(DriveMixer::kPwmMin, DriveMixer::kPwmMax, 1);
+}
+
+// PID Лайнера выходит за 1000..2000: продолжение как у map()
+void test_mix_matches_old_map_outside_range(void) {
+    checkGrid(0, 3000, 7);
+}
+#endif
+
+void test_duty_matches_old_map(void) {
+    for (int speed = -100; speed <= 100; speed++) {
+        TEST_ASSERT_EQUAL_INT_MESSAGE(oldDuty(speed), DriveMixer::duty(speed), "speed");
+    }
+    TEST_ASSERT_EQUAL(kDriveMaxDuty, DriveMixer::duty(100));
+    TEST_ASSERT_EQUAL(kDriveMaxDuty, DriveMixer::duty(-100));
+}
+
+void test_config_truth_table(void) {
+    // Газ вперед и вправо: левая сторона 60, правая 20
+    int left, right;
+    DriveMixer::mix(1700, 1600, DriveMixer::makeConfig(false, false, false), left, right);
+    TEST_ASSERT_EQUAL(60, left);
+    TEST_ASSERT_EQUAL(20, right);
+
+    DriveMixer::mix(1700, 1600, DriveMixer::makeConfig(true, false, false), left, right);
+    TEST_ASSERT_EQUAL(20, left);
+    TEST_ASSERT_EQUAL(60, right);
+
+    // Инверсия относится к логическому мотору и уходит вместе с ним при swap
+    DriveMixer::mix(1700, 1600, DriveMixer::makeConfig(true, true, false), left, right);
+    TEST_ASSERT_EQUAL(20, left);
+    TEST_ASSERT_EQUAL(-60, right);
+
+    DriveMixer::mix(1700, 1600, DriveMixer::makeConfig(false, false, true), left, right);
+    TEST_ASSERT_EQUAL(60, left);
+    TEST_ASSERT_EQUAL(-20, right);
+}
+
+void test_axis_center_and_ends(void) {
+    TEST_ASSERT_EQUAL(-100, DriveMixer::axis(1000));
+    TEST_ASSERT_EQUAL(0, DriveMixer::axis(1500));
+    TEST_ASSERT_EQUAL(100, DriveMixer::axis(2000));
+    // Насыщение суммы газа и руля
+    int left, right;
+    DriveMixer::mix(2000, 2000, 0, left, right);
+    TEST_ASSERT_EQUAL(100, left);
+    TEST_ASSERT_EQUAL(0, right);
+    DriveMixer::mix(1000, 2000, 0, left, right);
+    TEST_ASSERT_EQUAL(0, left);
+    TEST_ASSERT_EQUAL(-100, right);
+}
+
+// Прежний путь команды целиком: микс и скважность обоих моторов
+static uint32_t oldCommand(int throttle, int steering, bool swap, bool invertLeft, bool invertRight) {
+    int left, right;
+    oldMix(throttle, steering, swap, invertLeft, invertRight, left, right);
+    return (uint32_t)(left * 3 + right) + oldDuty(left) + oldDuty(right);
+}
+
+static uint32_t newCommand(int throttle, int steering, uint8_t config) {
+    int left, right;
+    DriveMixer::mix(throttle, steering, config, left, right);
+    return (uint32_t)(left * 3 + right) + DriveMixer::duty(left) + DriveMixer::duty(right);
+}
+
+// Лучшее из нескольких прогонов всей сетки для всех конфигураций, нс на команду.
+// Контрольная сумма не дает компилятору выбросить расчет
+template <typename Command>
+static double timeGrid(Command command, uint32_t& checksum) {
+    const int kRepeats = 3;
+    const uint32_t commands = 8u * 1001u * 1001u;
+    double bestNs = 0;
+    for (int repeat = 0; repeat < kRepeats; repeat++) {
+        uint32_t sum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int config = 0; config < 8; config++) {
+            for (int throttle = DriveMixer::kPwmMin; throttle <= DriveMixer::kPwmMax; throttle++) {
+                for (int steering = DriveMixer::kPwmMin; steering <= DriveMixer::kPwmMax; steering++) {
+                    sum += command(throttle, steering, config);
+                }
+            }
+        }
+        const double ns = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count() / commands;
+        if (repeat == 0 || ns < bestNs) {
+            bestNs = ns;
+        }
+        checksum = sum;
+    }
+    return bestNs;
+}
+
+// Замер на ПК: соотношение, а не абсолютное время ESP32. Порог по времени
+// не ставится (общие машины CI шумят), результат - в выводе теста
+void test_benchmark_old_map_vs_tables(void) {
+    uint32_t oldSum = 0;
+    uint32_t newSum = 0;
+    const double oldNs = timeGrid([](int t, int s, int config) {
+        return oldCommand(t, s, config & 1, config & 2, config & 4);
+    }, oldSum);
+    const double newNs = timeGrid([](int t, int s, int config) {
+        return newCommand(t, s, DriveMixer::makeConfig(config & 1, config & 2, config & 4));
+    }, newSum);
+
+    char message[128];
+    snprintf(message, sizeof(message), "map(): %.2f ns/cmd, DriveMixer: %.2f ns/cmd (x%.2f)",
+             oldNs, newNs, newNs > 0 ? oldNs / newNs : 0.0);
+    TEST_MESSAGE(message);
+
+#if MOTOR_DEADBAND_PERCENT == 0 && MOTOR_EXPO_PERCENT == 0
+    TEST_ASSERT_EQUAL_HEX32(oldSum, newSum);
+#endif
+    TEST_ASSERT_GREATER_THAN(0, oldNs);
+    TEST_ASSERT_GREATER_THAN(0, newNs);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+#if MOTOR_DEADBAND_PERCENT == 0 && MOTOR_EXPO_PERCENT == 0
+    RUN_TEST(test_mix_matches_old_map_full_grid);
+    RUN_TEST(test_mix_matches_old_map_outside_range);
+#endif
+    RUN_TEST(test_duty_matches_old_map);
+    RUN_TEST(test_config_truth_table);
+    RUN_TEST(test_axis_center_and_ends);
+    RUN_TEST(test_benchmark_old_map_vs_tables);
+    return UNITY_END();
+}
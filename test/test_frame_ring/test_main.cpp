@@ -0,0 +1,237 @@
+// Кольцо кадров (FrameRing): писатель - поддельный источник кадров,
+// читатели - быстрый и медленный зрители. pio test -e native
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "FrameRing.h"
+
+static const size_t kSlotCapacity = 256;
+static uint8_t buffers[FrameRing::kSize][kSlotCapacity];
+static FrameRing* ring;
+
+void setUp(void) {
+    ring = new FrameRing();
+    for (int i = 0; i < FrameRing::kSize; i++) {
+        ring->attachBuffer(i, buffers[i], kSlotCapacity);
+    }
+}
+
+void tearDown(void) {
+    delete ring;
+    ring = nullptr;
+}
+
+// Кадр seq: длина и содержимое однозначно выводятся из номера
+static size_t frameLen(uint32_t seq) {
+    return 16 + seq % 200;
+}
+
+static bool frameIntact(const FrameSlot* slot) {
+    if (slot->len != frameLen(slot->seq)) {
+        return false;
+    }
+    for (size_t i = 0; i < slot->len; i++) {
+        if (slot->buf[i] != (uint8_t)(slot->seq * 7 + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Поддельный источник: как задача захвата (reserve -> заполнить -> publish)
+static bool produceFrame() {
+    FrameSlot* slot = ring->reserve();
+    if (!slot) {
+        return false;
+    }
+    const uint32_t seq = ring->getLatestSeq() + 1;
+    slot->len = frameLen(seq);
+    for (size_t i = 0; i < slot->len; i++) {
+        slot->buf[i] = (uint8_t)(seq * 7 + i);
+    }
+    slot->seq = seq;
+    ring->publish(slot);
+    return true;
+}
+
+static int refsOf(const FrameSlot* slot) {
+    return slot->refs.load();
+}
+
+void test_empty_ring_has_no_frame(void) {
+    TEST_ASSERT_NULL(ring->acquireLatest(0));
+    TEST_ASSERT_EQUAL_UINT32(0, ring->getLatestSeq());
+}
+
+void test_acquire_returns_only_newer_frame(void) {
+    TEST_ASSERT_TRUE(produceFrame());
+
+    FrameSlot* frame = ring->acquireLatest(0);
+    TEST_ASSERT_NOT_NULL(frame);
+    TEST_ASSERT_EQUAL_UINT32(1, frame->seq);
+    TEST_ASSERT_TRUE(frameIntact(frame));
+    TEST_ASSERT_EQUAL(1, refsOf(frame));
+    ring->release(frame);
+    TEST_ASSERT_EQUAL(0, refsOf(frame));
+
+    // Тот же кадр повторно не выдается, ссылка не остается
+    TEST_ASSERT_NULL(ring->acquireLatest(1));
+    TEST_ASSERT_EQUAL(0, refsOf(frame));
+}
+
+void test_writer_never_reuses_latest_frame(void) {
+    for (int i = 0; i < FrameRing::kSize * 3; i++) {
+        TEST_ASSERT_TRUE(produceFrame());
+        FrameSlot* latest = ring->acquireLatest(0);
+        TEST_ASSERT_NOT_NULL(latest);
+        ring->release(latest);
+
+        FrameSlot* reserved = ring->reserve();
+        TEST_ASSERT_NOT_NULL(reserved);
+        TEST_ASSERT_TRUE(reserved != latest);
+        ring->discard(reserved);
+    }
+}
+
+void test_slow_consumer_keeps_its_frame_intact(void) {
+    TEST_ASSERT_TRUE(produceFrame());
+    FrameSlot* held = ring->acquireLatest(0);
+    TEST_ASSERT_NOT_NULL(held);
+
+    // Быстрый зритель и источник уходят далеко вперед
+    uint32_t fastSeq = 0;
+    for (int i = 0; i < 50; i++) {
+        TEST_ASSERT_TRUE(produceFrame());
+        FrameSlot* frame = ring->acquireLatest(fastSeq);
+        TEST_ASSERT_NOT_NULL(frame);
+        TEST_ASSERT_TRUE(frame != held);
+        TEST_ASSERT_TRUE(frameIntact(frame));
+        fastSeq = frame->seq;
+        ring->release(frame);
+    }
+
+    // Медленный зритель дочитывает свой кадр без изменений
+    TEST_ASSERT_EQUAL_UINT32(1, held->seq);
+    TEST_ASSERT_TRUE(frameIntact(held));
+    ring->release(held);
+    TEST_ASSERT_EQUAL_UINT32(51, ring->getLatestSeq());
+}
+
+void test_writer_drops_frames_when_all_slots_are_held(void) {
+    // Каждый слот, кроме последнего кадра, держит медленный зритель
+    std::vector<FrameSlot*> held;
+    for (int i = 0; i < FrameRing::kSize; i++) {
+        TEST_ASSERT_TRUE(produceFrame());
+        FrameSlot* frame = ring->acquireLatest(0);
+        TEST_ASSERT_NOT_NULL(frame);
+        held.push_back(frame);
+    }
+
+    // Свободных слотов нет: кадр пропускается, опубликованные не трогаются
+    TEST_ASSERT_FALSE(produceFrame());
+    TEST_ASSERT_EQUAL_UINT32(FrameRing::kSize, ring->getLatestSeq());
+    for (FrameSlot* frame : held) {
+        TEST_ASSERT_TRUE(frameIntact(frame));
+    }
+
+    // Последний кадр сам по себе слот не освобождает
+    ring->release(held.back());
+    TEST_ASSERT_FALSE(produceFrame());
+
+    // Освободился более старый слот - источник снова пишет
+    ring->release(held.front());
+    TEST_ASSERT_TRUE(produceFrame());
+    TEST_ASSERT_EQUAL_UINT32(FrameRing::kSize + 1, ring->getLatestSeq());
+
+    for (size_t i = 1; i + 1 < held.size(); i++) {
+        ring->release(held[i]);
+    }
+}
+
+void test_discarded_slot_is_free_again(void) {
+    FrameSlot* slot = ring->reserve();
+    TEST_ASSERT_NOT_NULL(slot);
+    TEST_ASSERT_EQUAL(FrameRing::kWriterBias, refsOf(slot));
+    ring->discard(slot);
+    TEST_ASSERT_EQUAL(0, refsOf(slot));
+
+    // Незаполненный слот читателю не виден
+    TEST_ASSERT_NULL(ring->acquireLatest(0));
+}
+
+// Источник и зрители в отдельных потоках: ни один зритель не видит
+// перезаписанный или недописанный кадр, номера кадров только растут
+void test_concurrent_fast_and_slow_consumers(void) {
+    const uint32_t kFrames = 200000;
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> reordered(0);
+    std::atomic<uint32_t> received[3];
+    for (auto& count : received) {
+        count = 0;
+    }
+
+    auto consumer = [&](int index, int holdSpins) {
+        uint32_t lastSeq = 0;
+        while (!done.load()) {
+            FrameSlot* frame = ring->acquireLatest(lastSeq);
+            if (!frame) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (frame->seq <= lastSeq) {
+                reordered++;
+            }
+            lastSeq = frame->seq;
+            // Медленный зритель держит слот, пока источник пишет дальше
+            for (int spin = 0; spin < holdSpins; spin++) {
+                std::this_thread::yield();
+            }
+            if (!frameIntact(frame) || frame->seq != lastSeq) {
+                torn++;
+            }
+            received[index]++;
+            ring->release(frame);
+        }
+    };
+
+    std::thread fast(consumer, 0, 0);
+    std::thread medium(consumer, 1, 20);
+    std::thread slow(consumer, 2, 400);
+
+    // Кадры без свободного слота пропускаются, как у задачи захвата
+    uint32_t published = 0;
+    while (published < kFrames) {
+        if (produceFrame()) {
+            published++;
+        }
+    }
+    done = true;
+    fast.join();
+    medium.join();
+    slow.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+    TEST_ASSERT_EQUAL_UINT32(0, reordered.load());
+    TEST_ASSERT_GREATER_THAN(0, received[0].load());
+    TEST_ASSERT_GREATER_THAN(0, received[2].load());
+    TEST_ASSERT_EQUAL_UINT32(kFrames, ring->getLatestSeq());
+
+    // Все ссылки возвращены
+    for (int i = 0; i < FrameRing::kSize; i++) {
+        TEST_ASSERT_EQUAL(0, refsOf(&ring->slotAt(i)));
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_ring_has_no_frame);
+    RUN_TEST(test_acquire_returns_only_newer_frame);
+    RUN_TEST(test_writer_never_reuses_latest_frame);
+    RUN_TEST(test_slow_consumer_keeps_its_frame_intact);
+    RUN_TEST(test_writer_drops_frames_when_all_slots_are_held);
+    RUN_TEST(test_discarded_slot_is_free_again);
+    RUN_TEST(test_concurrent_fast_and_slow_consumers);
+    return UNITY_END();
+}
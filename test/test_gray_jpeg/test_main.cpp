@@ -0,0 +1,375 @@
+// Кодер ЧБ JPEG (GrayJpegEncoder): кадр кодируется и декодируется обратно
+// минимальным baseline декодером ниже, качество сравнивается по PSNR.
+// pio test -e native
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "GrayJpegEncoder.h"
+
+// ═══════════════════════════════════════════════════════════════
+// МИНИМАЛЬНЫЙ ДЕКОДЕР (baseline, одна компонента, без restart)
+// ═══════════════════════════════════════════════════════════════
+
+static const uint8_t kZigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+struct HuffmanTable {
+    uint8_t counts[17];
+    uint8_t symbols[256];
+};
+
+class GrayJpegDecoder {
+public:
+    GrayJpegDecoder(const uint8_t* data, size_t len) :
+        width(0), height(0), data_(data), len_(len), pos_(0), bitBuffer_(0), bitCount_(0) {}
+
+    // false - поток не разобран (маркеры, таблицы, обрыв данных)
+    bool decode(std::vector<uint8_t>& pixels) {
+        if (len_ < 4 || data_[0] != 0xFF || data_[1] != 0xD8) {
+            return false;
+        }
+        pos_ = 2;
+        bool haveFrame = false;
+        while (pos_ + 4 <= len_) {
+            if (data_[pos_] != 0xFF) {
+                return false;
+            }
+            const uint8_t marker = data_[pos_ + 1];
+            const size_t segment = (data_[pos_ + 2] << 8) | data_[pos_ + 3];
+            const uint8_t* body = data_ + pos_ + 4;
+            const size_t bodyLen = segment - 2;
+            pos_ += 2 + segment;
+            if (pos_ > len_) {
+                return false;
+            }
+
+            if (marker == 0xDB) {
+                // 8-битная таблица в порядке зигзага
+                if (body[0] != 0x00 || bodyLen != 65) {
+                    return false;
+                }
+                for (int i = 0; i < 64; i++) {
+                    quant_[i] = body[1 + i];
+                }
+            } else if (marker == 0xC0) {
+                height = (body[1] << 8) | body[2];
+                width = (body[3] << 8) | body[4];
+                haveFrame = body[5] == 1;
+            } else if (marker == 0xC4) {
+                size_t p = 0;
+                while (p < bodyLen) {
+                    HuffmanTable& table = (body[p] >> 4) ? ac_ : dc_;
+                    p++;
+                    int total = 0;
+                    table.counts[0] = 0;
+                    for (int i = 1; i <= 16; i++) {
+                        table.counts[i] = body[p++];
+                        total += table.counts[i];
+                    }
+                    memcpy(table.symbols, body + p, total);
+                    p += total;
+                }
+            } else if (marker == 0xDA) {
+                return haveFrame && decodeScan(pixels);
+            }
+        }
+        return false;
+    }
+
+    int width;
+    int height;
+
+private:
+    const uint8_t* data_;
+    size_t len_;
+    size_t pos_;
+    uint32_t bitBuffer_;
+    int bitCount_;
+    uint16_t quant_[64];
+    HuffmanTable dc_;
+    HuffmanTable ac_;
+
+    int readBit() {
+        if (bitCount_ == 0) {
+            if (pos_ >= len_) {
+                return 0;
+            }
+            bitBuffer_ = data_[pos_++];
+            if (bitBuffer_ == 0xFF) {
+                pos_++;   // Байт-заполнитель 0x00
+            }
+            bitCount_ = 8;
+        }
+        return (bitBuffer_ >> --bitCount_) & 1;
+    }
+
+    int readBits(int count) {
+        int value = 0;
+        for (int i = 0; i < count; i++) {
+            value = (value << 1) | readBit();
+        }
+        return value;
+    }
+
+    // Канонический код Хаффмана: коды одной длины идут подряд
+    int decodeSymbol(const HuffmanTable& table) {
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for (int len = 1; len <= 16; len++) {
+            code |= readBit();
+            const int count = table.counts[len];
+            if (code - first < count) {
+                return table.symbols[index + code - first];
+            }
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+    int receiveExtend(int size) {
+        if (size == 0) {
+            return 0;
+        }
+        int value = readBits(size);
+        if (value < (1 << (size - 1))) {
+            value -= (1 << size) - 1;
+        }
+        return value;
+    }
+
+    static void idct(const int32_t* coef, uint8_t* out, int stride) {
+        double tmp[64];
+        for (int y = 0; y < 8; y++) {
+            for (int u = 0; u < 8; u++) {
+                double sum = 0;
+                for (int v = 0; v < 8; v++) {
+                    const double cv = v == 0 ? M_SQRT1_2 : 1.0;
+                    sum += cv * coef[v * 8 + u] * cos((2 * y + 1) * v * M_PI / 16);
+                }
+                tmp[y * 8 + u] = sum / 2;
+            }
+        }
+        for (int y = 0; y < 8; y++) {
+            for (int x = 0; x < 8; x++) {
+                double sum = 0;
+                for (int u = 0; u < 8; u++) {
+                    const double cu = u == 0 ? M_SQRT1_2 : 1.0;
+                    sum += cu * tmp[y * 8 + u] * cos((2 * x + 1) * u * M_PI / 16);
+                }
+                const long value = lround(sum / 2 + 128);
+                out[y * stride + x] = value < 0 ? 0 : value > 255 ? 255 : (uint8_t)value;
+            }
+        }
+    }
+
+    bool decodeScan(std::vector<uint8_t>& pixels) {
+        const int blocksX = (width + 7) / 8;
+        const int blocksY = (height + 7) / 8;
+        std::vector<uint8_t> padded((size_t)blocksX * 8 * blocksY * 8);
+        const int stride = blocksX * 8;
+        int dc = 0;
+
+        for (int by = 0; by < blocksY; by++) {
+            for (int bx = 0; bx < blocksX; bx++) {
+                int32_t coef[64] = { 0 };
+                const int dcSize = decodeSymbol(dc_);
+                if (dcSize < 0) {
+                    return false;
+                }
+                dc += receiveExtend(dcSize);
+                coef[0] = dc * quant_[0];
+                for (int k = 1; k < 64; k++) {
+                    const int rs = decodeSymbol(ac_);
+                    if (rs < 0) {
+                        return false;
+                    }
+                    const int run = rs >> 4;
+                    const int size = rs & 0x0F;
+                    if (size == 0) {
+                        if (run != 15) {
+                            break;    // EOB
+                        }
+                        k += 15;      // ZRL
+                        continue;
+                    }
+                    k += run;
+                    if (k > 63) {
+                        return false;
+                    }
+                    coef[kZigzag[k]] = receiveExtend(size) * quant_[k];
+                }
+                idct(coef, &padded[(size_t)by * 8 * stride + bx * 8], stride);
+            }
+        }
+
+        // После энтропийных данных сразу EOI
+        if (pos_ + 2 != len_ || data_[pos_] != 0xFF || data_[pos_ + 1] != 0xD9) {
+            return false;
+        }
+        pixels.resize((size_t)width * height);
+        for (int y = 0; y < height; y++) {
+            memcpy(&pixels[(size_t)y * width], &padded[(size_t)y * stride], width);
+        }
+        return true;
+    }
+};
+
+// ═══════════════════════════════════════════════════════════════
+// ТЕСТЫ
+// ═══════════════════════════════════════════════════════════════
+
+static uint8_t jpeg[64 * 1024];
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Кадр, похожий на линию на полу: плавный фон, темная полоса, шум сенсора
+static std::vector<uint8_t> makeFrame(int width, int height) {
+    std::vector<uint8_t> frame((size_t)width * height);
+    uint32_t noise = 12345;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            noise = noise * 1103515245 + 12345;
+            int value = 150 + (int)(60 * sin(x * 0.07) * cos(y * 0.05));
+            if (abs(x - width / 2 - (y - height / 2) / 3) < 8) {
+                value = 30;
+            }
+            value += (int)((noise >> 16) % 9) - 4;
+            frame[(size_t)y * width + x] = value < 0 ? 0 : value > 255 ? 255 : (uint8_t)value;
+        }
+    }
+    return frame;
+}
+
+static double psnr(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+    double mse = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        const double d = (double)a[i] - b[i];
+        mse += d * d;
+    }
+    mse /= a.size();
+    return mse == 0 ? 99.0 : 10 * log10(255.0 * 255.0 / mse);
+}
+
+// Кодирует и декодирует кадр, возвращает PSNR (0 - поток не разобран)
+static double roundTrip(GrayJpegEncoder& encoder, const std::vector<uint8_t>& frame,
+                        int width, int height, size_t* jpegLen) {
+    const size_t len = encoder.encode(frame.data(), width, height, jpeg, sizeof(jpeg));
+    if (jpegLen) {
+        *jpegLen = len;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    GrayJpegDecoder decoder(jpeg, len);
+    std::vector<uint8_t> decoded;
+    if (!decoder.decode(decoded) || decoder.width != width || decoder.height != height) {
+        return 0;
+    }
+    return psnr(frame, decoded);
+}
+
+void test_stream_has_markers_and_frame_size(void) {
+    const std::vector<uint8_t> frame = makeFrame(160, 120);
+    GrayJpegEncoder encoder(80);
+    const size_t len = encoder.encode(frame.data(), 160, 120, jpeg, sizeof(jpeg));
+    TEST_ASSERT_GREATER_THAN(0, len);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, jpeg[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xD8, jpeg[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, jpeg[len - 2]);
+    TEST_ASSERT_EQUAL_HEX8(0xD9, jpeg[len - 1]);
+
+    GrayJpegDecoder decoder(jpeg, len);
+    std::vector<uint8_t> decoded;
+    TEST_ASSERT_TRUE(decoder.decode(decoded));
+    TEST_ASSERT_EQUAL(160, decoder.width);
+    TEST_ASSERT_EQUAL(120, decoder.height);
+}
+
+void test_quality_trades_size_for_fidelity(void) {
+    const std::vector<uint8_t> frame = makeFrame(160, 120);
+    const uint8_t qualities[] = { 10, 50, 80, 95 };
+    // Нижние границы PSNR с запасом от значений, совпадающих с libjpeg
+    const double minPsnr[] = { 27.0, 33.0, 37.0, 41.5 };
+    GrayJpegEncoder encoder;
+    size_t lastLen = 0;
+    double lastPsnr = 0;
+    for (int i = 0; i < 4; i++) {
+        encoder.setQuality(qualities[i]);
+        size_t len = 0;
+        const double quality = roundTrip(encoder, frame, 160, 120, &len);
+        TEST_ASSERT_TRUE(quality >= minPsnr[i]);
+        TEST_ASSERT_GREATER_THAN(lastLen, len);
+        TEST_ASSERT_TRUE(quality > lastPsnr);
+        lastLen = len;
+        lastPsnr = quality;
+    }
+}
+
+void test_edge_blocks_of_odd_frame_size(void) {
+    // Размер не кратен 8: краевые блоки дополняются последним пикселем
+    const std::vector<uint8_t> frame = makeFrame(163, 117);
+    GrayJpegEncoder encoder(80);
+    TEST_ASSERT_TRUE(roundTrip(encoder, frame, 163, 117, nullptr) >= 37.0);
+}
+
+void test_flat_frame_is_tiny_and_exact(void) {
+    const std::vector<uint8_t> frame(160 * 120, 77);
+    GrayJpegEncoder encoder(80);
+    size_t len = 0;
+    const double quality = roundTrip(encoder, frame, 160, 120, &len);
+    TEST_ASSERT_TRUE(quality >= 48.0);
+    // Только DC и EOB на блок: почти весь размер - заголовок
+    TEST_ASSERT_LESS_THAN(600, len);
+}
+
+void test_output_is_deterministic_across_quality_changes(void) {
+    const std::vector<uint8_t> frame = makeFrame(160, 120);
+    GrayJpegEncoder encoder(80);
+    const size_t len = encoder.encode(frame.data(), 160, 120, jpeg, sizeof(jpeg));
+    std::vector<uint8_t> first(jpeg, jpeg + len);
+
+    // Таблицы пересчитываются при смене качества и возвращаются такими же
+    encoder.setQuality(10);
+    TEST_ASSERT_EQUAL(10, encoder.getQuality());
+    encoder.encode(frame.data(), 160, 120, jpeg, sizeof(jpeg));
+    encoder.setQuality(80);
+    TEST_ASSERT_EQUAL(len, encoder.encode(frame.data(), 160, 120, jpeg, sizeof(jpeg)));
+    TEST_ASSERT_EQUAL_MEMORY(first.data(), jpeg, len);
+}
+
+void test_overflow_returns_zero(void) {
+    const std::vector<uint8_t> frame = makeFrame(160, 120);
+    GrayJpegEncoder encoder(80);
+    const size_t len = encoder.encode(frame.data(), 160, 120, jpeg, sizeof(jpeg));
+    TEST_ASSERT_GREATER_THAN(0, len);
+
+    // Ровно по размеру помещается, на байт меньше - нет
+    TEST_ASSERT_EQUAL(len, encoder.encode(frame.data(), 160, 120, jpeg, len));
+    TEST_ASSERT_EQUAL(0, encoder.encode(frame.data(), 160, 120, jpeg, len - 1));
+    TEST_ASSERT_EQUAL(0, encoder.encode(frame.data(), 160, 120, jpeg, 16));
+    TEST_ASSERT_EQUAL(0, encoder.encode(nullptr, 160, 120, jpeg, sizeof(jpeg)));
+    TEST_ASSERT_EQUAL(0, encoder.encode(frame.data(), 0, 120, jpeg, sizeof(jpeg)));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_stream_has_markers_and_frame_size);
+    RUN_TEST(test_quality_trades_size_for_fidelity);
+    RUN_TEST(test_edge_blocks_of_odd_frame_size);
+    RUN_TEST(test_flat_frame_is_tiny_and_exact);
+    RUN_TEST(test_output_is_deterministic_across_quality_changes);
+    RUN_TEST(test_overflow_returns_zero);
+    return UNITY_END();
+}
@@ -0,0 +1,81 @@
+// Гистограмма задержек (LatencyHistogram): перцентили по границам корзин
+// и общий JSON эндпоинтов статистики. pio test -e native
+#include <unity.h>
+#include <string.h>
+#include "LatencyHistogram.h"
+
+static LatencyHistogram* hist;
+
+void setUp(void) {
+    hist = new LatencyHistogram();
+}
+
+void tearDown(void) {
+    delete hist;
+    hist = nullptr;
+}
+
+void test_empty_histogram(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, hist->getCount());
+    TEST_ASSERT_EQUAL_UINT32(0, hist->getAvgUs());
+    TEST_ASSERT_EQUAL_UINT32(0, hist->percentileUs(99));
+}
+
+void test_percentiles_use_bucket_limits(void) {
+    // 90 быстрых (до 500 мкс) и 10 медленных (2000..3000 мкс)
+    for (int i = 0; i < 90; i++) {
+        hist->record(300);
+    }
+    for (int i = 0; i < 10; i++) {
+        hist->record(2500);
+    }
+    TEST_ASSERT_EQUAL_UINT32(100, hist->getCount());
+    TEST_ASSERT_EQUAL_UINT32(500, hist->percentileUs(50));
+    TEST_ASSERT_EQUAL_UINT32(500, hist->percentileUs(90));
+    // Граница корзины не больше максимума
+    TEST_ASSERT_EQUAL_UINT32(2500, hist->percentileUs(95));
+    TEST_ASSERT_EQUAL_UINT32(2500, hist->getMaxUs());
+    TEST_ASSERT_EQUAL_UINT32(520, hist->getAvgUs());
+}
+
+void test_last_bucket_reports_max(void) {
+    hist->record(100);
+    hist->record(2000000);
+    TEST_ASSERT_EQUAL_UINT32(2000000, hist->percentileUs(99));
+    hist->reset();
+    TEST_ASSERT_EQUAL_UINT32(0, hist->getCount());
+    TEST_ASSERT_EQUAL_UINT32(0, hist->getMaxUs());
+}
+
+void test_json_format_is_milliseconds_one_decimal(void) {
+    for (int i = 0; i < 90; i++) {
+        hist->record(300);
+    }
+    for (int i = 0; i < 10; i++) {
+        hist->record(2500);
+    }
+    char buf[LatencyHistogram::kJsonSize];
+    const int len = hist->formatJsonMs(buf, sizeof(buf), "sendMs");
+    TEST_ASSERT_EQUAL_STRING(
+        "\"sendMs\":{\"count\":100,\"avg\":0.5,\"p50\":0.5,\"p95\":2.5,\"p99\":2.5,\"max\":2.5}", buf);
+    TEST_ASSERT_EQUAL((int)strlen(buf), len);
+}
+
+void test_json_fits_for_extreme_values(void) {
+    for (int i = 0; i < 3; i++) {
+        hist->record(0xFFFFFFFFu);
+    }
+    char buf[LatencyHistogram::kJsonSize];
+    const int len = hist->formatJsonMs(buf, sizeof(buf), "captureToDequeueMs");
+    TEST_ASSERT_LESS_THAN((int)sizeof(buf), len);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_histogram);
+    RUN_TEST(test_percentiles_use_bucket_limits);
+    RUN_TEST(test_last_bucket_reports_max);
+    RUN_TEST(test_json_format_is_milliseconds_one_decimal);
+    RUN_TEST(test_json_fits_for_extreme_values);
+    return UNITY_END();
+}
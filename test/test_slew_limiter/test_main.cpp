@@ -0,0 +1,209 @@
+// Ограничитель скорости нарастания (SlewLimiter) на тиках контроллера
+// моторов: время разгона, сброса и реверса, мгновенные остановка и выход
+// регулятора, тормоз MX1508 по выходу ограничителя. pio test -e native
+#include <unity.h>
+#include "SlewLimiter.h"
+#include "DriveMixer.h"
+
+static const uint32_t kTickUs = 5000;      // 200 Гц, как MOTOR_SLEW_TICK_US
+
+static SlewLimiter* slew;
+
+void setUp(void) {
+    slew = new SlewLimiter();
+    // Разгон 2%, сброс 4%, реверс 3% за тик
+    slew->setRates(400, 800, 600, kTickUs);
+}
+
+void tearDown(void) {
+    delete slew;
+    slew = nullptr;
+}
+
+// Тики до цели; проверяет, что выход идет монотонно и не прыгает больше maxDelta
+static int ticksToSettle(int target, int maxDelta, int maxTicks = 1000) {
+    slew->setTarget(target);
+    int ticks = 0;
+    int prev = slew->getOutput();
+    const int direction = target > prev ? 1 : -1;
+    while (!slew->isSettled() && ticks < maxTicks) {
+        slew->step();
+        ticks++;
+        const int output = slew->getOutput();
+        TEST_ASSERT_TRUE((output - prev) * direction >= 0);
+        TEST_ASSERT_LESS_OR_EQUAL(maxDelta, (output - prev) * direction);
+        prev = output;
+    }
+    TEST_ASSERT_TRUE(slew->isSettled());
+    TEST_ASSERT_EQUAL(target, slew->getOutput());
+    return ticks;
+}
+
+void test_accel_from_standstill(void) {
+    // 0 -> 100% за 250 мс: скачка полной мощности нет
+    TEST_ASSERT_EQUAL(50, ticksToSettle(100, 2));
+    TEST_ASSERT_EQUAL(100, slew->getTarget());
+}
+
+void test_decel_in_same_direction(void) {
+    ticksToSettle(100, 2);
+    // 100 -> 50% со скоростью сброса: 12.5 тика
+    TEST_ASSERT_EQUAL(13, ticksToSettle(50, 4));
+}
+
+void test_reverse_goes_through_zero(void) {
+    ticksToSettle(50, 2);
+    slew->setTarget(-100);
+    int ticks = 0;
+    int zeroAt = -1;
+    while (!slew->isSettled()) {
+        slew->step();
+        ticks++;
+        if (zeroAt < 0 && slew->getOutput() <= 0) {
+            zeroAt = ticks;
+        }
+    }
+    // До нуля - скоростью реверса (50/3), дальше - разгоном (100/2)
+    TEST_ASSERT_EQUAL(17, zeroAt);
+    TEST_ASSERT_EQUAL(67, ticks);
+    TEST_ASSERT_EQUAL(-100, slew->getOutput());
+}
+
+void test_zero_rates_jump_to_target(void) {
+    slew->setRates(0, 0, 0, kTickUs);
+    slew->setTarget(-100);
+    TEST_ASSERT_TRUE(slew->step());
+    TEST_ASSERT_EQUAL(-100, slew->getOutput());
+    TEST_ASSERT_TRUE(slew->isSettled());
+    slew->setTarget(100);
+    slew->step();
+    TEST_ASSERT_EQUAL(100, slew->getOutput());
+}
+
+void test_unlimited_reverse_then_accel(void) {
+    slew->setRates(400, 800, 0, kTickUs);
+    ticksToSettle(100, 2);
+    // Реверс без ограничения: ноль сразу, дальше обычный разгон
+    slew->setTarget(-100);
+    slew->step();
+    TEST_ASSERT_EQUAL(-2, slew->getOutput());
+}
+
+void test_reset_stops_immediately(void) {
+    ticksToSettle(80, 2);
+    slew->setTarget(-80);
+    slew->step();
+    slew->reset();
+    TEST_ASSERT_EQUAL(0, slew->getOutput());
+    TEST_ASSERT_EQUAL(0, slew->getTarget());
+    TEST_ASSERT_TRUE(slew->isSettled());
+    TEST_ASSERT_FALSE(slew->step());
+}
+
+void test_jump_for_feedback_controller(void) {
+    // Выход регулятора (PID Лайнера) - сразу, без запаздывания
+    slew->jumpTo(70);
+    TEST_ASSERT_EQUAL(70, slew->getOutput());
+    TEST_ASSERT_TRUE(slew->isSettled());
+    TEST_ASSERT_FALSE(slew->step());
+    slew->jumpTo(-30);
+    TEST_ASSERT_EQUAL(-30, slew->getOutput());
+
+    // Следующая ручная команда идет от текущего выхода с ограничением
+    TEST_ASSERT_EQUAL(8, ticksToSettle(0, 4));
+}
+
+void test_step_reports_integer_changes(void) {
+    // 1%/с при тике 5 мс: шаг 1/256 процента, целый выход меняется один раз
+    slew->setRates(1, 1, 1, kTickUs);
+    slew->setTarget(1);
+    int changes = 0;
+    int ticks = 0;
+    while (!slew->isSettled()) {
+        if (slew->step()) {
+            changes++;
+        }
+        ticks++;
+    }
+    TEST_ASSERT_EQUAL(SlewLimiter::kScale, ticks);
+    TEST_ASSERT_EQUAL(1, changes);
+}
+
+void test_joystick_slams_stay_rate_limited(void) {
+    // Джойстик мечется между крайними положениями: за тик выход меняется
+    // не больше самого быстрого из шагов
+    const int targets[] = { 100, -100, 100, 0, -100, 60, -60, 0 };
+    int prev = 0;
+    for (int target : targets) {
+        slew->setTarget(target);
+        for (int i = 0; i < 20; i++) {
+            slew->step();
+            const int output = slew->getOutput();
+            const int delta = output > prev ? output - prev : prev - output;
+            TEST_ASSERT_LESS_OR_EQUAL(4, delta);
+            prev = output;
+        }
+    }
+}
+
+static int brakeFor(uint8_t mode) {
+    return DriveMixer::brakeDuty(slew->getOutput(), slew->getTarget(), mode, 30);
+}
+
+void test_brake_mode_starts_from_rest(void) {
+    // Медленный разгон: первые тики выход округляется до 0, но цель уже
+    // не 0 - это ход, а не тормоз (иначе мотор стоит на тормозе до 1%)
+    slew->setRates(20, 800, 600, kTickUs);
+    TEST_ASSERT_EQUAL(DriveMixer::duty(100), brakeFor(DriveMixer::kBrakeFull));
+    slew->setTarget(50);
+    int zeroTicks = 0;
+    for (int i = 0; i < 200; i++) {
+        slew->step();
+        if (slew->getOutput() == 0) {
+            zeroTicks++;
+        }
+        TEST_ASSERT_EQUAL(-1, brakeFor(DriveMixer::kBrakeFull));
+        TEST_ASSERT_EQUAL(-1, brakeFor(DriveMixer::kBrakeProportional));
+        TEST_ASSERT_EQUAL(-1, brakeFor(DriveMixer::kBrakeCoast));
+    }
+    TEST_ASSERT_GREATER_THAN(1, zeroTicks);
+    TEST_ASSERT_GREATER_THAN(0, slew->getOutput());
+}
+
+void test_brake_on_stop_and_reverse(void) {
+    ticksToSettle(40, 2);
+    // Сброс газа идет ходом до нуля, на нуле с целью 0 - тормоз
+    slew->setTarget(0);
+    slew->step();
+    TEST_ASSERT_EQUAL(-1, brakeFor(DriveMixer::kBrakeFull));
+    while (!slew->isSettled()) {
+        slew->step();
+    }
+    TEST_ASSERT_EQUAL(DriveMixer::duty(100), brakeFor(DriveMixer::kBrakeFull));
+    TEST_ASSERT_EQUAL(DriveMixer::duty(30), brakeFor(DriveMixer::kBrakeProportional));
+    TEST_ASSERT_EQUAL(0, brakeFor(DriveMixer::kBrakeCoast));
+
+    // Участок реверса до нуля - тормоз (пропорциональный - по новой команде)
+    ticksToSettle(40, 2);
+    slew->setTarget(-60);
+    slew->step();
+    TEST_ASSERT_EQUAL(DriveMixer::duty(100), brakeFor(DriveMixer::kBrakeFull));
+    TEST_ASSERT_EQUAL(DriveMixer::duty(60), brakeFor(DriveMixer::kBrakeProportional));
+    TEST_ASSERT_EQUAL(-1, brakeFor(DriveMixer::kBrakeCoast));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_accel_from_standstill);
+    RUN_TEST(test_decel_in_same_direction);
+    RUN_TEST(test_reverse_goes_through_zero);
+    RUN_TEST(test_zero_rates_jump_to_target);
+    RUN_TEST(test_unlimited_reverse_then_accel);
+    RUN_TEST(test_reset_stops_immediately);
+    RUN_TEST(test_jump_for_feedback_controller);
+    RUN_TEST(test_step_reports_integer_changes);
+    RUN_TEST(test_joystick_slams_stay_rate_limited);
+    RUN_TEST(test_brake_mode_starts_from_rest);
+    RUN_TEST(test_brake_on_stop_and_reverse);
+    return UNITY_END();
+}
@@ -0,0 +1,196 @@
+// Адаптивное качество стрима (StreamQualityController) на модели канала:
+// размер кадра зависит от ступени, время отправки - от пропускной
+// способности канала. pio test -e native
+#include <unity.h>
+#include "StreamQualityController.h"
+#include "hardware_config.h"
+
+typedef StreamQualityController::OperatingPoint OperatingPoint;
+
+// Модель канала WiFi и источника кадров
+struct SimLink {
+    uint32_t bytesPerSec;   // Пропускная способность канала
+    uint32_t cameraFps;     // Частота кадров камеры (или лимит зрителя)
+};
+
+static StreamQualityController* qc;
+static uint32_t nowMs;
+
+void setUp(void) {
+    qc = new StreamQualityController();
+    nowMs = 0;
+}
+
+void tearDown(void) {
+    delete qc;
+    qc = nullptr;
+}
+
+// Размер JPEG ступени: пропорционален пикселям, обратно - jpeg_quality
+static uint32_t frameBytes(const OperatingPoint& point) {
+    return (uint32_t)point.width * point.height * 16 / 10 / point.quality;
+}
+
+static uint32_t sendUsFor(const SimLink& link, uint32_t bytes) {
+    return 2000 + (uint32_t)((uint64_t)bytes * 1000000 / link.bytesPerSec);
+}
+
+// Одно окно измерений: один зритель, кадры уходят подряд, но не чаще камеры.
+// Возвращает true, если контроллер сменил ступень
+static bool runWindow(const SimLink& link) {
+    const uint32_t bytes = frameBytes(qc->getOperatingPoint());
+    const uint32_t sendUs = sendUsFor(link, bytes);
+    uint32_t intervalUs = 1000000 / link.cameraFps;
+    if (sendUs > intervalUs) {
+        intervalUs = sendUs;
+    }
+    uint32_t frames = STREAM_QC_WINDOW_MS * 1000 / intervalUs;
+    if (frames == 0) {
+        frames = 1;
+    }
+    for (uint32_t i = 0; i < frames; i++) {
+        qc->onFrameSent(sendUs, bytes);
+    }
+    nowMs += STREAM_QC_WINDOW_MS;
+    return qc->evaluate(nowMs);
+}
+
+// Прогон N окон, возвращает число смен ступени
+static int runWindows(const SimLink& link, int windows) {
+    int changes = 0;
+    for (int i = 0; i < windows; i++) {
+        if (runWindow(link)) {
+            changes++;
+        }
+    }
+    return changes;
+}
+
+static uint32_t currentSendUs(const SimLink& link) {
+    return sendUsFor(link, frameBytes(qc->getOperatingPoint()));
+}
+
+void test_fast_link_keeps_best_quality(void) {
+    const SimLink link = { 1000000, 25 };
+    TEST_ASSERT_EQUAL(0, runWindows(link, 30));
+    TEST_ASSERT_EQUAL(0, qc->getLevel());
+}
+
+void test_slow_link_settles_without_oscillation(void) {
+    const SimLink link = { 50000, 25 };
+    runWindows(link, 30);
+    const int settled = qc->getLevel();
+    TEST_ASSERT_GREATER_THAN(0, settled);
+    // Задержка в пределах гистерезиса цели
+    TEST_ASSERT_LESS_OR_EQUAL(STREAM_QC_TARGET_LATENCY_MS * 1250, currentSendUs(link));
+
+    // Дальше ступень не меняется: прогноз по размеру кадра не дает
+    // подняться на ступень, откуда контроллер сразу бы ушел
+    TEST_ASSERT_EQUAL(0, runWindows(link, 100));
+    TEST_ASSERT_EQUAL(settled, qc->getLevel());
+}
+
+void test_recovers_quality_when_link_improves(void) {
+    const SimLink slow = { 50000, 25 };
+    const SimLink fast = { 1000000, 25 };
+    runWindows(slow, 30);
+    TEST_ASSERT_GREATER_THAN(0, qc->getLevel());
+
+    runWindows(fast, 60);
+    TEST_ASSERT_EQUAL(0, qc->getLevel());
+}
+
+void test_degrade_is_faster_than_upgrade(void) {
+    const SimLink slow = { 50000, 25 };
+    const SimLink fast = { 1000000, 25 };
+    // Перегрузка: ступень облегчается за два окна
+    TEST_ASSERT_FALSE(runWindow(slow));
+    TEST_ASSERT_TRUE(runWindow(slow));
+    TEST_ASSERT_EQUAL(1, qc->getLevel());
+
+    // Запас: качество возвращается только после пяти окон подряд
+    TEST_ASSERT_EQUAL(0, runWindows(fast, 4));
+    TEST_ASSERT_TRUE(runWindow(fast));
+    TEST_ASSERT_EQUAL(0, qc->getLevel());
+}
+
+void test_low_fps_on_busy_link_degrades(void) {
+    // Цель по задержке мягкая, но канал тянет меньше STREAM_QC_MIN_FPS
+    qc->setTargetLatencyMs(200);
+    const SimLink link = { 30000, 25 };
+    runWindows(link, 40);
+
+    const uint32_t sendUs = currentSendUs(link);
+    TEST_ASSERT_LESS_OR_EQUAL(1000000 / STREAM_QC_MIN_FPS, sendUs);
+    TEST_ASSERT_EQUAL(0, runWindows(link, 100));
+}
+
+void test_low_fps_from_viewer_cap_is_not_congestion(void) {
+    // Кадры редкие из-за лимита зрителя, канал свободен - ступень не трогаем
+    const SimLink link = { 200000, 5 };
+    TEST_ASSERT_EQUAL(0, runWindows(link, 30));
+    TEST_ASSERT_EQUAL(0, qc->getLevel());
+}
+
+void test_no_frames_keeps_level(void) {
+    const SimLink slow = { 50000, 25 };
+    runWindows(slow, 4);
+    const int level = qc->getLevel();
+    TEST_ASSERT_GREATER_THAN(0, level);
+
+    // Зрители ушли: пустые окна ступень не меняют
+    for (int i = 0; i < 10; i++) {
+        nowMs += STREAM_QC_WINDOW_MS;
+        TEST_ASSERT_FALSE(qc->evaluate(nowMs));
+    }
+    TEST_ASSERT_EQUAL(level, qc->getLevel());
+}
+
+void test_disable_resets_to_level_zero_once(void) {
+    const SimLink slow = { 50000, 25 };
+    runWindows(slow, 10);
+    TEST_ASSERT_GREATER_THAN(0, qc->getLevel());
+
+    qc->setEnabled(false);
+    TEST_ASSERT_EQUAL(0, qc->getLevel());
+    // Сброс применяется на ближайшей оценке, не дожидаясь конца окна
+    TEST_ASSERT_TRUE(qc->evaluate(nowMs));
+    TEST_ASSERT_FALSE(qc->evaluate(nowMs));
+
+    // Выключенный контроллер ступень больше не меняет
+    TEST_ASSERT_EQUAL(0, runWindows(slow, 20));
+    TEST_ASSERT_EQUAL(0, qc->getLevel());
+}
+
+void test_disable_at_level_zero_requests_nothing(void) {
+    qc->setEnabled(false);
+    TEST_ASSERT_FALSE(qc->evaluate(nowMs));
+    TEST_ASSERT_FALSE(qc->isEnabled());
+}
+
+void test_estimate_uses_measured_frame_size(void) {
+    const SimLink slow = { 50000, 25 };
+    runWindows(slow, 2);
+    TEST_ASSERT_EQUAL(1, qc->getLevel());
+    runWindow(slow);
+
+    // Ступень 0 измерена, ступень 2 оценена по лестнице
+    const OperatingPoint level0 = { 320, 240, 10 };
+    TEST_ASSERT_EQUAL_UINT32(frameBytes(level0), qc->estimateFrameBytes(0));
+    TEST_ASSERT_LESS_OR_EQUAL(qc->getAvgFrameBytes(), qc->estimateFrameBytes(2));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fast_link_keeps_best_quality);
+    RUN_TEST(test_slow_link_settles_without_oscillation);
+    RUN_TEST(test_recovers_quality_when_link_improves);
+    RUN_TEST(test_degrade_is_faster_than_upgrade);
+    RUN_TEST(test_low_fps_on_busy_link_degrades);
+    RUN_TEST(test_low_fps_from_viewer_cap_is_not_congestion);
+    RUN_TEST(test_no_frames_keeps_level);
+    RUN_TEST(test_disable_resets_to_level_zero_once);
+    RUN_TEST(test_disable_at_level_zero_requests_nothing);
+    RUN_TEST(test_estimate_uses_measured_frame_size);
+    return UNITY_END();
+}